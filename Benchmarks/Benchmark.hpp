@@ -0,0 +1,57 @@
+#ifndef SPINNER_BENCHMARKS_BENCHMARK_HPP
+#define SPINNER_BENCHMARKS_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Spinner::Benchmarks
+{
+    using Clock = std::chrono::steady_clock;
+
+    [[nodiscard]] inline double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    [[nodiscard]] inline double Median(std::vector<double> times)
+    {
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    }
+
+    /// Runs function once to warm up, then iterations times, returning the median time of one run in milliseconds
+    template<typename Function>
+    inline double Measure(int iterations, Function &&function)
+    {
+        function();
+
+        std::vector<double> times;
+        times.reserve(iterations);
+        for (int i = 0; i < iterations; i++)
+        {
+            const auto start = Clock::now();
+            function();
+            times.push_back(MillisecondsSince(start));
+        }
+        return Median(std::move(times));
+    }
+
+    inline void Report(const std::string &name, double milliseconds, double baselineMilliseconds = 0.0)
+    {
+        std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << std::fixed << std::setprecision(3) << milliseconds << " ms";
+        if (baselineMilliseconds > 0.0)
+        {
+            std::cout << std::setw(10) << std::setprecision(2) << (baselineMilliseconds / milliseconds) << "x";
+        }
+        std::cout << '\n';
+    }
+
+    /// Keeps results alive so the optimizer cannot drop the work producing them
+    inline volatile float Sink = 0.0f;
+} // Spinner::Benchmarks
+
+#endif //SPINNER_BENCHMARKS_BENCHMARK_HPP
@@ -0,0 +1,133 @@
+#include "Benchmark.hpp"
+#include "Spinner/BoundingVolumeHierarchy.hpp"
+
+#include <random>
+
+using namespace Spinner;
+
+// A scene of small boxes in a large world, a fraction of which move a little each frame, queried with camera sized boxes
+int main(int argc, char **argv)
+{
+    const size_t objectCount = (argc > 1) ? std::stoul(argv[1]) : 100'000;
+    constexpr float worldSize = 2000.0f;
+    constexpr size_t movingPercent = 5;
+    constexpr int queryCount = 1000;
+    constexpr int iterations = 10;
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(0.0f, worldSize);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+
+    std::vector<Aabb> boxes;
+    boxes.reserve(objectCount);
+    for (size_t i = 0; i < objectCount; i++)
+    {
+        const glm::vec3 min = {position(random), position(random), position(random)};
+        boxes.push_back({min, min + glm::vec3(size(random), size(random), size(random))});
+    }
+
+    std::vector<size_t> moving;
+    for (size_t i = 0; i < objectCount; i += 100 / movingPercent)
+    {
+        moving.push_back(i);
+    }
+
+    std::vector<Aabb> queries;
+    for (int i = 0; i < queryCount; i++)
+    {
+        const glm::vec3 min = {position(random), position(random), position(random)};
+        queries.push_back({min, min + glm::vec3(50.0f)});
+    }
+
+    std::cout << objectCount << " objects, " << moving.size() << " moving per frame, " << queryCount << " queries, median of " << iterations << " runs\n";
+
+    // Insertion, one at a time against pushing onto an array, then a full top down build
+    std::vector<Aabb> linear;
+    const auto linearInsert = Benchmarks::Measure(iterations, [&]
+    {
+        linear.clear();
+        linear.shrink_to_fit();
+        for (const auto &box : boxes)
+        {
+            linear.push_back(box);
+        }
+    });
+
+    BoundingVolumeHierarchy tree;
+    std::vector<BoundingVolumeHierarchy::ProxyId> proxies;
+    const auto treeInsert = Benchmarks::Measure(iterations, [&]
+    {
+        tree = BoundingVolumeHierarchy();
+        proxies.clear();
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            proxies.push_back(tree.Insert(boxes[i], i));
+        }
+    });
+    const auto treeRebuild = Benchmarks::Measure(iterations, [&] { tree.Rebuild(); });
+
+    Benchmarks::Report("Linear insert", linearInsert);
+    Benchmarks::Report("BVH insert", treeInsert, linearInsert);
+    Benchmarks::Report("BVH rebuild", treeRebuild, linearInsert);
+
+    // Moving objects, the tree only reinserts those which left their fattened bounds
+    size_t reinserted = 0;
+    const auto moveBoxes = [&]
+    {
+        for (const auto i : moving)
+        {
+            const glm::vec3 offset = {step(random), step(random), step(random)};
+            boxes[i] = {boxes[i].Min + offset, boxes[i].Max + offset};
+        }
+    };
+    const auto linearRefit = Benchmarks::Measure(iterations, [&]
+    {
+        moveBoxes();
+        for (const auto i : moving)
+        {
+            linear[i] = boxes[i];
+        }
+    });
+    const auto treeRefit = Benchmarks::Measure(iterations, [&]
+    {
+        moveBoxes();
+        for (const auto i : moving)
+        {
+            reinserted += tree.Move(proxies[i], boxes[i]) ? 1 : 0;
+        }
+    });
+
+    Benchmarks::Report("Linear refit", linearRefit);
+    Benchmarks::Report("BVH refit", treeRefit, linearRefit);
+
+    // Queries, counting the hits so both do the same work per result
+    size_t linearHits = 0;
+    const auto linearQuery = Benchmarks::Measure(iterations, [&]
+    {
+        linearHits = 0;
+        for (const auto &query : queries)
+        {
+            for (const auto &box : linear)
+            {
+                linearHits += query.Overlaps(box) ? 1 : 0;
+            }
+        }
+    });
+    size_t treeHits = 0;
+    const auto treeQuery = Benchmarks::Measure(iterations, [&]
+    {
+        treeHits = 0;
+        for (const auto &query : queries)
+        {
+            tree.QueryAabb(query, [&treeHits](uint64_t) { treeHits++; });
+        }
+    });
+
+    Benchmarks::Report("Linear query", linearQuery);
+    Benchmarks::Report("BVH query", treeQuery, linearQuery);
+
+    // The tree tests fattened bounds, so it reports a few more hits than the exact scan
+    std::cout << "Hits per run: linear " << linearHits << ", BVH " << treeHits << ", reinserted " << reinserted << " of " << (iterations + 1) * moving.size() << " moves\n";
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "Benchmark.hpp"
+#include "Spinner/JobSystem.hpp"
+
+#include <cmath>
+
+using namespace Spinner;
+
+// Enough arithmetic per element that the loop is compute bound rather than memory bound
+static float Work(size_t i)
+{
+    auto value = static_cast<float>(i);
+    for (int step = 0; step < 16; step++)
+    {
+        value = std::sqrt(value * 1.0001f + 1.0f);
+    }
+    return value;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t maxThreads = (argc > 1) ? std::stoul(argv[1]) : hardwareThreads;
+    constexpr size_t elementCount = 4'000'000;
+    constexpr size_t grainSize = 4096;
+    constexpr size_t smallJobCount = 100'000;
+    constexpr int iterations = 10;
+
+    std::cout << hardwareThreads << " hardware threads, " << elementCount << " elements in chunks of " << grainSize << ", median of " << iterations << " runs\n";
+
+    std::vector<float> results(elementCount);
+    const auto serial = Benchmarks::Measure(iterations, [&]
+    {
+        for (size_t i = 0; i < elementCount; i++)
+        {
+            results[i] = Work(i);
+        }
+        Benchmarks::Sink = results[elementCount / 2];
+    });
+    Benchmarks::Report("Serial loop", serial);
+
+    // The thread count includes the calling thread, which runs chunks while it waits, so the job system has one less worker
+    for (size_t threads = 2; threads <= std::max<size_t>(maxThreads, 2); threads *= 2)
+    {
+        JobSystem jobs(threads - 1);
+
+        const auto parallelFor = Benchmarks::Measure(iterations, [&]
+        {
+            jobs.ParallelFor(elementCount, grainSize, [&results](size_t begin, size_t end)
+            {
+                for (auto i = begin; i < end; i++)
+                {
+                    results[i] = Work(i);
+                }
+            });
+            Benchmarks::Sink = results[elementCount / 2];
+        });
+
+        // Scheduling overhead alone: many jobs which do nothing
+        const auto smallJobs = Benchmarks::Measure(iterations, [&]
+        {
+            JobCounter counter;
+            for (size_t i = 0; i < smallJobCount; i++)
+            {
+                jobs.Run([]() {}, &counter);
+            }
+            jobs.Wait(counter);
+        });
+
+        const auto label = std::to_string(threads) + " threads";
+        Benchmarks::Report("ParallelFor, " + label, parallelFor, serial);
+        Benchmarks::Report(std::to_string(smallJobCount) + " empty jobs, " + label, smallJobs);
+    }
+
+    return 0;
+}
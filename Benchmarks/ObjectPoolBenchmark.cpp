@@ -0,0 +1,108 @@
+#include "Benchmark.hpp"
+#include "Spinner/ObjectPool.hpp"
+
+#include <memory>
+#include <random>
+
+using namespace Spinner;
+
+// Stands in for SceneObject: shared ownership down the tree, weak up it, and a similar amount of transform and bookkeeping data
+struct Node : public std::enable_shared_from_this<Node>
+{
+    std::weak_ptr<Node> Parent;
+    std::vector<std::shared_ptr<Node>> Children;
+    std::string Name;
+    float Data[24] = {};
+    bool Active = true;
+};
+
+struct Timings
+{
+    double Load;
+    double Traverse;
+    double Unload;
+};
+
+// Builds a model sized tree the way an import does, with the parser's short lived allocations (names, buffers) between the nodes
+template<typename Create>
+static std::shared_ptr<Node> LoadTree(size_t nodeCount, Create &&create)
+{
+    std::mt19937 random(1);
+    std::vector<std::unique_ptr<char[]>> parseAllocations;
+    std::vector<Node *> nodes;
+    nodes.reserve(nodeCount);
+
+    auto root = create();
+    nodes.push_back(root.get());
+    for (size_t i = 1; i < nodeCount; i++)
+    {
+        parseAllocations.push_back(std::make_unique<char[]>(16 + random() % 240));
+        auto node = create();
+        node->Data[0] = static_cast<float>(i);
+        auto *parent = nodes[random() % nodes.size()];
+        node->Parent = parent->weak_from_this();
+        nodes.push_back(node.get());
+        parent->Children.push_back(std::move(node));
+    }
+    return root;
+}
+
+static float Traverse(const Node &node)
+{
+    auto sum = node.Active ? node.Data[0] : 0.0f;
+    for (const auto &child : node.Children)
+    {
+        sum += Traverse(*child);
+    }
+    return sum;
+}
+
+template<typename Create>
+static Timings Run(size_t nodeCount, int iterations, Create &&create)
+{
+    std::vector<double> loads, traversals, unloads;
+    for (int i = 0; i < iterations + 1; i++)
+    {
+        auto start = Benchmarks::Clock::now();
+        auto root = LoadTree(nodeCount, create);
+        const auto load = Benchmarks::MillisecondsSince(start);
+
+        start = Benchmarks::Clock::now();
+        Benchmarks::Sink = Traverse(*root);
+        const auto traversal = Benchmarks::MillisecondsSince(start);
+
+        start = Benchmarks::Clock::now();
+        root.reset();
+        const auto unload = Benchmarks::MillisecondsSince(start);
+
+        // The first run warms up
+        if (i > 0)
+        {
+            loads.push_back(load);
+            traversals.push_back(traversal);
+            unloads.push_back(unload);
+        }
+    }
+    return {Benchmarks::Median(std::move(loads)), Benchmarks::Median(std::move(traversals)), Benchmarks::Median(std::move(unloads))};
+}
+
+int main(int argc, char **argv)
+{
+    const size_t nodeCount = (argc > 1) ? std::stoul(argv[1]) : 100'000;
+    constexpr int iterations = 10;
+
+    std::cout << nodeCount << " nodes, median of " << iterations << " runs\n";
+
+    const auto heap = Run(nodeCount, iterations, [] { return std::make_shared<Node>(); });
+    const auto pooled = Run(nodeCount, iterations, [] { return std::allocate_shared<Node>(PoolAllocator<Node>()); });
+
+    Benchmarks::Report("make_shared load", heap.Load);
+    Benchmarks::Report("Pooled load", pooled.Load, heap.Load);
+    Benchmarks::Report("make_shared traverse", heap.Traverse);
+    Benchmarks::Report("Pooled traverse", pooled.Traverse, heap.Traverse);
+    Benchmarks::Report("make_shared unload", heap.Unload);
+    Benchmarks::Report("Pooled unload", pooled.Unload, heap.Unload);
+
+    std::cout << "Released by TrimShared after the last unload: " << ObjectPool::TrimShared() / 1024 << " KiB\n";
+    return 0;
+}
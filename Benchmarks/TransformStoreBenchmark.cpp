@@ -0,0 +1,144 @@
+#include "Benchmark.hpp"
+#include "Spinner/TransformStore.hpp"
+
+#include <memory>
+#include <random>
+
+using namespace Spinner;
+
+// The transform model SceneObject used before TransformStore: each node owns its matrices, marking one dirty recurses through its
+// children, and reading a world matrix recurses up through its parents and inverts eagerly
+class LegacyNode : public std::enable_shared_from_this<LegacyNode>
+{
+public:
+    std::weak_ptr<LegacyNode> Parent;
+    std::vector<std::shared_ptr<LegacyNode>> Children;
+
+    glm::vec3 Position = {0, 0, 0};
+    glm::quat Rotation = {1, 0, 0, 0};
+    glm::vec3 EulerRotation = {0, 0, 0};
+    glm::vec3 Scale = {1, 1, 1};
+    glm::mat4 Matrix{1.0f};
+    glm::mat4 WorldMatrix{1.0f};
+    glm::mat4 InverseWorldMatrix{1.0f};
+    bool DirtyMatrix = true;
+    bool DirtyWorldMatrix = true;
+
+    void SetRotation(glm::quat rotation)
+    {
+        Rotation = rotation;
+        DirtyMatrix = true;
+        SetWorldMatrixDirty();
+    }
+
+    void SetWorldMatrixDirty()
+    {
+        DirtyWorldMatrix = true;
+        for (auto &child : Children)
+        {
+            child->SetWorldMatrixDirty();
+        }
+    }
+
+    glm::mat4 GetLocalMatrix()
+    {
+        if (DirtyMatrix)
+        {
+            Matrix = glm::translate(glm::mat4{1.0f}, Position) * glm::mat4_cast(Rotation) * glm::eulerAngleYXZ(glm::radians(EulerRotation.y), glm::radians(EulerRotation.x), glm::radians(EulerRotation.z)) * glm::scale(glm::mat4{1.0f}, Scale);
+            DirtyMatrix = false;
+        }
+        return Matrix;
+    }
+
+    glm::mat4 GetWorldMatrix()
+    {
+        if (DirtyWorldMatrix)
+        {
+            const auto parent = Parent.lock();
+            WorldMatrix = (parent != nullptr) ? GetLocalMatrix() * parent->GetWorldMatrix() : GetLocalMatrix();
+            InverseWorldMatrix = glm::inverse(WorldMatrix);
+            DirtyWorldMatrix = false;
+        }
+        return WorldMatrix;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const size_t nodeCount = (argc > 1) ? std::stoul(argv[1]) : 100'000;
+    constexpr int frames = 20;
+
+    // Random parents among the earlier nodes, which gives a bushy hierarchy a dozen or so levels deep
+    std::mt19937 random(1);
+    std::vector<uint32_t> parents(nodeCount, 0);
+    for (size_t i = 1; i < nodeCount; i++)
+    {
+        parents[i] = random() % i;
+    }
+
+    std::vector<std::shared_ptr<LegacyNode>> legacyNodes;
+    legacyNodes.reserve(nodeCount);
+    TransformStore store;
+    std::vector<TransformStore::Id> ids;
+    ids.reserve(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++)
+    {
+        legacyNodes.push_back(std::make_shared<LegacyNode>());
+        legacyNodes[i]->Position = {static_cast<float>(i % 7), 1.0f, 0.0f};
+        ids.push_back(store.Add((i > 0) ? ids[parents[i]] : TransformStore::InvalidId));
+        store.SetPosition(ids[i], legacyNodes[i]->Position);
+        if (i > 0)
+        {
+            legacyNodes[i]->Parent = legacyNodes[parents[i]];
+            legacyNodes[parents[i]]->Children.push_back(legacyNodes[i]);
+        }
+    }
+
+    std::cout << nodeCount << " nodes, median of " << frames << " frames\n";
+
+    // Every node animated each frame, then every world matrix read as the renderer would
+    for (const auto animatedPercent : {100, 5})
+    {
+        const auto stride = 100 / animatedPercent;
+        float angle = 0.0f;
+
+        const auto legacy = Benchmarks::Measure(frames, [&]
+        {
+            angle += 0.01f;
+            const auto rotation = glm::angleAxis(angle, glm::vec3(0, 1, 0));
+            for (size_t i = 0; i < nodeCount; i += stride)
+            {
+                legacyNodes[i]->SetRotation(rotation);
+            }
+            float sum = 0.0f;
+            for (auto &node : legacyNodes)
+            {
+                sum += node->GetWorldMatrix()[3][0];
+            }
+            Benchmarks::Sink = sum;
+        });
+
+        const auto structureOfArrays = Benchmarks::Measure(frames, [&]
+        {
+            angle += 0.01f;
+            const auto rotation = glm::angleAxis(angle, glm::vec3(0, 1, 0));
+            for (size_t i = 0; i < nodeCount; i += stride)
+            {
+                store.SetRotation(ids[i], rotation);
+            }
+            store.UpdateWorldMatrices();
+            float sum = 0.0f;
+            for (const auto id : ids)
+            {
+                sum += store.GetWorldMatrix(id)[3][0];
+            }
+            Benchmarks::Sink = sum;
+        });
+
+        const auto label = std::to_string(animatedPercent) + "% animated";
+        Benchmarks::Report("Per object recursion, " + label, legacy);
+        Benchmarks::Report("TransformStore pass, " + label, structureOfArrays, legacy);
+    }
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef MESH_DESCRIPTOR_SET
+#define MESH_DESCRIPTOR_SET 0
+#endif
+
+#define CUSTOM_MATERIAL_PROPERTY_COUNT 16
+
+layout(set = MESH_DESCRIPTOR_SET, binding = 0) uniform Mesh
+{
+    mat4 model;
+    vec4 materialColor;
+    vec4 materialProperties;
+    vec4 positionDequantizeOffset;
+    vec4 positionDequantizeScale;
+    float customMaterialProperties[CUSTOM_MATERIAL_PROPERTY_COUNT];
+};
@@ -0,0 +1,14 @@
+// Inverse of QuantizedStaticMeshVertex::EncodeOctahedral
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 direction = vec3(encoded.xy, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0f);
+    direction.x += direction.x >= 0.0f ? -fold : fold;
+    direction.y += direction.y >= 0.0f ? -fold : fold;
+    return normalize(direction);
+}
+
+vec3 DequantizePosition(vec3 position)
+{
+    return positionDequantizeOffset.xyz + position * positionDequantizeScale.xyz;
+}
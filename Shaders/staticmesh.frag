@@ -1,15 +1,7 @@
 #version 450
 #extension GL_EXT_nonuniform_qualifier : enable
 
-#define CUSTOM_MATERIAL_PROPERTY_COUNT 16
-
-layout(set = 0, binding = 0) uniform Mesh
-{
-    mat4 model;
-    vec4 materialColor;
-    vec4 materialProperties;
-    float customMaterialProperties[CUSTOM_MATERIAL_PROPERTY_COUNT];
-};
+#include "mesh.glsl"
 
 layout(set = 0, binding = 1) uniform sampler2D mainTexture;
 
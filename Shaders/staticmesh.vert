@@ -1,14 +1,6 @@
 #version 450
 
-#define CUSTOM_MATERIAL_PROPERTY_COUNT 16
-
-layout(set = 0, binding = 0) uniform Mesh
-{
-    mat4 model;
-    vec4 materialColor;
-    vec4 materialProperties;
-    float customMaterialProperties[CUSTOM_MATERIAL_PROPERTY_COUNT];
-};
+#include "mesh.glsl"
 
 #include "scene.glsl"
 
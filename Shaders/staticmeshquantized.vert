@@ -0,0 +1,36 @@
+#version 450
+
+#include "mesh.glsl"
+#include "scene.glsl"
+#include "quantization.glsl"
+
+layout (location = 0) in vec4 inPosition; // xyz relative to the mesh bounds, or full precision
+layout (location = 1) in vec2 inNormal; // Octahedral
+layout (location = 2) in vec2 inTangent; // Octahedral
+layout (location = 3) in vec4 inColor; // Tangent handedness stored in alpha
+layout (location = 4) in vec2 inTexCoord;
+
+layout (location = 0) out vec3 outNormal;
+layout (location = 1) out vec3 outTangent;
+layout (location = 2) out vec3 outBitangent;
+layout (location = 3) out vec2 outTexCoord;
+layout (location = 4) out vec3 outColor;
+layout (location = 5) out vec3 outWorldPosition;
+
+void main()
+{
+    // Position
+    vec4 worldPos = (model * vec4(DequantizePosition(inPosition.xyz), 1.0f));
+    gl_Position = viewProjection * worldPos;
+    outWorldPosition = worldPos.xyz;
+
+    // TBN
+    float handedness = inColor.a * 2.0f - 1.0f;
+    outNormal = normalize((model * vec4(DecodeOctahedral(inNormal), 0.0f)).xyz);
+    outTangent = normalize((model * vec4(DecodeOctahedral(inTangent), 0.0f)).xyz);
+    outBitangent = normalize(cross(outNormal, outTangent) * handedness);
+
+    // UV + color
+    outTexCoord = inTexCoord;
+    outColor = inColor.rgb;
+}
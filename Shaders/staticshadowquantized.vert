@@ -0,0 +1,19 @@
+#version 450
+
+#include "mesh.glsl"
+#include "scene.glsl"
+#include "quantization.glsl"
+
+layout (location = 0) in vec4 inPosition; // xyz relative to the mesh bounds, or full precision
+layout (location = 4) in vec2 inTexCoord;
+
+layout (location = 0) out vec2 outTexCoord;
+
+void main()
+{
+    // Position
+    gl_Position = viewProjection * model * vec4(DequantizePosition(inPosition.xyz), 1.0f);
+
+    // UV
+    outTexCoord = inTexCoord;
+}
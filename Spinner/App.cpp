@@ -22,6 +22,9 @@ namespace Spinner
 
         ScopedTimer timer("App Creation");
 
+        // Sized from the hardware's threads, reachable through JobSystem::Get
+        Jobs = std::make_shared<Spinner::JobSystem>();
+
         VulkanInstance::CreateInstance(appName, vulkanVersion, appVersion, debug, {}, {});
 
         MainWindow = std::make_shared<Spinner::Window>();
@@ -38,6 +41,8 @@ namespace Spinner
 
     App::~App()
     {
+        // Workers are joined before anything their jobs might reference goes away
+        Jobs.reset();
         Graphics.reset();
 
         if (MainWindow->IsValid())
@@ -71,6 +76,8 @@ namespace Spinner
                 input->ResetFrameState();
                 Window::PollEvents();
 
+                Jobs->RunMainThreadJobs();
+
                 auto nowTime = std::chrono::high_resolution_clock::now();
                 FrameDeltaTime = std::chrono::duration<double, std::chrono::seconds::period>(nowTime - lastTime).count();
                 lastTime = nowTime;
@@ -10,6 +10,7 @@
 #include "Image.hpp"
 #include "VulkanUtilities.hpp"
 #include "Lighting.hpp"
+#include "JobSystem.hpp"
 
 namespace Spinner
 {
@@ -22,6 +23,7 @@ namespace Spinner
     protected:
         std::shared_ptr<Spinner::Window> MainWindow;
         std::shared_ptr<Spinner::Graphics> Graphics;
+        JobSystem::Pointer Jobs;
         double FrameDeltaTime = 0.0f;
 
     public:
@@ -0,0 +1,376 @@
+#include "BoundingVolumeHierarchy.hpp"
+
+#include <cassert>
+
+namespace Spinner
+{
+    static constexpr uint32_t SahBinCount = 16;
+
+    BoundingVolumeHierarchy::ProxyId BoundingVolumeHierarchy::Insert(const Aabb &bounds, uint64_t userData)
+    {
+        const auto proxy = AllocateNode();
+        const auto margin = bounds.GetSize() * FatMarginScale + FatMarginMinimum;
+        auto &node = Nodes[proxy];
+        node.Bounds = {bounds.Min - margin, bounds.Max + margin};
+        node.UserData = userData;
+        node.Height = 0;
+
+        InsertLeaf(proxy);
+        ProxyCount++;
+        return proxy;
+    }
+
+    void BoundingVolumeHierarchy::Remove(ProxyId proxy)
+    {
+        assert(proxy < Nodes.size() && Nodes[proxy].IsLeaf() && Nodes[proxy].Height == 0);
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        ProxyCount--;
+    }
+
+    bool BoundingVolumeHierarchy::Move(ProxyId proxy, const Aabb &bounds)
+    {
+        assert(proxy < Nodes.size() && Nodes[proxy].IsLeaf() && Nodes[proxy].Height == 0);
+        if (Nodes[proxy].Bounds.Contains(bounds))
+        {
+            return false;
+        }
+
+        RemoveLeaf(proxy);
+        const auto margin = bounds.GetSize() * FatMarginScale + FatMarginMinimum;
+        Nodes[proxy].Bounds = {bounds.Min - margin, bounds.Max + margin};
+        InsertLeaf(proxy);
+        return true;
+    }
+
+    void BoundingVolumeHierarchy::Rebuild()
+    {
+        std::vector<uint32_t> leaves;
+        leaves.reserve(ProxyCount);
+        for (uint32_t node = 0; node < Nodes.size(); node++)
+        {
+            if (Nodes[node].Height == 0)
+            {
+                leaves.push_back(node);
+            }
+            else if (Nodes[node].Height > 0)
+            {
+                FreeNode(node);
+            }
+        }
+
+        Root = leaves.empty() ? NullNode : BuildRange(leaves.data(), static_cast<uint32_t>(leaves.size()));
+        if (Root != NullNode)
+        {
+            Nodes[Root].Parent = NullNode;
+        }
+    }
+
+    uint64_t BoundingVolumeHierarchy::GetUserData(ProxyId proxy) const
+    {
+        return Nodes[proxy].UserData;
+    }
+
+    const Aabb &BoundingVolumeHierarchy::GetFatBounds(ProxyId proxy) const
+    {
+        return Nodes[proxy].Bounds;
+    }
+
+    size_t BoundingVolumeHierarchy::GetProxyCount() const noexcept
+    {
+        return ProxyCount;
+    }
+
+    uint32_t BoundingVolumeHierarchy::GetHeight() const noexcept
+    {
+        return (Root != NullNode) ? static_cast<uint32_t>(Nodes[Root].Height) + 1 : 0;
+    }
+
+    std::vector<uint32_t> &BoundingVolumeHierarchy::GetQueryStack()
+    {
+        static thread_local std::vector<uint32_t> queryStack;
+        return queryStack;
+    }
+
+    uint32_t BoundingVolumeHierarchy::AllocateNode()
+    {
+        if (FreeList == NullNode)
+        {
+            Nodes.emplace_back();
+            return static_cast<uint32_t>(Nodes.size() - 1);
+        }
+
+        const auto node = FreeList;
+        FreeList = Nodes[node].Parent;
+        Nodes[node] = Node{};
+        return node;
+    }
+
+    void BoundingVolumeHierarchy::FreeNode(uint32_t node)
+    {
+        Nodes[node].Parent = FreeList;
+        Nodes[node].Height = -1;
+        FreeList = node;
+    }
+
+    void BoundingVolumeHierarchy::InsertLeaf(uint32_t leaf)
+    {
+        if (Root == NullNode)
+        {
+            Root = leaf;
+            Nodes[leaf].Parent = NullNode;
+            return;
+        }
+
+        // Walk down to the sibling which grows the tree's surface area least, the cost of descending further includes the growth of every ancestor on the way
+        const auto leafBounds = Nodes[leaf].Bounds;
+        auto sibling = Root;
+        while (!Nodes[sibling].IsLeaf())
+        {
+            const auto &node = Nodes[sibling];
+            const float area = node.Bounds.GetHalfArea();
+            const float combinedArea = Aabb::Union(node.Bounds, leafBounds).GetHalfArea();
+
+            // Pairing the leaf with this node makes a new parent with the combined area
+            const float cost = 2.0f * combinedArea;
+            // Going further down this node's bounds still grow to hold the leaf
+            const float inheritanceCost = 2.0f * (combinedArea - area);
+
+            const auto childCost = [&](uint32_t child) -> float
+            {
+                const auto &childBounds = Nodes[child].Bounds;
+                const float childCombinedArea = Aabb::Union(childBounds, leafBounds).GetHalfArea();
+                return (Nodes[child].IsLeaf() ? childCombinedArea : childCombinedArea - childBounds.GetHalfArea()) + inheritanceCost;
+            };
+            const float cost1 = childCost(node.Child1);
+            const float cost2 = childCost(node.Child2);
+
+            if (cost < cost1 && cost < cost2)
+            {
+                break;
+            }
+            sibling = (cost1 < cost2) ? node.Child1 : node.Child2;
+        }
+
+        const auto oldParent = Nodes[sibling].Parent;
+        const auto newParent = AllocateNode();
+        Nodes[newParent].Parent = oldParent;
+        Nodes[newParent].Bounds = Aabb::Union(leafBounds, Nodes[sibling].Bounds);
+        Nodes[newParent].Height = Nodes[sibling].Height + 1;
+        Nodes[newParent].Child1 = sibling;
+        Nodes[newParent].Child2 = leaf;
+        Nodes[sibling].Parent = newParent;
+        Nodes[leaf].Parent = newParent;
+
+        if (oldParent == NullNode)
+        {
+            Root = newParent;
+        }
+        else if (Nodes[oldParent].Child1 == sibling)
+        {
+            Nodes[oldParent].Child1 = newParent;
+        }
+        else
+        {
+            Nodes[oldParent].Child2 = newParent;
+        }
+
+        RefitUpwards(newParent);
+    }
+
+    void BoundingVolumeHierarchy::RemoveLeaf(uint32_t leaf)
+    {
+        if (leaf == Root)
+        {
+            Root = NullNode;
+            return;
+        }
+
+        const auto parent = Nodes[leaf].Parent;
+        const auto grandParent = Nodes[parent].Parent;
+        const auto sibling = (Nodes[parent].Child1 == leaf) ? Nodes[parent].Child2 : Nodes[parent].Child1;
+
+        // The sibling takes the parent's place
+        Nodes[sibling].Parent = grandParent;
+        FreeNode(parent);
+        if (grandParent == NullNode)
+        {
+            Root = sibling;
+            return;
+        }
+
+        if (Nodes[grandParent].Child1 == parent)
+        {
+            Nodes[grandParent].Child1 = sibling;
+        }
+        else
+        {
+            Nodes[grandParent].Child2 = sibling;
+        }
+        RefitUpwards(grandParent);
+    }
+
+    void BoundingVolumeHierarchy::RefitUpwards(uint32_t node)
+    {
+        while (node != NullNode)
+        {
+            node = Balance(node);
+
+            auto &refitNode = Nodes[node];
+            const auto &child1 = Nodes[refitNode.Child1];
+            const auto &child2 = Nodes[refitNode.Child2];
+            refitNode.Height = 1 + std::max(child1.Height, child2.Height);
+            refitNode.Bounds = Aabb::Union(child1.Bounds, child2.Bounds);
+
+            node = refitNode.Parent;
+        }
+    }
+
+    uint32_t BoundingVolumeHierarchy::Balance(uint32_t a)
+    {
+        auto &nodeA = Nodes[a];
+        if (nodeA.IsLeaf() || nodeA.Height < 2)
+        {
+            return a;
+        }
+
+        const auto b = nodeA.Child1;
+        const auto c = nodeA.Child2;
+        const int32_t balance = Nodes[c].Height - Nodes[b].Height;
+        if (balance >= -1 && balance <= 1)
+        {
+            return a;
+        }
+
+        // The taller child (up) replaces a, a takes the taller child's shorter child in place of up
+        const auto up = (balance > 1) ? c : b;
+        const auto stays = (balance > 1) ? b : c;
+        auto &nodeUp = Nodes[up];
+        const auto f = nodeUp.Child1;
+        const auto g = nodeUp.Child2;
+
+        nodeUp.Child1 = a;
+        nodeUp.Parent = nodeA.Parent;
+        nodeA.Parent = up;
+        if (nodeUp.Parent == NullNode)
+        {
+            Root = up;
+        }
+        else if (Nodes[nodeUp.Parent].Child1 == a)
+        {
+            Nodes[nodeUp.Parent].Child1 = up;
+        }
+        else
+        {
+            Nodes[nodeUp.Parent].Child2 = up;
+        }
+
+        const auto taller = (Nodes[f].Height > Nodes[g].Height) ? f : g;
+        const auto shorter = (taller == f) ? g : f;
+        nodeUp.Child2 = taller;
+        if (balance > 1)
+        {
+            nodeA.Child2 = shorter;
+        }
+        else
+        {
+            nodeA.Child1 = shorter;
+        }
+        Nodes[shorter].Parent = a;
+
+        nodeA.Bounds = Aabb::Union(Nodes[stays].Bounds, Nodes[shorter].Bounds);
+        nodeA.Height = 1 + std::max(Nodes[stays].Height, Nodes[shorter].Height);
+        nodeUp.Bounds = Aabb::Union(nodeA.Bounds, Nodes[taller].Bounds);
+        nodeUp.Height = 1 + std::max(nodeA.Height, Nodes[taller].Height);
+
+        return up;
+    }
+
+    uint32_t BoundingVolumeHierarchy::BuildRange(uint32_t *leaves, uint32_t count)
+    {
+        if (count == 1)
+        {
+            return leaves[0];
+        }
+
+        Aabb centroidBounds;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            centroidBounds.Expand(Nodes[leaves[i]].Bounds.GetCenter());
+        }
+        const auto centroidSize = centroidBounds.GetSize();
+        const int axis = (centroidSize.x >= centroidSize.y && centroidSize.x >= centroidSize.z) ? 0 : (centroidSize.y >= centroidSize.z ? 1 : 2);
+
+        // Leaves are binned by centroid along the widest axis, the split between bins with the lowest area weighted count wins
+        uint32_t leftCount = count / 2;
+        if (centroidSize[axis] > 0.0f)
+        {
+            const float binScale = static_cast<float>(SahBinCount) / centroidSize[axis];
+            const auto getBin = [&](uint32_t leaf) -> uint32_t
+            {
+                const auto bin = static_cast<uint32_t>((Nodes[leaf].Bounds.GetCenter()[axis] - centroidBounds.Min[axis]) * binScale);
+                return std::min(bin, SahBinCount - 1);
+            };
+
+            std::array<Aabb, SahBinCount> binBounds{};
+            std::array<uint32_t, SahBinCount> binCounts{};
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const auto bin = getBin(leaves[i]);
+                binBounds[bin].Expand(Nodes[leaves[i]].Bounds);
+                binCounts[bin]++;
+            }
+
+            // Costs of everything right of each split, swept from the right
+            std::array<float, SahBinCount> rightCosts{};
+            Aabb rightBounds;
+            uint32_t rightCount = 0;
+            for (uint32_t bin = SahBinCount - 1; bin > 0; bin--)
+            {
+                rightBounds.Expand(binBounds[bin]);
+                rightCount += binCounts[bin];
+                rightCosts[bin] = (rightCount > 0) ? rightBounds.GetHalfArea() * static_cast<float>(rightCount) : 0.0f;
+            }
+
+            float bestCost = std::numeric_limits<float>::max();
+            uint32_t bestSplit = 0;
+            Aabb leftBounds;
+            uint32_t sweptCount = 0;
+            for (uint32_t split = 1; split < SahBinCount; split++)
+            {
+                leftBounds.Expand(binBounds[split - 1]);
+                sweptCount += binCounts[split - 1];
+                if (sweptCount == 0 || sweptCount == count)
+                {
+                    continue;
+                }
+
+                const float cost = leftBounds.GetHalfArea() * static_cast<float>(sweptCount) + rightCosts[split];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestSplit = split;
+                }
+            }
+
+            if (bestSplit > 0)
+            {
+                const auto middle = std::partition(leaves, leaves + count, [&](uint32_t leaf) { return getBin(leaf) < bestSplit; });
+                leftCount = static_cast<uint32_t>(middle - leaves);
+            }
+        }
+
+        const auto child1 = BuildRange(leaves, leftCount);
+        const auto child2 = BuildRange(leaves + leftCount, count - leftCount);
+
+        const auto node = AllocateNode();
+        auto &parent = Nodes[node];
+        parent.Child1 = child1;
+        parent.Child2 = child2;
+        parent.Bounds = Aabb::Union(Nodes[child1].Bounds, Nodes[child2].Bounds);
+        parent.Height = 1 + std::max(Nodes[child1].Height, Nodes[child2].Height);
+        Nodes[child1].Parent = node;
+        Nodes[child2].Parent = node;
+        return node;
+    }
+} // Spinner
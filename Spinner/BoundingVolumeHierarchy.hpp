@@ -0,0 +1,158 @@
+#ifndef SPINNER_BOUNDINGVOLUMEHIERARCHY_HPP
+#define SPINNER_BOUNDINGVOLUMEHIERARCHY_HPP
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "Bounds.hpp"
+
+namespace Spinner
+{
+    /// Dynamic AABB tree. Leaves store fattened bounds so small movements do not touch the tree, larger ones reinsert the leaf
+    /// by the surface area heuristic and rotate the ancestors back into balance. Rebuild builds the whole tree top down with binned SAH,
+    /// which gives better trees for content that was added in bulk
+    class BoundingVolumeHierarchy
+    {
+    public:
+        using ProxyId = uint32_t;
+
+        static constexpr uint32_t NullNode = ~0u;
+
+    public:
+        BoundingVolumeHierarchy() = default;
+
+        ProxyId Insert(const Aabb &bounds, uint64_t userData);
+        void Remove(ProxyId proxy);
+        /// Returns true when the leaf was reinserted, which only happens once the bounds leave the fattened bounds it was inserted with
+        bool Move(ProxyId proxy, const Aabb &bounds);
+        /// Discards every internal node and builds the tree again top down, proxies keep their ids
+        void Rebuild();
+
+        [[nodiscard]] uint64_t GetUserData(ProxyId proxy) const;
+        [[nodiscard]] const Aabb &GetFatBounds(ProxyId proxy) const;
+        [[nodiscard]] size_t GetProxyCount() const noexcept;
+        /// 0 when empty, 1 for a single leaf
+        [[nodiscard]] uint32_t GetHeight() const noexcept;
+
+        /// Calls function with the user data of every leaf whose fattened bounds overlap (per overlaps(const Aabb &)).
+        /// function may return false to stop the query early, and may run queries of its own. Const queries may run concurrently from any thread
+        template<typename Overlaps, typename Function>
+        void Query(const Overlaps &overlaps, Function &&function) const
+        {
+            if (Root == NullNode)
+            {
+                return;
+            }
+
+            auto &queryStack = GetQueryStack();
+            const auto base = queryStack.size();
+            queryStack.push_back(Root);
+            while (queryStack.size() > base)
+            {
+                const auto &node = Nodes[queryStack.back()];
+                queryStack.pop_back();
+                if (!overlaps(node.Bounds))
+                {
+                    continue;
+                }
+
+                if (node.IsLeaf())
+                {
+                    if constexpr (std::is_same_v<std::invoke_result_t<Function &, uint64_t>, bool>)
+                    {
+                        if (!function(node.UserData))
+                        {
+                            queryStack.resize(base);
+                            return;
+                        }
+                    }
+                    else
+                    {
+                        function(node.UserData);
+                    }
+                }
+                else
+                {
+                    queryStack.push_back(node.Child2);
+                    queryStack.push_back(node.Child1);
+                }
+            }
+        }
+
+        template<typename Function>
+        void QueryAabb(const Aabb &bounds, Function &&function) const
+        {
+            Query([&bounds](const Aabb &nodeBounds) { return bounds.Overlaps(nodeBounds); }, function);
+        }
+
+        template<typename Function>
+        void QuerySphere(const Sphere &sphere, Function &&function) const
+        {
+            Query([&sphere](const Aabb &nodeBounds) { return sphere.Overlaps(nodeBounds); }, function);
+        }
+
+        template<typename Function>
+        void QueryFrustum(const Frustum &frustum, Function &&function) const
+        {
+            Query([&frustum](const Aabb &nodeBounds) { return frustum.Overlaps(nodeBounds); }, function);
+        }
+
+        /// Calls function with the user data and the distance along the ray to where it enters the leaf's fattened bounds, in no particular order
+        template<typename Function>
+        void Raycast(const Ray &ray, float maxDistance, Function &&function) const
+        {
+            float distance = 0.0f;
+            Query([&](const Aabb &nodeBounds)
+            {
+                const auto hit = ray.Intersect(nodeBounds, maxDistance);
+                distance = hit.value_or(0.0f);
+                return hit.has_value();
+            }, [&](uint64_t userData)
+            {
+                return function(userData, distance);
+            });
+        }
+
+    protected:
+        struct Node
+        {
+            Aabb Bounds;
+            uint64_t UserData = 0;
+            uint32_t Parent = NullNode; // Next free node while on the free list
+            uint32_t Child1 = NullNode;
+            uint32_t Child2 = NullNode;
+            int32_t Height = 0; // Leaves are 0, free nodes -1
+
+            [[nodiscard]] inline bool IsLeaf() const noexcept
+            {
+                return Child1 == NullNode;
+            }
+        };
+
+        std::vector<Node> Nodes;
+        uint32_t Root = NullNode;
+        uint32_t FreeList = NullNode;
+        size_t ProxyCount = 0;
+
+    protected:
+        uint32_t AllocateNode();
+        void FreeNode(uint32_t node);
+        void InsertLeaf(uint32_t leaf);
+        void RemoveLeaf(uint32_t leaf);
+        /// Refits the bounds and heights of node and its ancestors, rotating each back into balance
+        void RefitUpwards(uint32_t node);
+        /// Rotates a grandchild up when one side is more than one level taller, returns the node now in node's place
+        uint32_t Balance(uint32_t node);
+        uint32_t BuildRange(uint32_t *leaves, uint32_t count);
+
+        /// The calling thread's traversal stack, shared by nested queries and every tree on that thread. Each query only pops what it pushed
+        [[nodiscard]] static std::vector<uint32_t> &GetQueryStack();
+
+    public:
+        /// Added to each side of inserted bounds, relative to their size plus a small absolute amount so points still get room to move
+        static constexpr float FatMarginScale = 0.1f;
+        static constexpr float FatMarginMinimum = 0.01f;
+    };
+} // Spinner
+
+#endif //SPINNER_BOUNDINGVOLUMEHIERARCHY_HPP
@@ -0,0 +1,153 @@
+#ifndef SPINNER_BOUNDS_HPP
+#define SPINNER_BOUNDS_HPP
+
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include "GLM.hpp"
+
+namespace Spinner
+{
+    /// Axis aligned bounding box, empty (Min above Max) by default
+    struct Aabb
+    {
+        glm::vec3 Min{std::numeric_limits<float>::max()};
+        glm::vec3 Max{std::numeric_limits<float>::lowest()};
+
+        [[nodiscard]] inline glm::vec3 GetCenter() const
+        {
+            return (Min + Max) * 0.5f;
+        }
+
+        [[nodiscard]] inline glm::vec3 GetSize() const
+        {
+            return Max - Min;
+        }
+
+        /// Half of the surface area, the surface area heuristic only compares ratios
+        [[nodiscard]] inline float GetHalfArea() const
+        {
+            const auto size = GetSize();
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        [[nodiscard]] inline bool Contains(const Aabb &other) const
+        {
+            return Min.x <= other.Min.x && Min.y <= other.Min.y && Min.z <= other.Min.z && Max.x >= other.Max.x && Max.y >= other.Max.y && Max.z >= other.Max.z;
+        }
+
+        [[nodiscard]] inline bool Overlaps(const Aabb &other) const
+        {
+            return Min.x <= other.Max.x && Min.y <= other.Max.y && Min.z <= other.Max.z && Max.x >= other.Min.x && Max.y >= other.Min.y && Max.z >= other.Min.z;
+        }
+
+        inline void Expand(const Aabb &other)
+        {
+            Min = glm::min(Min, other.Min);
+            Max = glm::max(Max, other.Max);
+        }
+
+        inline void Expand(const glm::vec3 &point)
+        {
+            Min = glm::min(Min, point);
+            Max = glm::max(Max, point);
+        }
+
+        [[nodiscard]] static inline Aabb Union(const Aabb &a, const Aabb &b)
+        {
+            return {glm::min(a.Min, b.Min), glm::max(a.Max, b.Max)};
+        }
+
+        /// Exact bounds of a sphere (xyz center, w radius) under a transform, the sphere becomes an ellipsoid whose extent along each axis is the radius times the length of the matrix's row
+        [[nodiscard]] static inline Aabb FromTransformedSphere(const glm::vec4 &sphere, const glm::mat4 &transform)
+        {
+            const glm::vec3 center = transform * glm::vec4(glm::vec3(sphere), 1.0f);
+            glm::vec3 extent;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                extent[axis] = sphere.w * glm::length(glm::vec3(transform[0][axis], transform[1][axis], transform[2][axis]));
+            }
+            return {center - extent, center + extent};
+        }
+    };
+
+    struct Sphere
+    {
+        glm::vec3 Center{0.0f};
+        float Radius = 0.0f;
+
+        [[nodiscard]] inline bool Overlaps(const Aabb &bounds) const
+        {
+            const auto closest = glm::clamp(Center, bounds.Min, bounds.Max);
+            return glm::length2(closest - Center) <= Radius * Radius;
+        }
+    };
+
+    struct Ray
+    {
+        glm::vec3 Origin{0.0f};
+        glm::vec3 Direction{0.0f, 0.0f, 1.0f};
+
+        /// Distance along the ray (in units of Direction) where it enters the box, 0 when it starts inside. Empty when it misses the box within maxDistance
+        [[nodiscard]] inline std::optional<float> Intersect(const Aabb &bounds, float maxDistance) const
+        {
+            const glm::vec3 inverseDirection = 1.0f / Direction;
+            const glm::vec3 t0 = (bounds.Min - Origin) * inverseDirection;
+            const glm::vec3 t1 = (bounds.Max - Origin) * inverseDirection;
+            const glm::vec3 tNear = glm::min(t0, t1);
+            const glm::vec3 tFar = glm::max(t0, t1);
+            const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+            const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+            if (enter > exit)
+            {
+                return {};
+            }
+            return enter;
+        }
+    };
+
+    /// Six inward facing planes (xyz normal, w distance), a point p is inside a plane when dot(normal, p) + w >= 0
+    struct Frustum
+    {
+        std::array<glm::vec4, 6> Planes{};
+
+        /// Extracts the planes of a view projection matrix, expects the 0 to 1 clip space depth of GLM_FORCE_DEPTH_ZERO_TO_ONE
+        [[nodiscard]] static inline Frustum FromViewProjection(const glm::mat4 &viewProjection)
+        {
+            const auto row = [&viewProjection](int index) -> glm::vec4
+            {
+                return {viewProjection[0][index], viewProjection[1][index], viewProjection[2][index], viewProjection[3][index]};
+            };
+            const auto x = row(0);
+            const auto y = row(1);
+            const auto z = row(2);
+            const auto w = row(3);
+
+            Frustum frustum;
+            frustum.Planes = {w + x, w - x, w + y, w - y, z, w - z};
+            for (auto &plane : frustum.Planes)
+            {
+                plane /= glm::length(glm::vec3(plane));
+            }
+            return frustum;
+        }
+
+        /// Conservative, a box outside of the frustum but straddling two of its planes near a corner still overlaps
+        [[nodiscard]] inline bool Overlaps(const Aabb &bounds) const
+        {
+            for (const auto &plane : Planes)
+            {
+                // The box's corner furthest along the plane's normal
+                const glm::vec3 corner = {plane.x >= 0.0f ? bounds.Max.x : bounds.Min.x, plane.y >= 0.0f ? bounds.Max.y : bounds.Min.y, plane.z >= 0.0f ? bounds.Max.z : bounds.Min.z};
+                if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+} // Spinner
+
+#endif //SPINNER_BOUNDS_HPP
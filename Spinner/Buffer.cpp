@@ -2,6 +2,7 @@
 
 #include "Graphics.hpp"
 #include <cstring>
+#include <algorithm>
 #include "Image.hpp"
 
 namespace Spinner
@@ -39,13 +40,30 @@ namespace Spinner
         if (mapped)
         {
             Mapped = Graphics::GetAllocator().mapMemory(VmaAllocation);
+            HostCoherent = static_cast<bool>(Graphics::GetAllocator().getAllocationMemoryProperties(VmaAllocation) & vk::MemoryPropertyFlagBits::eHostCoherent);
             // Set buffer to 0
             std::memset(Mapped, 0, BufferSize);
+            MarkDirty(0, BufferSize);
+        }
+
+        if (IsMovable())
+        {
+            if (auto defragmenter = Graphics::GetMemoryDefragmenter())
+            {
+                defragmenter->RegisterBuffer(this);
+            }
         }
     }
 
     Buffer::~Buffer()
     {
+        if (Dirty)
+        {
+            // Unflushed writes to a buffer being destroyed can be dropped
+            Graphics::CancelMappedFlush(this);
+            Dirty = false;
+        }
+
         if (VmaAllocation)
         {
             if (Mapped != nullptr)
@@ -54,7 +72,23 @@ namespace Spinner
                 Mapped = nullptr;
             }
 
-            Graphics::GetAllocator().destroyBuffer(VkBuffer, VmaAllocation);
+            auto defragmenter = Graphics::GetMemoryDefragmenter();
+            if (defragmenter != nullptr && IsMovable())
+            {
+                defragmenter->UnregisterBuffer(this);
+            }
+
+            // If this buffer is mid-move the defragmenter takes ownership of the allocation, only the buffer handles are destroyed
+            if (defragmenter != nullptr && defragmenter->ReleaseMovingAllocation(static_cast<::VmaAllocation>(VmaAllocation)))
+            {
+                Graphics::GetDevice().destroyBuffer(VkBuffer);
+                Graphics::GetDevice().destroyBuffer(MovedFromBuffer);
+                MovedFromBuffer = nullptr;
+            }
+            else
+            {
+                Graphics::GetAllocator().destroyBuffer(VkBuffer, VmaAllocation);
+            }
 
             VkBuffer = nullptr;
             VmaAllocation = nullptr;
@@ -72,8 +106,8 @@ namespace Spinner
 
         if (Mapped != nullptr)
         {
-            std::memcpy(Mapped, data, size);
-            Graphics::GetAllocator().flushAllocation(VmaAllocation, offset, size);
+            std::memcpy(static_cast<uint8_t *>(Mapped) + offset, data, size);
+            MarkDirty(offset, size);
         }
         else
         {
@@ -106,6 +140,87 @@ namespace Spinner
         }
     }
 
+    void Buffer::MarkDirty(vk::DeviceSize offset, vk::DeviceSize size)
+    {
+        if (HostCoherent || size == 0)
+        {
+            return;
+        }
+
+        if (!Dirty)
+        {
+            Dirty = true;
+            DirtyRangeBegin = offset;
+            DirtyRangeEnd = offset + size;
+            Graphics::QueueMappedFlush(this);
+        }
+        else
+        {
+            DirtyRangeBegin = std::min(DirtyRangeBegin, offset);
+            DirtyRangeEnd = std::max(DirtyRangeEnd, offset + size);
+        }
+    }
+
+    void Buffer::Flush()
+    {
+        if (!Dirty)
+        {
+            return;
+        }
+
+        Graphics::CancelMappedFlush(this);
+        Graphics::GetAllocator().flushAllocation(VmaAllocation, DirtyRangeBegin, DirtyRangeEnd - DirtyRangeBegin);
+        Dirty = false;
+    }
+
+    bool Buffer::IsMovable() const
+    {
+        // Only device local buffers which can be copied from are moved, mapped pointers would be invalidated
+        return Mapped == nullptr && VmaMemoryUsage == vma::MemoryUsage::eGpuOnly && static_cast<bool>(BufferUsageFlags & vk::BufferUsageFlagBits::eTransferSrc);
+    }
+
+    bool Buffer::BeginMove(::VmaAllocation destination, const CommandBuffer::Pointer &commandBuffer)
+    {
+        if (!IsMovable() || MovedFromBuffer)
+        {
+            return false;
+        }
+
+        vk::BufferCreateInfo bufferInfo;
+        bufferInfo.usage = BufferUsageFlags | vk::BufferUsageFlagBits::eTransferDst;
+        bufferInfo.size = BufferSize;
+
+        auto &device = Graphics::GetDevice();
+        vk::Buffer newBuffer = device.createBuffer(bufferInfo);
+        Graphics::GetAllocator().bindBufferMemory(vma::Allocation(destination), newBuffer);
+
+        // Earlier submissions, such as an upload batch whose fence has not signalled yet, may still be writing the old buffer
+        commandBuffer->InsertBufferMemoryBarrier(VkBuffer, vk::AccessFlagBits2::eMemoryWrite, vk::AccessFlagBits2::eTransferRead, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eTransfer);
+
+        vk::BufferCopy copyRegion;
+        copyRegion.size = BufferSize;
+        copyRegion.srcOffset = 0;
+        copyRegion.dstOffset = 0;
+        commandBuffer->CopyBuffer(VkBuffer, newBuffer, copyRegion);
+
+        // The pass is not waited on, so frames submitted after it must see the copy before they read the new buffer
+        commandBuffer->InsertBufferMemoryBarrier(newBuffer, vk::AccessFlagBits2::eTransferWrite, vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite, vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eAllCommands);
+
+        MovedFromBuffer = VkBuffer;
+        VkBuffer = newBuffer;
+
+        return true;
+    }
+
+    void Buffer::FinishMove()
+    {
+        if (MovedFromBuffer)
+        {
+            Graphics::GetDevice().destroyBuffer(MovedFromBuffer);
+            MovedFromBuffer = nullptr;
+        }
+    }
+
     void Buffer::CopyTo(const Buffer::Pointer &destination, CommandBuffer::Pointer commandBuffer)
     {
         // Ensure we can transfer from this
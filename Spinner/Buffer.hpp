@@ -14,6 +14,9 @@ namespace Spinner
 
     class Buffer : public std::enable_shared_from_this<Buffer>
     {
+        friend class Graphics;
+        friend class MemoryDefragmenter;
+
     public:
         using Pointer = std::shared_ptr<Buffer>;
 
@@ -22,6 +25,7 @@ namespace Spinner
 
     public:
         /// Writes data to the buffer directly if cpu accessible, otherwise via a staging buffer. Staging requires this buffer to have TransferDst usage flags
+        /// Mapped writes to non host-coherent memory are flushed by Graphics before the next queue submission
         void Write(const void *data, vk::DeviceSize size, vk::DeviceAddress offset = 0, Spinner::CommandBuffer::Pointer commandBuffer = nullptr);
 
         template<typename T>
@@ -30,6 +34,9 @@ namespace Spinner
             Write(reinterpret_cast<const void *>(&data), sizeof(T), 0, commandBuffer);
         }
 
+        /// Immediately flushes any pending mapped writes instead of waiting for the next submission
+        void Flush();
+
         /// Copies the buffer to another buffer. Requires this buffer to have TransferSrc and destination buffer to have TransferDst usage flags
         void CopyTo(const Buffer::Pointer &destination, CommandBuffer::Pointer commandBuffer = nullptr);
 
@@ -46,6 +53,24 @@ namespace Spinner
         vma::MemoryUsage VmaMemoryUsage;
 
         void *Mapped = nullptr;
+        bool HostCoherent = false;
+
+    protected:
+        // Dirty range of mapped writes which have not been flushed yet
+        bool Dirty = false;
+        vk::DeviceSize DirtyRangeBegin = 0;
+        vk::DeviceSize DirtyRangeEnd = 0;
+        size_t DirtyListIndex = 0; // Position in Graphics' dirty list while Dirty, so cancelling the flush is a swap and pop
+
+        void MarkDirty(vk::DeviceSize offset, vk::DeviceSize size);
+
+        // Old buffer handle kept alive while a defragmentation pass moves this buffer
+        vk::Buffer MovedFromBuffer = nullptr;
+
+        [[nodiscard]] bool IsMovable() const;
+        /// Binds a new buffer to the destination allocation and records a copy into it, swapping VkBuffer to the new buffer
+        bool BeginMove(::VmaAllocation destination, const CommandBuffer::Pointer &commandBuffer);
+        void FinishMove();
 
     public:
         static Pointer CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usageFlags, vma::MemoryUsage memoryUsage, vk::DeviceSize alignment = 0, bool mapped = false);
@@ -6,6 +6,7 @@
 #include <memory>
 #include <iostream>
 #include <atomic>
+#include "ObjectPool.hpp"
 
 namespace Spinner
 {
@@ -18,7 +19,7 @@ namespace Spinner
 
         inline static Pointer Create()
         {
-            return std::make_shared<CallbackOwnerToken>();
+            return std::allocate_shared<CallbackOwnerToken>(PoolAllocator<CallbackOwnerToken>());
         }
     };
 
@@ -1,5 +1,6 @@
 #include "CommandBuffer.hpp"
 
+#include <algorithm>
 #include <utility>
 #include "VulkanInstance.hpp"
 #include "VulkanUtilities.hpp"
@@ -176,14 +177,20 @@ namespace Spinner
         VkCommandBuffer.setDepthBias(depthBiasConstant, depthBiasClamp, depthBiasSlope);
     }
 
-    void CommandBuffer::DrawMesh(const std::shared_ptr<MeshBuffer> &meshBuffer)
+    void CommandBuffer::DrawMesh(const std::shared_ptr<MeshBuffer> &meshBuffer, uint32_t lod)
     {
         // Binding
         VkCommandBuffer.setVertexInputEXT(meshBuffer->VertexBindingDescription, meshBuffer->VertexAttributeDescriptions, VulkanInstance::GetDispatchLoader());
         VkCommandBuffer.bindVertexBuffers(0, meshBuffer->VkBuffer, {meshBuffer->VertexDataOffset});
-        VkCommandBuffer.bindIndexBuffer(meshBuffer->VkBuffer, meshBuffer->IndexDataOffset, GetVkIndexType<MeshBuffer::IndexType>());
+        VkCommandBuffer.bindIndexBuffer(meshBuffer->VkBuffer, meshBuffer->IndexDataOffset, meshBuffer->IndexBufferType);
         // Drawing
-        VkCommandBuffer.drawIndexed(meshBuffer->IndexCount, 1, 0, 0, 0);
+        if (meshBuffer->Lods.empty())
+        {
+            VkCommandBuffer.drawIndexed(meshBuffer->IndexCount, 1, 0, 0, 0);
+            return;
+        }
+        const auto &level = meshBuffer->Lods[std::min(lod, static_cast<uint32_t>(meshBuffer->Lods.size() - 1))];
+        VkCommandBuffer.drawIndexed(level.IndexCount, 1, level.FirstIndex, 0, 0);
     }
 
     void CommandBuffer::BindDescriptors(vk::PipelineLayout layout, uint32_t firstSet, const vk::ArrayProxy<const vk::DescriptorSet> &sets, vk::PipelineBindPoint bindPoint)
@@ -191,6 +198,23 @@ namespace Spinner
         VkCommandBuffer.bindDescriptorSets(bindPoint, layout, firstSet, sets, nullptr);
     }
 
+    void CommandBuffer::InsertBufferMemoryBarrier(vk::Buffer buffer, vk::AccessFlags2 srcAccessMask, vk::AccessFlags2 dstAccessMask, vk::PipelineStageFlags2 srcStageMask, vk::PipelineStageFlags2 dstStageMask, vk::DeviceSize offset, vk::DeviceSize size)
+    {
+        vk::BufferMemoryBarrier2 bufferMemoryBarrier;
+        bufferMemoryBarrier.buffer = buffer;
+        bufferMemoryBarrier.srcAccessMask = srcAccessMask;
+        bufferMemoryBarrier.dstAccessMask = dstAccessMask;
+        bufferMemoryBarrier.srcStageMask = srcStageMask;
+        bufferMemoryBarrier.dstStageMask = dstStageMask;
+        bufferMemoryBarrier.offset = offset;
+        bufferMemoryBarrier.size = size;
+
+        vk::DependencyInfo dependencyInfo;
+        dependencyInfo.setBufferMemoryBarriers(bufferMemoryBarrier);
+
+        VkCommandBuffer.pipelineBarrier2(dependencyInfo);
+    }
+
     void CommandBuffer::InsertImageMemoryBarrier(vk::Image image, vk::AccessFlags2 srcAccessMask, vk::AccessFlags2 dstAccessMask, vk::ImageLayout oldImageLayout, vk::ImageLayout newImageLayout, vk::PipelineStageFlags2 srcStageMask, vk::PipelineStageFlags2 dstStageMask, vk::ImageSubresourceRange subresourceRange)
     {
         vk::ImageMemoryBarrier2 imageMemoryBarrier;
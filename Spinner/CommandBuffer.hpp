@@ -67,9 +67,11 @@ namespace Spinner
         void SetDrawParameters(vk::CullModeFlags cullMode = vk::CullModeFlagBits::eBack, vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList, vk::FrontFace frontFace = vk::FrontFace::eCounterClockwise, vk::PolygonMode polygonMode = vk::PolygonMode::eFill, bool primitiveRestartEnabled = false);
         void SetDepthParameters(vk::CompareOp compareOp = vk::CompareOp::eLessOrEqual, bool depthWrite = true, bool depthTest = true, bool depthBiasEnable = false, float depthBiasConstant = 1.0f, float depthBiasSlope = 0.0f, float depthBiasClamp = 0.0f);
 
-        void DrawMesh(const std::shared_ptr<MeshBuffer> &meshBuffer);
+        /// Draws the index range of one of the mesh's levels of detail, clamped to the coarsest
+        void DrawMesh(const std::shared_ptr<MeshBuffer> &meshBuffer, uint32_t lod = 0);
         void BindDescriptors(vk::PipelineLayout layout, uint32_t firstSet, const vk::ArrayProxy<const vk::DescriptorSet> &sets, vk::PipelineBindPoint bindPoint = vk::PipelineBindPoint::eGraphics);
 
+        void InsertBufferMemoryBarrier(vk::Buffer buffer, vk::AccessFlags2 srcAccessMask, vk::AccessFlags2 dstAccessMask, vk::PipelineStageFlags2 srcStageMask, vk::PipelineStageFlags2 dstStageMask, vk::DeviceSize offset = 0, vk::DeviceSize size = vk::WholeSize);
         void InsertImageMemoryBarrier(vk::Image image, vk::AccessFlags2 srcAccessMask, vk::AccessFlags2 dstAccessMask, vk::ImageLayout oldImageLayout, vk::ImageLayout newImageLayout, vk::PipelineStageFlags2 srcStageMask, vk::PipelineStageFlags2 dstStageMask, vk::ImageSubresourceRange subresourceRange);
         void TransitionImageLayout(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, vk::ImageAspectFlags aspectFlags = vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlags2 srcStage = vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlags2 dstStage = vk::PipelineStageFlagBits2::eAllCommands, std::optional<vk::ImageSubresourceRange> subresourceRange = {});
         void TransitionImageLayout(const std::shared_ptr<Image> &image, vk::ImageLayout newLayout, vk::ImageAspectFlags aspectFlags = vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlags2 srcStage = vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlags2 dstStage = vk::PipelineStageFlagBits2::eAllCommands, std::optional<vk::ImageSubresourceRange> subresourceRange = {});
@@ -0,0 +1,52 @@
+#include "ComponentPools.hpp"
+
+#include <cassert>
+
+namespace Spinner
+{
+    void ComponentPools::Add(Components::Component *component, SceneObject *owner)
+    {
+        const auto componentId = component->GetComponentId();
+        assert(componentId >= 0);
+        if (static_cast<size_t>(componentId) >= Pools.size())
+        {
+            Pools.resize(componentId + 1);
+        }
+
+        auto &pool = Pools[componentId];
+        component->PoolSlot = static_cast<uint32_t>(pool.Components.size());
+        pool.Components.push_back(component);
+        pool.Owners.push_back(owner);
+    }
+
+    void ComponentPools::Remove(Components::Component *component)
+    {
+        auto &pool = Pools[component->GetComponentId()];
+        const auto slot = component->PoolSlot;
+        assert(slot < pool.Components.size() && pool.Components[slot] == component);
+
+        // The last component takes the removed one's slot
+        pool.Components[slot] = pool.Components.back();
+        pool.Owners[slot] = pool.Owners.back();
+        pool.Components[slot]->PoolSlot = slot;
+        pool.Components.pop_back();
+        pool.Owners.pop_back();
+
+        component->PoolSlot = Components::Component::NoPoolSlot;
+    }
+
+    const ComponentPools::Pool *ComponentPools::GetPool(Components::ComponentId componentId) const
+    {
+        if (componentId < 0 || static_cast<size_t>(componentId) >= Pools.size())
+        {
+            return nullptr;
+        }
+        return &Pools[componentId];
+    }
+
+    const ComponentPools::Pointer &ComponentPools::GetDetachedPools()
+    {
+        static const Pointer detachedPools = std::make_shared<ComponentPools>();
+        return detachedPools;
+    }
+} // Spinner
@@ -0,0 +1,75 @@
+#ifndef SPINNER_COMPONENTPOOLS_HPP
+#define SPINNER_COMPONENTPOOLS_HPP
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "Components/Component.hpp"
+
+namespace Spinner
+{
+    /// Dense per component type lists of a scene's components, so systems can visit every component of a type without walking the hierarchy.
+    /// Each scene owns one, objects outside of a scene share the detached pools. Components stay owned by their SceneObject,
+    /// the pools only point at them and each component records its slot so removal is a swap and pop
+    class ComponentPools
+    {
+    public:
+        using Pointer = std::shared_ptr<ComponentPools>;
+
+    public:
+        ComponentPools() = default;
+
+        void Add(Components::Component *component, SceneObject *owner);
+        void Remove(Components::Component *component);
+
+        template<Components::IsComponent T>
+        [[nodiscard]] size_t GetCount() const
+        {
+            const auto *pool = GetPool(Components::GetComponentId<T>());
+            return (pool != nullptr) ? pool->Components.size() : 0;
+        }
+
+        /// Calls function with a T & (and the owning SceneObject & if it takes one) for every component of the type, in no particular order.
+        /// Components of the type must not be added or removed while visiting
+        template<Components::IsComponent T, typename Function>
+        void ForEach(Function &&function) const
+        {
+            const auto *pool = GetPool(Components::GetComponentId<T>());
+            if (pool == nullptr)
+            {
+                return;
+            }
+
+            for (size_t slot = 0; slot < pool->Components.size(); slot++)
+            {
+                auto &component = *static_cast<T *>(pool->Components[slot]);
+                if constexpr (std::is_invocable_v<Function &, T &, SceneObject &>)
+                {
+                    function(component, *pool->Owners[slot]);
+                }
+                else
+                {
+                    function(component);
+                }
+            }
+        }
+
+    protected:
+        struct Pool
+        {
+            std::vector<Components::Component *> Components;
+            std::vector<SceneObject *> Owners;
+        };
+
+        std::vector<Pool> Pools; // Indexed by ComponentId
+
+    protected:
+        [[nodiscard]] const Pool *GetPool(Components::ComponentId componentId) const;
+
+    public:
+        /// Shared by every object which is not in a scene
+        static const Pointer &GetDetachedPools();
+    };
+} // Spinner
+
+#endif //SPINNER_COMPONENTPOOLS_HPP
@@ -1,15 +1,89 @@
 #include "Component.hpp"
 
+#include <cassert>
+#include <vector>
 #include "../SceneObject.hpp"
+#include "../ObjectPool.hpp"
 #include <imgui.h>
 #include <misc/cpp/imgui_stdlib.h>
 #include "Components.hpp"
 
 namespace Spinner
 {
+    struct ComponentSlot
+    {
+        Components::Component *Component = nullptr;
+        uint32_t Generation = 1;
+    };
+
+    struct ComponentSlotTable
+    {
+        std::vector<ComponentSlot> Slots;
+        std::vector<uint32_t> FreeSlots;
+    };
+
+    static std::vector<ComponentSlotTable> SlotTables; // Indexed by ComponentId
+
     Components::Component::Component(const std::weak_ptr<Spinner::SceneObject> &sceneObject, Spinner::Components::ComponentId componentId, int64_t componentIndex) : SceneObject(sceneObject), ComponentId(componentId), ComponentIndex(componentIndex)
     {
+        assert(componentId >= 0);
+        if (static_cast<size_t>(componentId) >= SlotTables.size())
+        {
+            SlotTables.resize(componentId + 1);
+        }
+
+        auto &table = SlotTables[componentId];
+        if (!table.FreeSlots.empty())
+        {
+            Handle.Index = table.FreeSlots.back();
+            table.FreeSlots.pop_back();
+        }
+        else
+        {
+            Handle.Index = static_cast<uint32_t>(table.Slots.size());
+            table.Slots.emplace_back();
+        }
+
+        auto &slot = table.Slots[Handle.Index];
+        slot.Component = this;
+        Handle.Generation = slot.Generation;
+    }
+
+    Components::Component::~Component()
+    {
+        auto &table = SlotTables[ComponentId];
+        auto &slot = table.Slots[Handle.Index];
+        slot.Component = nullptr;
+        if (++slot.Generation == 0)
+        {
+            slot.Generation = 1;
+        }
+        table.FreeSlots.push_back(Handle.Index);
+    }
+
+    void *Components::Component::operator new(size_t size)
+    {
+        return ObjectPool::AllocateShared(size);
+    }
 
+    void Components::Component::operator delete(void *block, size_t size) noexcept
+    {
+        ObjectPool::FreeShared(block, size);
+    }
+
+    Components::Component *Components::Component::Resolve(Components::ComponentId componentId, ComponentHandle handle) noexcept
+    {
+        if (componentId < 0 || static_cast<size_t>(componentId) >= SlotTables.size())
+        {
+            return nullptr;
+        }
+
+        const auto &slots = SlotTables[componentId].Slots;
+        if (handle.Index >= slots.size() || slots[handle.Index].Generation != handle.Generation)
+        {
+            return nullptr;
+        }
+        return slots[handle.Index].Component;
     }
 
     std::weak_ptr<Spinner::SceneObject> Components::Component::GetSceneObjectWeak() const
@@ -42,6 +116,11 @@ namespace Spinner
         return ComponentIndex;
     }
 
+    Components::ComponentHandle Components::Component::GetHandle() const noexcept
+    {
+        return Handle;
+    }
+
     std::string Components::Component::GetComponentName() const noexcept
     {
         return Name;
@@ -10,6 +10,7 @@
 namespace Spinner
 {
     class SceneObject;
+    class ComponentPools;
 
     namespace Components
     {
@@ -31,12 +32,33 @@ namespace Spinner
             std::string Text;
         };
 
+        /// A component's slot in its type's slot table, and the slot's generation when the component was given it.
+        /// The generation changes when the component is destroyed, so a handle never resolves to a later component reusing the slot
+        struct ComponentHandle
+        {
+            static constexpr uint32_t InvalidIndex = ~0u;
+
+            uint32_t Index = InvalidIndex;
+            uint32_t Generation = 0; // Never 0 for a handed out slot
+
+            bool operator==(const ComponentHandle &) const = default;
+        };
+
         class Component : public Object
         {
+            friend class Spinner::ComponentPools;
+
         public:
             using Pointer = std::unique_ptr<Component>;
 
+            static constexpr uint32_t NoPoolSlot = ~0u;
+
             explicit Component(const std::weak_ptr<Spinner::SceneObject> &sceneObject, ComponentId componentId, int64_t componentIndex);
+            ~Component() override;
+
+            /// Components come from the shared size class pools, the virtual destructor hands delete the derived type's size
+            static void *operator new(size_t size);
+            static void operator delete(void *block, size_t size) noexcept;
 
         protected:
             std::weak_ptr<Spinner::SceneObject> SceneObject{};
@@ -44,6 +66,8 @@ namespace Spinner
             const int64_t ComponentIndex = -1;
             std::string Name;
             bool Active = true;
+            uint32_t PoolSlot = NoPoolSlot; // Index in the owning scene's ComponentPools
+            ComponentHandle Handle;
 
         public:
             [[nodiscard]] std::weak_ptr<Spinner::SceneObject> GetSceneObjectWeak() const;
@@ -52,10 +76,15 @@ namespace Spinner
             void SetActive(bool active) noexcept;
             [[nodiscard]] Components::ComponentId GetComponentId() const noexcept;
             [[nodiscard]] int64_t GetComponentIndex() const noexcept;
+            [[nodiscard]] ComponentHandle GetHandle() const noexcept;
             [[nodiscard]] std::string GetComponentName() const noexcept;
             void SetComponentName(const std::string &name) noexcept;
 
             void BaseRenderDebugUI();
+
+        public:
+            /// Returns nullptr when the handle's component has been destroyed (or the handle is invalid). O(1), main thread only
+            [[nodiscard]] static Component *Resolve(Components::ComponentId componentId, ComponentHandle handle) noexcept;
         };
 
         template<typename T>
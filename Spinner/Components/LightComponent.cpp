@@ -4,6 +4,8 @@
 #include "../Constants.hpp"
 #include "../Scene.hpp"
 #include "../DrawCommand.hpp"
+#include "../Graphics.hpp"
+#include "../DrawManager.hpp"
 #include "MeshComponent.hpp"
 
 #include <imgui.h>
@@ -17,6 +19,22 @@ namespace Spinner
             SetupShadows({ShadowMapWidth, ShadowMapWidth});
         }
 
+        LightComponent::~LightComponent()
+        {
+            ReleaseShadows();
+        }
+
+        void LightComponent::ReleaseShadows()
+        {
+            Graphics::DeferRelease(std::move(ShadowMapImage));
+            for (auto &shadowSceneBuffer : ShadowSceneBuffers)
+            {
+                Graphics::DeferRelease(std::move(shadowSceneBuffer));
+            }
+            ShadowMapImage = nullptr;
+            ShadowSceneBuffers.clear();
+        }
+
         Spinner::LightType LightComponent::GetLightType() const
         {
             return LightType;
@@ -262,39 +280,41 @@ namespace Spinner
             sceneConstants.ViewProjection = projection * view;
 
             shadowSceneBuffer->Write<SceneConstants>(sceneConstants);
-            commandBuffer->TrackObject(shadowSceneBuffer);
 
-            scene->GetObjectTree()->TraverseActive([&](const Spinner::SceneObject::Pointer &meshSceneObject) -> bool
+            scene->ForEachComponent<MeshComponent>([&](MeshComponent &meshComponent, Spinner::SceneObject &meshSceneObject)
             {
-                auto meshComponents = meshSceneObject->GetComponentRawPointers<Components::MeshComponent>();
-                for (auto &meshComponent : meshComponents)
-                {
-                    if (!meshComponent->GetActive())
-                        continue;
+                if (!meshSceneObject.IsActive() || !meshComponent.GetActive())
+                    return;
 
-                    // Update constant buffer with position
-                    auto meshConstants = meshComponent->GetMeshConstants();
-                    meshConstants.Model = meshSceneObject->GetWorldMatrix();
-                    meshComponent->UpdateConstantBuffer(meshConstants);
+                // Update constant buffer with position
+                auto meshConstants = meshComponent.GetMeshConstants();
+                meshConstants.Model = meshSceneObject.GetWorldMatrix();
+                meshComponent.UpdateConstantBuffer(meshConstants);
 
-                    // Create main draw command
-                    auto drawCommand = CreateShadowDrawCommand(descriptorPool, meshComponent);
-                    drawCommand->UseSceneBuffer(shadowSceneBuffer);
+                // Create main draw command
+                auto drawCommand = CreateShadowDrawCommand(descriptorPool, &meshComponent);
+                drawCommand->UseSceneBuffer(shadowSceneBuffer);
 
-                    meshComponent->UpdateShadow(drawCommand);
+                meshComponent.UpdateShadow(drawCommand);
 
-                    // Render
-                    drawCommand->DrawMesh(commandBuffer);
+                // Shadow maps are usually lower resolution than the screen, but never draw finer than the camera so the mesh cannot self shadow against a coarser surface
+                if (auto meshBuffer = meshComponent.GetMeshBuffer(); meshBuffer != nullptr)
+                {
+                    drawCommand->UseLod(std::max(meshComponent.GetLod(), DrawManager::SelectLod(*meshBuffer, meshConstants.Model, sceneConstants)));
                 }
 
-                return true;
-            }, nullptr);
+                // Render
+                drawCommand->DrawMesh(commandBuffer);
+            });
 
             commandBuffer->EndRendering();
         }
 
         void LightComponent::SetupShadows(vk::Extent2D shadowTextureSize)
         {
+            // Previous images and buffers may still be in use by an in-flight frame
+            ReleaseShadows();
+
             // Destroy any previous images
             /*if (ShadowMapImage != nullptr)
             {
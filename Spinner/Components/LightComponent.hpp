@@ -22,6 +22,7 @@ namespace Spinner
             constexpr static vk::ImageUsageFlags ShadowMapUsage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eDepthStencilAttachment;
 
             LightComponent(const std::weak_ptr<Spinner::SceneObject> &sceneObject, int64_t componentIndex);
+            ~LightComponent() override;
 
         protected:
             float InnerSpotAngle = glm::radians(35.0f);
@@ -69,6 +70,7 @@ namespace Spinner
         protected:
             void RenderShadowFace(uint32_t faceIndex, CommandBuffer::Pointer &commandBuffer, const Spinner::DescriptorPool::Pointer &descriptorPool);
             void SetupShadows(vk::Extent2D shadowTextureSize);
+            void ReleaseShadows();
         };
 
         template<>
@@ -7,6 +7,7 @@
 #include "../Scene.hpp"
 #include "../DrawCommand.hpp"
 #include "../Lighting.hpp"
+#include "../Graphics.hpp"
 #include <imgui.h>
 
 namespace Spinner::Components
@@ -16,6 +17,16 @@ namespace Spinner::Components
         ConstantBuffer = Buffer::CreateBuffer(sizeof(ConstantBufferType), vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eCpuToGpu, 0, true);
     }
 
+    MeshComponent::~MeshComponent()
+    {
+        // Frames in flight may still be drawing with these resources
+        Graphics::DeferRelease(std::move(ShaderGroup));
+        Graphics::DeferRelease(std::move(ShadowShaderGroup));
+        Graphics::DeferRelease(std::move(MeshBuffer));
+        Graphics::DeferRelease(std::move(Material));
+        Graphics::DeferRelease(std::move(ConstantBuffer));
+    }
+
     Spinner::ShaderGroup::Pointer MeshComponent::GetShaderGroup() const
     {
         return ShaderGroup;
@@ -23,6 +34,7 @@ namespace Spinner::Components
 
     void MeshComponent::SetShaderGroup(const Spinner::ShaderGroup::Pointer &shaderGroup)
     {
+        Graphics::DeferRelease(std::move(ShaderGroup));
         ShaderGroup = shaderGroup;
     }
 
@@ -33,17 +45,30 @@ namespace Spinner::Components
 
     void MeshComponent::SetShadowShaderGroup(const Spinner::ShaderGroup::Pointer &shaderGroup)
     {
+        Graphics::DeferRelease(std::move(ShadowShaderGroup));
         ShadowShaderGroup = shaderGroup;
     }
 
-    Spinner::MeshBuffer::Pointer MeshComponent::GetMeshBuffer()
+    const Spinner::MeshBuffer::Pointer &MeshComponent::GetMeshBuffer() const
     {
         return MeshBuffer;
     }
 
     void MeshComponent::SetMeshBuffer(Spinner::MeshBuffer::Pointer newMeshShader)
     {
+        Graphics::DeferRelease(std::move(MeshBuffer));
         MeshBuffer = std::move(newMeshShader);
+        Lod = 0;
+    }
+
+    uint32_t MeshComponent::GetLod() const
+    {
+        return Lod;
+    }
+
+    void MeshComponent::SetLod(uint32_t lod)
+    {
+        Lod = lod;
     }
 
     Spinner::Material::Pointer MeshComponent::GetMaterial()
@@ -53,6 +78,7 @@ namespace Spinner::Components
 
     void MeshComponent::SetMaterial(const Material::Pointer &material)
     {
+        Graphics::DeferRelease(std::move(Material));
         Material = material;
     }
 
@@ -78,13 +104,8 @@ namespace Spinner::Components
         if (Material == nullptr || ShaderGroup == nullptr)
             return;
 
-        // Update material
-        auto constants = GetMeshConstants();
-        Material->ApplyMaterial(constants);
-        UpdateConstantBuffer(constants);
-
-        drawCommand->UseMeshBuffer(MeshBuffer);
-        drawCommand->UseMaterial(Material);
+        UpdateDrawConstants(drawCommand);
+        drawCommand->UseLod(Lod);
 
         if (Material->IsTransparent())
         {
@@ -101,15 +122,25 @@ namespace Spinner::Components
         if (Material == nullptr || ShadowShaderGroup == nullptr)
             return;
 
+        UpdateDrawConstants(drawCommand);
+
+        ShadowShaderGroup->RunUpdateDrawComponentCallbacks(drawCommand, this);
+    }
+
+    void MeshComponent::UpdateDrawConstants(const std::shared_ptr<DrawCommand> &drawCommand)
+    {
         // Update material
         auto constants = GetMeshConstants();
         Material->ApplyMaterial(constants);
+        if (MeshBuffer != nullptr)
+        {
+            constants.PositionDequantizeOffset = MeshBuffer->PositionDequantizeOffset;
+            constants.PositionDequantizeScale = MeshBuffer->PositionDequantizeScale;
+        }
         UpdateConstantBuffer(constants);
 
         drawCommand->UseMeshBuffer(MeshBuffer);
         drawCommand->UseMaterial(Material);
-        
-        ShadowShaderGroup->RunUpdateDrawComponentCallbacks(drawCommand, this);
     }
 
     void MeshComponent::RenderDebugUI()
@@ -118,8 +149,13 @@ namespace Spinner::Components
 
         if (MeshBuffer != nullptr)
         {
-            ImGui::Text("Mesh Buffer Index Count: %u", MeshBuffer->IndexCount);
+            ImGui::Text("Mesh Buffer Index Count: %u (%s)", MeshBuffer->IndexCount, vk::to_string(MeshBuffer->IndexBufferType).c_str());
             ImGui::Text("Mesh Buffer Total Buffer Size: %lu", MeshBuffer->BufferSize);
+            if (Lod < MeshBuffer->Lods.size())
+            {
+                const auto &lod = MeshBuffer->Lods[Lod];
+                ImGui::Text("LOD: %u of %zu, %u indices, error %.4f", Lod, MeshBuffer->Lods.size(), lod.IndexCount, static_cast<double>(lod.Error));
+            }
         }
         else
         {
@@ -24,6 +24,7 @@ namespace Spinner
             using ConstantBufferType = MeshConstants;
 
             MeshComponent(const std::weak_ptr<Spinner::SceneObject> &sceneObject, int64_t componentIndex);
+            ~MeshComponent() override;
 
         protected:
             Spinner::ShaderGroup::Pointer ShaderGroup;
@@ -32,6 +33,12 @@ namespace Spinner
             Spinner::Material::Pointer Material = nullptr;
             Spinner::Buffer::Pointer ConstantBuffer;
             ConstantBufferType LocalConstantBuffer{};
+            // Level of detail last selected for the camera, selection keeps it until the error moves past the hysteresis band
+            uint32_t Lod = 0;
+
+        protected:
+            /// Shared by the colour and shadow passes: writes the material and dequantization constants, then binds the mesh buffer and material
+            void UpdateDrawConstants(const std::shared_ptr<DrawCommand> &drawCommand);
 
         public:
             [[nodiscard]] Spinner::ShaderGroup::Pointer GetShaderGroup() const;
@@ -40,9 +47,12 @@ namespace Spinner
             [[nodiscard]] Spinner::ShaderGroup::Pointer GetShadowShaderGroup() const;
             void SetShadowShaderGroup(const Spinner::ShaderGroup::Pointer &shaderGroup);
 
-            Spinner::MeshBuffer::Pointer GetMeshBuffer();
+            [[nodiscard]] const Spinner::MeshBuffer::Pointer &GetMeshBuffer() const;
             void SetMeshBuffer(Spinner::MeshBuffer::Pointer newMeshBuffer);
 
+            [[nodiscard]] uint32_t GetLod() const;
+            void SetLod(uint32_t lod);
+
             [[nodiscard]] Spinner::Material::Pointer GetMaterial();
             void SetMaterial(const Spinner::Material::Pointer &material);
 
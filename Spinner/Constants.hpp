@@ -13,6 +13,8 @@ namespace Spinner
         alignas(16) glm::mat4 Model{1.0f};
         alignas(16) glm::vec4 MaterialColor = {1.0f, 1.0f, 1.0f, 1.0f}; // Red, Green, Blue, Alpha
         alignas(16) glm::vec4 MaterialProperties = {0.5f, 0.0f, 0.0f, 0.0f}; // Roughness, Metallic, Emission Strength, Unused
+        alignas(16) glm::vec4 PositionDequantizeOffset = {0.0f, 0.0f, 0.0f, 0.0f}; // Quantized positions are offset + position * scale
+        alignas(16) glm::vec4 PositionDequantizeScale = {1.0f, 1.0f, 1.0f, 1.0f};
         alignas(16) float CustomMaterialProperties[CustomMaterialPropertyCount] = {0.0f};
     };
 
@@ -81,6 +81,16 @@ namespace Spinner
         Pass = pass;
     }
 
+    uint32_t DrawCommand::GetLod() const
+    {
+        return Lod;
+    }
+
+    void DrawCommand::UseLod(uint32_t lod)
+    {
+        Lod = lod;
+    }
+
     void DrawCommand::DrawMesh(const CommandBuffer::Pointer &commandBuffer)
     {
         if (MeshBuffer == nullptr || Material == nullptr)
@@ -88,15 +98,10 @@ namespace Spinner
             return;
         }
 
-        commandBuffer->TrackObject(ShaderGroup);
-        commandBuffer->TrackObject(MeshBuffer);
-        commandBuffer->TrackObject(Material);
-        commandBuffer->TrackObject(Lighting);
-        commandBuffer->TrackObject(SceneBuffer);
-
+        // Resources are kept alive by their owners, which defer their release through Graphics::DeferRelease
         ShaderGroup->BindShaders(commandBuffer);
         commandBuffer->BindDescriptors(OperatingShader->GetPipelineLayout(), 0, DescriptorSets, vk::PipelineBindPoint::eGraphics);
-        commandBuffer->DrawMesh(MeshBuffer);
+        commandBuffer->DrawMesh(MeshBuffer, Lod);
     }
 
     uint32_t DrawCommand::GetDescriptorSetCount() const
@@ -34,6 +34,7 @@ namespace Spinner
         Spinner::Buffer::Pointer SceneBuffer;
 
         Spinner::Pass Pass = OpaquePass;
+        uint32_t Lod = 0;
 
     public:
         void UseMeshBuffer(const Spinner::MeshBuffer::Pointer &meshBuffer);
@@ -43,6 +44,8 @@ namespace Spinner
 
         [[nodiscard]] Spinner::Pass GetPass() const;
         void UsePass(Spinner::Pass pass);
+        [[nodiscard]] uint32_t GetLod() const;
+        void UseLod(uint32_t lod);
 
         void DrawMesh(const CommandBuffer::Pointer &commandBuffer);
 
@@ -1,7 +1,10 @@
 #include "DrawManager.hpp"
 
+#include <algorithm>
+
 #include "Graphics.hpp"
 #include "Lighting.hpp"
+#include "JobSystem.hpp"
 #include "Scene.hpp"
 #include "Components/LightComponent.hpp"
 
@@ -31,7 +34,10 @@ namespace Spinner
     void DrawManager::Update(const Components::ComponentPtr<Components::CameraComponent> &cameraComponent)
     {
         DescriptorPool->ResetPool();
-        DrawCommands.clear();
+
+        CurrentDrawCommandList = (CurrentDrawCommandList + 1) % DrawCommandLists.size();
+        auto &drawCommands = DrawCommandLists[CurrentDrawCommandList];
+        drawCommands.clear();
 
         auto scene = Scene.lock();
         if (scene == nullptr || !scene->IsActive())
@@ -47,61 +53,74 @@ namespace Spinner
         cameraComponent->UpdateSceneConstants(LocalSceneBuffer);
         SceneBuffer->Write<SceneConstants>(LocalSceneBuffer);
 
-        std::vector<Components::LightComponent *> activeLightComponents;
-
         const auto lighting = scene->GetLighting();
 
 
         // Get active light components
-        scene->GetObjectTree()->TraverseActive([&](const SceneObject::Pointer &sceneObject) -> bool
+        ActiveLightComponents.clear();
+        scene->ForEachComponent<Components::LightComponent>([&](Components::LightComponent &lightComponent, SceneObject &sceneObject)
         {
-            auto lightComponents = sceneObject->GetComponentRawPointers<Components::LightComponent>();
-            for (auto &lightComponent : lightComponents)
+            if (sceneObject.IsActive() && lightComponent.GetActive())
             {
-                if (lightComponent->GetActive())
-                {
-                    activeLightComponents.push_back(lightComponent);
-                }
+                ActiveLightComponents.push_back(&lightComponent);
             }
-
-            return true;
-        }, nullptr);
+        });
 
         if (lighting != nullptr)
         {
             const glm::vec3 viewerPosition = LocalSceneBuffer.CameraPosition;
 
-            lighting->UpdateLights(viewerPosition, activeLightComponents);
+            lighting->UpdateLights(viewerPosition, ActiveLightComponents);
 
             // TODO render using a new DrawCommand, the mesh component's ShadowShaderGroup, and the light component's shadow texture
         }
 
-        // Create draw commands
-        auto currentFrame = Graphics::GetCurrentFrame();
-        scene->GetObjectTree()->TraverseActive([&](const SceneObject::Pointer &sceneObject) -> bool
+        // World matrices are read here on the main thread, the transform store rebuilds stale ones lazily and is not safe to share
+        ActiveMeshes.clear();
+        scene->ForEachComponent<Components::MeshComponent>([&](Components::MeshComponent &meshComponent, SceneObject &sceneObject)
+        {
+            if (!sceneObject.IsActive() || !meshComponent.GetActive())
+                return;
+
+            ActiveMeshes.push_back({&meshComponent, sceneObject.GetWorldMatrix(), meshComponent.GetLod()});
+        });
+
+        // Level of detail selection only reads the mesh and the view, so it is spread across the job system
+        const auto selectLods = [this](size_t begin, size_t end)
         {
-            auto meshComponents = sceneObject->GetComponentRawPointers<Components::MeshComponent>();
-            for (auto &meshComponent : meshComponents)
+            for (size_t i = begin; i < end; i++)
             {
-                if (!meshComponent->GetActive())
-                    continue;
+                auto &activeMesh = ActiveMeshes[i];
+                if (const auto &meshBuffer = activeMesh.MeshComponent->GetMeshBuffer(); meshBuffer != nullptr)
+                {
+                    activeMesh.Lod = SelectLod(*meshBuffer, activeMesh.Model, LocalSceneBuffer, activeMesh.Lod);
+                }
+            }
+        };
+        JobSystem::ParallelForOrInline(ActiveMeshes.size(), LodSelectionGrainSize, selectLods);
 
-                // Update constant buffer with position
-                auto meshConstants = meshComponent->GetMeshConstants();
-                meshConstants.Model = sceneObject->GetWorldMatrix();
-                meshComponent->UpdateConstantBuffer(meshConstants);
+        // Create draw commands, mapped buffer writes and the descriptor pool stay on the main thread
+        for (auto &[meshComponent, model, lod] : ActiveMeshes)
+        {
+            // Update constant buffer with position
+            auto meshConstants = meshComponent->GetMeshConstants();
+            meshConstants.Model = model;
+            meshComponent->UpdateConstantBuffer(meshConstants);
+            meshComponent->SetLod(lod);
 
-                // Create main draw command
-                auto drawCommand = CreateDrawCommand(meshComponent->GetShaderGroup());
-                drawCommand->UseSceneBuffer(SceneBuffer);
-                drawCommand->UseLighting(lighting);
+            // Create main draw command
+            auto drawCommand = CreateDrawCommand(meshComponent->GetShaderGroup());
+            drawCommand->UseSceneBuffer(SceneBuffer);
+            drawCommand->UseLighting(lighting);
 
-                meshComponent->Update(drawCommand);
+            meshComponent->Update(drawCommand);
 
-                DrawCommands.emplace(drawCommand->GetPass(), drawCommand);
-            }
+            drawCommands.push_back({drawCommand->GetPass(), static_cast<uint32_t>(drawCommands.size()), std::move(drawCommand)});
+        }
 
-            return true;
+        std::sort(drawCommands.begin(), drawCommands.end(), [](const QueuedDrawCommand &a, const QueuedDrawCommand &b)
+        {
+            return (a.Pass != b.Pass) ? a.Pass < b.Pass : a.Order < b.Order;
         });
     }
 
@@ -113,10 +132,10 @@ namespace Spinner
             return;
         }
 
-        // Iterates over in a non-descending order (a lower pass index goes before a higher pass index)
-        for (const auto &[set, drawCommand] : DrawCommands)
+        // Sorted in a non-descending order (a lower pass index goes before a higher pass index)
+        for (const auto &queued : DrawCommandLists[CurrentDrawCommandList])
         {
-            drawCommand->DrawMesh(commandBuffer);
+            queued.DrawCommand->DrawMesh(commandBuffer);
         }
     }
 
@@ -134,21 +153,66 @@ namespace Spinner
             return;
         }
 
-        // Track the tracked shadow images
-        for (const auto &si : lighting->ShadowImages)
+        for (auto &lightComponent : lighting->SortedLightComponents)
         {
-            commandBuffer->TrackObject(si);
+            lightComponent->RenderShadow(commandBuffer, DescriptorPool);
         }
+    }
 
-        const auto currentFrame = Graphics::GetCurrentFrame();
+    uint32_t DrawManager::SelectLod(const MeshBuffer &meshBuffer, const glm::mat4 &model, const SceneConstants &sceneConstants, uint32_t currentLod)
+    {
+        const auto lodCount = static_cast<uint32_t>(meshBuffer.Lods.size());
+        const float radius = meshBuffer.BoundingSphere.w;
+        if (lodCount <= 1 || radius <= 0.0f)
+        {
+            return 0;
+        }
 
-        commandBuffer->TrackObject(lighting->ShadowSampler);
-        commandBuffer->TrackObject(lighting->LightBuffers[currentFrame]);
-        commandBuffer->TrackObject(lighting->LightInfoBuffers[currentFrame]);
+        // Pixels covered by one world unit, the projection's Y scale maps a unit to half of the viewport height
+        float pixelsPerUnit = std::abs(sceneConstants.Projection[1][1]) * sceneConstants.CameraExtent.y * 0.5f;
 
-        for (auto &lightComponent : lighting->SortedLightComponents)
+        // Largest axis scale of the model transform, mesh space errors grow with it
+        const float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        pixelsPerUnit *= scale;
+
+        // Perspective projections shrink with distance, measured to the nearest point of the bounding sphere
+        if (sceneConstants.Projection[3][3] == 0.0f)
         {
-            lightComponent->RenderShadow(commandBuffer, DescriptorPool);
+            const glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(meshBuffer.BoundingSphere), 1.0f));
+            const float distance = glm::length(center - sceneConstants.CameraPosition) - radius * scale;
+            if (distance <= 0.0f)
+            {
+                return 0;
+            }
+            pixelsPerUnit /= distance;
+        }
+
+        const auto coarsestWithin = [&meshBuffer, lodCount, pixelsPerUnit](float pixelError) -> uint32_t
+        {
+            // Errors grow monotonically with the level
+            uint32_t lod = 0;
+            while (lod + 1 < lodCount && meshBuffer.Lods[lod + 1].Error * pixelsPerUnit <= pixelError)
+            {
+                lod++;
+            }
+            return lod;
+        };
+
+        if (currentLod >= lodCount)
+        {
+            return coarsestWithin(LodPixelError);
+        }
+
+        // Coarsen once comfortably below the threshold, refine once the current level is clearly above it
+        const uint32_t coarser = coarsestWithin(LodPixelError * (1.0f - LodHysteresis));
+        if (coarser > currentLod)
+        {
+            return coarser;
+        }
+        if (meshBuffer.Lods[currentLod].Error * pixelsPerUnit > LodPixelError * (1.0f + LodHysteresis))
+        {
+            return coarsestWithin(LodPixelError);
         }
+        return currentLod;
     }
 }
@@ -1,6 +1,8 @@
 #ifndef SPINNER_DRAWMANAGER_HPP
 #define SPINNER_DRAWMANAGER_HPP
 
+#include <array>
+#include <limits>
 #include "SceneObject.hpp"
 #include "DrawCommand.hpp"
 #include "Components/CameraComponent.hpp"
@@ -8,6 +10,11 @@
 
 namespace Spinner
 {
+    namespace Components
+    {
+        class LightComponent;
+    }
+
     class DrawManager final
     {
     public:
@@ -16,6 +23,13 @@ namespace Spinner
         DrawManager();
         ~DrawManager();
 
+        /// Largest on screen error, in pixels, of a selected level of detail
+        inline static float LodPixelError = 1.0f;
+        /// Fraction of LodPixelError the projected error must move past before the selected level changes, so levels do not flicker at the threshold
+        inline static float LodHysteresis = 0.25f;
+        /// Meshes per job when selecting levels of detail on the job system
+        static constexpr size_t LodSelectionGrainSize = 256;
+
     protected:
         std::weak_ptr<Spinner::Scene> Scene;
 
@@ -23,7 +37,27 @@ namespace Spinner
         Buffer::Pointer SceneBuffer;
         SceneConstants LocalSceneBuffer{};
 
-        std::multimap<Spinner::Pass, Spinner::DrawCommand::Pointer> DrawCommands;
+        struct QueuedDrawCommand
+        {
+            Spinner::Pass Pass;
+            uint32_t Order; // Position in the frame's list, keeps draws of the same pass in the order they were created
+            Spinner::DrawCommand::Pointer DrawCommand;
+        };
+
+        // Update runs before the frame's fence wait, so the lists of the previous MAX_FRAMES_IN_FLIGHT updates may still be referenced by
+        // frames in flight. Each update clears and refills the oldest, keeping its capacity
+        std::array<std::vector<QueuedDrawCommand>, MAX_FRAMES_IN_FLIGHT + 1> DrawCommandLists;
+        size_t CurrentDrawCommandList = 0;
+        std::vector<Components::LightComponent *> ActiveLightComponents; // Kept between frames so gathering lights does not allocate
+
+        struct ActiveMesh
+        {
+            Components::MeshComponent *MeshComponent;
+            glm::mat4 Model;
+            uint32_t Lod;
+        };
+
+        std::vector<ActiveMesh> ActiveMeshes; // Kept between frames, like ActiveLightComponents
 
     protected:
         Spinner::DrawCommand::Pointer CreateDrawCommand(const Spinner::ShaderGroup::Pointer &shaderGroup);
@@ -33,6 +67,10 @@ namespace Spinner
         void Update(const Components::ComponentPtr<Components::CameraComponent> &cameraComponent);
         void Render(CommandBuffer::Pointer &commandBuffer);
         void RenderShadows(CommandBuffer::Pointer& commandBuffer) const;
+
+        /// Selects the coarsest level of detail whose error projects to at most LodPixelError pixels with the given view.
+        /// Changing from currentLod is subject to LodHysteresis, an out of range currentLod selects without it
+        static uint32_t SelectLod(const MeshBuffer &meshBuffer, const glm::mat4 &model, const SceneConstants &sceneConstants, uint32_t currentLod = std::numeric_limits<uint32_t>::max());
     };
 }
 
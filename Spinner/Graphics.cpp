@@ -1,6 +1,8 @@
 #include "Graphics.hpp"
+#include "Buffer.hpp"
 #include <map>
 #include <set>
+#include <algorithm>
 #include <GLFW/glfw3.h>
 
 namespace Spinner
@@ -32,6 +34,8 @@ namespace Spinner
         CreateVmaAllocator();
         CreateCommandPool();
 
+        MemoryDefragmenter = std::make_unique<Spinner::MemoryDefragmenter>(Allocator);
+
         GraphicsInstance = this;
 
         CreateFrameCommandBuffers();
@@ -55,6 +59,10 @@ namespace Spinner
         // Just in case something is started in a command buffer completion callback
         Device.waitIdle();
 
+        // Everything has finished on the GPU, finish any defragmentation and release all deferred resources
+        MemoryDefragmenter->Finish();
+        ReleaseCompletedResources(FrameEpoch);
+
         // Sync Objects
         for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
         {
@@ -83,6 +91,8 @@ namespace Spinner
             Swapchain.reset();
         }
 
+        MemoryDefragmenter.reset();
+
         if (Allocator)
         {
             Allocator.destroy();
@@ -138,6 +148,16 @@ namespace Spinner
         return GraphicsInstance->Allocator;
     }
 
+    Spinner::MemoryDefragmenter *Graphics::GetMemoryDefragmenter()
+    {
+        if (GraphicsInstance == nullptr)
+        {
+            return nullptr;
+        }
+
+        return GraphicsInstance->MemoryDefragmenter.get();
+    }
+
     void Graphics::PickPhysicalDevice(const std::vector<const char *> &deviceExtensions)
     {
         std::vector<vk::PhysicalDevice> devices = VulkanInstance::GetInstance().enumeratePhysicalDevices();
@@ -434,6 +454,12 @@ namespace Spinner
     {
         vk::detail::resultCheck(Device.waitForFences(1, &InFlightGraphicsFences[CurrentFrame], true, LongTimeTimeout), "Failed while waiting for previous frame fence");
 
+        // The last frame submitted with this fence has finished, so anything released during or before its epoch can be destroyed
+        ReleaseCompletedResources(SubmittedFrameEpochs[CurrentFrame]);
+
+        // Run or finish at most one defragmentation pass before recording, so this frame records with any moved handles
+        MemoryDefragmenter->Update(CompletedFrameEpoch, FrameEpoch);
+
         // Acquire next image
         uint32_t imageIndex = 0;
         auto nextImageResult = Device.acquireNextImageKHR(Swapchain->GetSwapchainKHR(), LongTimeTimeout, ImageAvailableSemaphores[CurrentFrame], nullptr, &imageIndex);
@@ -456,6 +482,9 @@ namespace Spinner
         commandBuffer->Reset();
         RecordGraphicsCommandBuffer(commandBuffer, imageIndex);
 
+        // Make all host writes from this frame visible before submitting
+        FlushMappedBuffers();
+
         // Submit command buffers
         vk::SubmitInfo submitInfo;
         std::vector<vk::Semaphore> waitSemaphores = {ImageAvailableSemaphores[CurrentFrame]};
@@ -471,6 +500,9 @@ namespace Spinner
         // Submit to the graphics queue
         GraphicsQueue.submit(submitInfo, InFlightGraphicsFences[CurrentFrame]);
 
+        SubmittedFrameEpochs[CurrentFrame] = FrameEpoch;
+        FrameEpoch++;
+
         // Present
         vk::PresentInfoKHR presentInfo;
         presentInfo.setWaitSemaphores(signalSemaphores);
@@ -493,6 +525,77 @@ namespace Spinner
         CurrentFrame = (CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
     }
 
+    void Graphics::ReleaseCompletedResources(uint64_t completedEpoch)
+    {
+        CompletedFrameEpoch = std::max(CompletedFrameEpoch, completedEpoch);
+
+        // Releases are pushed in epoch order, so only the front of the queue needs checking
+        while (!DeferredReleases.empty() && DeferredReleases.front().Epoch <= CompletedFrameEpoch)
+        {
+            // Pop before releasing, the object's destructor may defer releases of its own
+            auto object = std::move(DeferredReleases.front().Object);
+            DeferredReleases.pop_front();
+            object.reset();
+        }
+    }
+
+    void Graphics::FlushMappedBuffers()
+    {
+        if (DirtyMappedBuffers.empty())
+        {
+            return;
+        }
+
+        std::vector<vma::Allocation> allocations;
+        std::vector<vk::DeviceSize> offsets;
+        std::vector<vk::DeviceSize> sizes;
+        allocations.reserve(DirtyMappedBuffers.size());
+        offsets.reserve(DirtyMappedBuffers.size());
+        sizes.reserve(DirtyMappedBuffers.size());
+
+        for (auto *buffer : DirtyMappedBuffers)
+        {
+            allocations.push_back(buffer->VmaAllocation);
+            offsets.push_back(buffer->DirtyRangeBegin);
+            sizes.push_back(buffer->DirtyRangeEnd - buffer->DirtyRangeBegin);
+            buffer->Dirty = false;
+        }
+        DirtyMappedBuffers.clear();
+
+        Allocator.flushAllocations(allocations, offsets, sizes);
+    }
+
+    void Graphics::QueueMappedFlush(Buffer *buffer)
+    {
+        if (GraphicsInstance == nullptr)
+        {
+            throw std::runtime_error("Cannot queue a mapped buffer flush on a non-existent Graphics instance");
+        }
+
+        auto &dirtyBuffers = GraphicsInstance->DirtyMappedBuffers;
+        buffer->DirtyListIndex = dirtyBuffers.size();
+        dirtyBuffers.push_back(buffer);
+    }
+
+    void Graphics::CancelMappedFlush(Buffer *buffer)
+    {
+        if (GraphicsInstance == nullptr)
+        {
+            return;
+        }
+
+        // The last dirty buffer takes the cancelled one's place
+        auto &dirtyBuffers = GraphicsInstance->DirtyMappedBuffers;
+        const auto index = buffer->DirtyListIndex;
+        if (index >= dirtyBuffers.size() || dirtyBuffers[index] != buffer)
+        {
+            return;
+        }
+        dirtyBuffers[index] = dirtyBuffers.back();
+        dirtyBuffers[index]->DirtyListIndex = index;
+        dirtyBuffers.pop_back();
+    }
+
     CommandBuffer::Pointer Graphics::BeginSingleTimeCommands()
     {
         if (GraphicsInstance == nullptr)
@@ -511,6 +614,12 @@ namespace Spinner
     }
 
     void Graphics::EndSingleTimeCommands(const CommandBuffer::Pointer &commandBuffer)
+    {
+        const vk::Fence fence = SubmitSingleTimeCommands(commandBuffer);
+        FinishSingleTimeCommands(commandBuffer, fence, true);
+    }
+
+    vk::Fence Graphics::SubmitSingleTimeCommands(const CommandBuffer::Pointer &commandBuffer)
     {
         if (GraphicsInstance == nullptr)
         {
@@ -519,6 +628,9 @@ namespace Spinner
 
         commandBuffer->End();
 
+        // Staging buffers written for this command buffer need to be flushed before it is submitted
+        GraphicsInstance->FlushMappedBuffers();
+
         vk::SubmitInfo submitInfo;
         submitInfo.setCommandBuffers(commandBuffer->VkCommandBuffer);
 
@@ -531,7 +643,22 @@ namespace Spinner
 
         GraphicsInstance->GraphicsQueue.submit(submitInfo, fence);
 
-        auto result = device.waitForFences(fence, true, LongTimeTimeout);
+        return fence;
+    }
+
+    bool Graphics::FinishSingleTimeCommands(const CommandBuffer::Pointer &commandBuffer, vk::Fence fence, bool wait)
+    {
+        if (GraphicsInstance == nullptr)
+        {
+            throw std::runtime_error("Cannot finish a command buffer from a non-existent Graphics instance");
+        }
+
+        auto &device = GetDevice();
+        auto result = wait ? device.waitForFences(fence, true, LongTimeTimeout) : device.getFenceStatus(fence);
+        if (!wait && result == vk::Result::eNotReady)
+        {
+            return false;
+        }
 
         device.destroyFence(fence);
         device.freeCommandBuffers(GraphicsInstance->GraphicsCommandPool, commandBuffer->VkCommandBuffer);
@@ -539,6 +666,7 @@ namespace Spinner
         commandBuffer->Completed();
 
         vk::detail::resultCheck(result, "Single time command failed");
+        return true;
     }
 
     std::vector<CommandBuffer::Pointer> Graphics::CreateCommandBuffers(uint32_t count, bool secondary)
@@ -574,6 +702,32 @@ namespace Spinner
         return GraphicsInstance->CurrentFrame;
     }
 
+    uint64_t Graphics::GetFrameEpoch()
+    {
+        return GraphicsInstance->FrameEpoch;
+    }
+
+    uint64_t Graphics::GetCompletedFrameEpoch()
+    {
+        return GraphicsInstance->CompletedFrameEpoch;
+    }
+
+    void Graphics::DeferRelease(std::shared_ptr<void> object)
+    {
+        if (object == nullptr)
+        {
+            return;
+        }
+
+        // Without a Graphics instance there is nothing in flight, so the object is released here
+        if (GraphicsInstance == nullptr)
+        {
+            return;
+        }
+
+        GraphicsInstance->DeferredReleases.push_back({GraphicsInstance->FrameEpoch, std::move(object)});
+    }
+
     std::shared_ptr<Spinner::Window> Graphics::GetMainWindow()
     {
         return MainWindow;
@@ -2,6 +2,7 @@
 #define SPINNER_GRAPHICS_HPP
 
 #include <memory>
+#include <deque>
 #include <vulkan/vulkan.hpp>
 #include "vk_mem_alloc.hpp"
 #include "VulkanInstance.hpp"
@@ -12,9 +13,11 @@
 #include "Callback.hpp"
 #include "Object.hpp"
 #include "CommandBuffer.hpp"
+#include "MemoryDefragmenter.hpp"
 
 namespace Spinner
 {
+    class Buffer;
 
     class Graphics : public Object
     {
@@ -50,6 +53,23 @@ namespace Spinner
         vk::CommandPool GraphicsCommandPool;
         std::vector<CommandBuffer::Pointer> FrameGraphicsCommandBuffers;
 
+        // Frame epochs: FrameEpoch is the epoch currently being recorded, CompletedFrameEpoch is the last one the GPU has finished
+        struct DeferredRelease
+        {
+            uint64_t Epoch;
+            std::shared_ptr<void> Object;
+        };
+
+        uint64_t FrameEpoch = 1;
+        uint64_t CompletedFrameEpoch = 0;
+        std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> SubmittedFrameEpochs{};
+        std::deque<DeferredRelease> DeferredReleases;
+
+        // Mapped non host-coherent buffers with writes waiting to be flushed
+        std::vector<Buffer *> DirtyMappedBuffers;
+
+        std::unique_ptr<Spinner::MemoryDefragmenter> MemoryDefragmenter;
+
     public:
         Callback<int, int> ResizedCallback;
         CallbackSingle<CommandBuffer::Pointer &, uint32_t, uint32_t> RecordGraphicsCommandCallback;
@@ -65,6 +85,8 @@ namespace Spinner
         void CreateFrameCommandBuffers();
         void CreateSyncObjects();
         void RecordGraphicsCommandBuffer(CommandBuffer::Pointer &commandBuffer, uint32_t imageIndex);
+        void ReleaseCompletedResources(uint64_t completedEpoch);
+        void FlushMappedBuffers();
 
     public:
         static QueueFamilyIndices FindQueueFamilies(const vk::PhysicalDevice &physicalDevice, const vk::SurfaceKHR &surface);
@@ -74,6 +96,13 @@ namespace Spinner
         [[nodiscard]] uint32_t GetGraphicsQueueFamily() const;
         Spinner::Swapchain *GetSwapchainRawPointer();
         static uint32_t GetCurrentFrame();
+        [[nodiscard]] static uint64_t GetFrameEpoch();
+        [[nodiscard]] static uint64_t GetCompletedFrameEpoch();
+        // Keeps object alive until the GPU has finished every frame recorded up to and including the current epoch
+        static void DeferRelease(std::shared_ptr<void> object);
+        // Dirty mapped buffers are flushed in a single flushAllocations call before the next queue submission
+        static void QueueMappedFlush(Buffer *buffer);
+        static void CancelMappedFlush(Buffer *buffer);
         vk::Format FindSupportedFormat(const std::vector<vk::Format> &candidates, vk::ImageTiling tiling, vk::FormatFeatureFlags features);
         vk::Format FindDepthFormat(bool highQuality = false);
 
@@ -81,11 +110,17 @@ namespace Spinner
         [[nodiscard]] static const vk::PhysicalDevice &GetPhysicalDevice();
         [[nodiscard]] static const vk::Device &GetDevice();
         [[nodiscard]] static const vma::Allocator &GetAllocator();
+        /// Returns nullptr when there is no Graphics instance
+        [[nodiscard]] static Spinner::MemoryDefragmenter *GetMemoryDefragmenter();
 
         [[nodiscard]] static vk::Extent2D GetSwapchainExtent();
         [[nodiscard]] static std::vector<CommandBuffer::Pointer> CreateCommandBuffers(uint32_t count, bool secondary);
         [[nodiscard]] static CommandBuffer::Pointer BeginSingleTimeCommands();
         static void EndSingleTimeCommands(const CommandBuffer::Pointer &commandBuffer);
+        /// Ends and submits without waiting, pass the returned fence to FinishSingleTimeCommands
+        [[nodiscard]] static vk::Fence SubmitSingleTimeCommands(const CommandBuffer::Pointer &commandBuffer);
+        /// Frees a submitted command buffer and its fence once the GPU has finished it. Without wait returns false while it is still executing
+        static bool FinishSingleTimeCommands(const CommandBuffer::Pointer &commandBuffer, vk::Fence fence, bool wait);
         [[nodiscard]] static uint32_t GetGraphicsQueueFamilyIndex();
         [[nodiscard]] static Input::Pointer GetInput();
     };
@@ -3,6 +3,9 @@
 #define STBI_MAX_DIMENSIONS (1 << 27)
 
 #include <utility>
+#include <algorithm>
+#include <cstring>
+#include <array>
 #include <stb_image.h>
 
 #include "GLM.hpp"
@@ -11,6 +14,8 @@
 #include "Buffer.hpp"
 #include "CommandBuffer.hpp"
 #include "Utilities.hpp"
+#include "Ktx2File.hpp"
+#include "TextureCache.hpp"
 
 namespace Spinner
 {
@@ -18,13 +23,13 @@ namespace Spinner
     {
     }
 
-    Image::Image(vk::Extent3D extent, vk::Format format, vk::ImageUsageFlags usageFlags, vk::ImageType imageType, vk::ImageTiling tiling, uint32_t mipLevels, vma::MemoryUsage memoryUsage, uint32_t arrayLayers, vk::ImageCreateFlags imageCreateFlags) : ImageExtent(extent), Format(format), ImageUsageFlags(usageFlags), ImageType(imageType), ImageTiling(tiling), ArrayLayers(arrayLayers), ImageCreateFlags(imageCreateFlags)
+    Image::Image(vk::Extent3D extent, vk::Format format, vk::ImageUsageFlags usageFlags, vk::ImageType imageType, vk::ImageTiling tiling, uint32_t mipLevels, vma::MemoryUsage memoryUsage, uint32_t arrayLayers, vk::ImageCreateFlags imageCreateFlags) : ImageExtent(extent), Format(format), ImageUsageFlags(usageFlags), ImageType(imageType), ImageTiling(tiling), ArrayLayers(arrayLayers), MipLevels(mipLevels == FullMipChain ? GetMipLevelCount(extent) : mipLevels), MemoryUsage(memoryUsage), ImageCreateFlags(imageCreateFlags)
     {
         vk::ImageCreateInfo createInfo;
         createInfo.imageType = ImageType;
         createInfo.extent = extent;
         createInfo.tiling = tiling;
-        createInfo.mipLevels = mipLevels;
+        createInfo.mipLevels = MipLevels;
         createInfo.arrayLayers = arrayLayers;
         createInfo.format = Format;
         createInfo.initialLayout = CurrentImageLayout;
@@ -39,6 +44,14 @@ namespace Spinner
         auto pair = Graphics::GetAllocator().createImage(createInfo, allocInfo);
         VkImage = pair.first;
         VmaAllocation = pair.second;
+
+        if (IsMovable())
+        {
+            if (auto defragmenter = Graphics::GetMemoryDefragmenter())
+            {
+                defragmenter->RegisterImage(this);
+            }
+        }
     }
 
     Image::~Image()
@@ -56,7 +69,29 @@ namespace Spinner
 
         if (VkImage)
         {
-            Graphics::GetAllocator().destroyImage(VkImage, VmaAllocation);
+            auto defragmenter = Graphics::GetMemoryDefragmenter();
+            if (defragmenter != nullptr && IsMovable())
+            {
+                defragmenter->UnregisterImage(this);
+            }
+
+            // If this image is mid-move the defragmenter takes ownership of the allocation, only the image handles are destroyed
+            if (defragmenter != nullptr && defragmenter->ReleaseMovingAllocation(static_cast<::VmaAllocation>(VmaAllocation)))
+            {
+                device.destroyImage(VkImage);
+                if (MovedFromImageView)
+                {
+                    device.destroyImageView(MovedFromImageView);
+                }
+                if (MovedFromImage)
+                {
+                    device.destroyImage(MovedFromImage);
+                }
+            }
+            else
+            {
+                Graphics::GetAllocator().destroyImage(VkImage, VmaAllocation);
+            }
         }
     }
 
@@ -82,8 +117,22 @@ namespace Spinner
 
     vk::DeviceSize Image::GetImageSize() const
     {
-        auto byteWidth = VkFormatByteWidth(Format);
-        return ImageExtent.width * ImageExtent.height * ImageExtent.depth * byteWidth;
+        return VkFormatImageSize(Format, ImageExtent);
+    }
+
+    vk::DeviceSize Image::GetMipLevelSize(uint32_t mipLevel) const
+    {
+        return VkFormatImageSize(Format, GetMipExtent(ImageExtent, mipLevel));
+    }
+
+    vk::DeviceSize Image::GetMipChainSize() const
+    {
+        vk::DeviceSize size = 0;
+        for (uint32_t mip = 0; mip < MipLevels; mip++)
+        {
+            size += GetMipLevelSize(mip);
+        }
+        return size;
     }
 
     vk::ImageLayout Image::GetCurrentImageLayout() const noexcept
@@ -99,10 +148,11 @@ namespace Spinner
     void Image::Write(const uint8_t *textureData, size_t textureDataSize, vk::ImageAspectFlags aspectFlags, Spinner::CommandBuffer::Pointer commandBuffer)
     {
         vk::DeviceSize imageSize = GetImageSize();
+        const bool isMipChain = MipLevels > 1 && textureDataSize == GetMipChainSize();
 
-        if (textureDataSize != imageSize)
+        if (textureDataSize != imageSize && !isMipChain)
         {
-            throw std::runtime_error("Cannot write to image with different image size (ImageExtent * formatByteWidth) to textureData");
+            throw std::runtime_error("Cannot write to image with different image size (first mip level or whole mip chain) to textureData");
         }
 
         bool singleTime = false;
@@ -114,22 +164,36 @@ namespace Spinner
 
         if (CurrentImageLayout == vk::ImageLayout::eUndefined)
         {
-            commandBuffer->TransitionImageLayout(shared_from_this(), vk::ImageLayout::eShaderReadOnlyOptimal);
+            commandBuffer->TransitionImageLayout(shared_from_this(), vk::ImageLayout::eShaderReadOnlyOptimal, aspectFlags, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eAllCommands, vk::ImageSubresourceRange(aspectFlags, 0, MipLevels, 0, ArrayLayers));
+        }
+
+        if (isMipChain)
+        {
+            WriteMipChain(textureData, textureDataSize, aspectFlags, commandBuffer);
+        }
+        else if (MipLevels > 1 && !CanBlitMipmaps(Format))
+        {
+            const auto mipChain = GenerateMipChain(Format, textureData, textureDataSize, ImageExtent, MipLevels);
+            WriteMipChain(mipChain.data(), mipChain.size(), aspectFlags, commandBuffer);
         }
+        else
+        {
+            auto stagingBuffer = Buffer::CreateBuffer(imageSize, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu, 0, true);
 
-        auto stagingBuffer = Buffer::CreateBuffer(imageSize, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu, 0, true);
+            stagingBuffer->Write(textureData, textureDataSize, 0u, nullptr); // pass nullptr as command buffer as the staging buffer doesn't need it
 
-        stagingBuffer->Write(textureData, textureDataSize, 0u, nullptr); // pass nullptr as command buffer as the staging buffer doesn't need it
+            stagingBuffer->CopyToImage(shared_from_this(), aspectFlags, commandBuffer); // also tracks objects
 
-        stagingBuffer->CopyToImage(shared_from_this(), aspectFlags, commandBuffer); // also tracks objects
+            GenerateMipmaps(commandBuffer);
+        }
 
         if (singleTime)
         {
             Graphics::EndSingleTimeCommands(commandBuffer);
         }
 
-        // Test and set IsTransparent
-        SetIsTransparent(IsTransparentTexture(Format, textureData, textureDataSize));
+        // Test and set IsTransparent, from the first mip level
+        SetIsTransparent(IsTransparentTexture(Format, textureData, imageSize));
     }
 
     void Image::Write(const std::vector<uint8_t> &textureData, vk::ImageAspectFlags aspectFlags, Spinner::CommandBuffer::Pointer commandBuffer)
@@ -137,11 +201,183 @@ namespace Spinner
         Write(textureData.data(), textureData.size(), aspectFlags, std::move(commandBuffer));
     }
 
+    bool Image::GenerateMipmaps(const Spinner::CommandBuffer::Pointer &commandBuffer)
+    {
+        if (MipLevels <= 1)
+        {
+            return true;
+        }
+        if (!CanBlitMipmaps(Format))
+        {
+            return false;
+        }
+
+        // Integer formats can only be blitted with nearest filtering
+        const auto formatFeatures = Graphics::GetPhysicalDevice().getFormatProperties(Format).optimalTilingFeatures;
+        const vk::Filter filter = (formatFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) ? vk::Filter::eLinear : vk::Filter::eNearest;
+        const vk::ImageLayout layout = CurrentImageLayout;
+
+        commandBuffer->TrackObject(shared_from_this());
+
+        for (uint32_t mip = 1; mip < MipLevels; mip++)
+        {
+            const vk::ImageSubresourceRange sourceRange(vk::ImageAspectFlagBits::eColor, mip - 1, 1, 0, ArrayLayers);
+            const vk::ImageSubresourceRange destinationRange(vk::ImageAspectFlagBits::eColor, mip, 1, 0, ArrayLayers);
+
+            // Each level is read once the previous blit has written it, the destination's old contents are discarded
+            commandBuffer->TransitionImageLayout(VkImage, (mip == 1) ? layout : vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eTransferSrcOptimal, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eTransfer, sourceRange);
+            commandBuffer->TransitionImageLayout(VkImage, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eTransfer, destinationRange);
+
+            const auto sourceExtent = GetMipExtent(ImageExtent, mip - 1);
+            const auto destinationExtent = GetMipExtent(ImageExtent, mip);
+
+            vk::ImageBlit blit;
+            blit.srcSubresource = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mip - 1, 0, ArrayLayers);
+            blit.srcOffsets[1] = vk::Offset3D(static_cast<int32_t>(sourceExtent.width), static_cast<int32_t>(sourceExtent.height), static_cast<int32_t>(sourceExtent.depth));
+            blit.dstSubresource = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mip, 0, ArrayLayers);
+            blit.dstOffsets[1] = vk::Offset3D(static_cast<int32_t>(destinationExtent.width), static_cast<int32_t>(destinationExtent.height), static_cast<int32_t>(destinationExtent.depth));
+            commandBuffer->VkCommandBuffer.blitImage(VkImage, vk::ImageLayout::eTransferSrcOptimal, VkImage, vk::ImageLayout::eTransferDstOptimal, blit, filter);
+
+            commandBuffer->TransitionImageLayout(VkImage, vk::ImageLayout::eTransferSrcOptimal, layout, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eAllCommands, sourceRange);
+        }
+
+        const vk::ImageSubresourceRange lastRange(vk::ImageAspectFlagBits::eColor, MipLevels - 1, 1, 0, ArrayLayers);
+        commandBuffer->TransitionImageLayout(VkImage, vk::ImageLayout::eTransferDstOptimal, layout, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eAllCommands, lastRange);
+
+        return true;
+    }
+
+    // Size of each component of the 8 and 16 bit unsigned formats whose mips can be generated on the CPU, 0 for any other format
+    static size_t GetDownsampleComponentSize(vk::Format format)
+    {
+        switch (format)
+        {
+            case vk::Format::eR8Unorm:
+            case vk::Format::eR8Uint:
+            case vk::Format::eR8Srgb:
+            case vk::Format::eR8G8Unorm:
+            case vk::Format::eR8G8Uint:
+            case vk::Format::eR8G8Srgb:
+            case vk::Format::eR8G8B8Unorm:
+            case vk::Format::eR8G8B8Uint:
+            case vk::Format::eR8G8B8Srgb:
+            case vk::Format::eR8G8B8A8Unorm:
+            case vk::Format::eR8G8B8A8Uint:
+            case vk::Format::eR8G8B8A8Srgb:
+            case vk::Format::eB8G8R8A8Unorm:
+            case vk::Format::eB8G8R8A8Srgb:
+                return 1;
+            case vk::Format::eR16Unorm:
+            case vk::Format::eR16Uint:
+            case vk::Format::eR16G16Unorm:
+            case vk::Format::eR16G16Uint:
+            case vk::Format::eR16G16B16Unorm:
+            case vk::Format::eR16G16B16Uint:
+            case vk::Format::eR16G16B16A16Unorm:
+            case vk::Format::eR16G16B16A16Uint:
+                return 2;
+            default:
+                return 0;
+        }
+    }
+
+    // Averages each 2x2 block of texels, sRGB data is averaged as it is stored rather than linearized
+    template<typename T>
+    static std::vector<uint8_t> DownsampleMip(const uint8_t *source, vk::Extent3D sourceExtent, vk::Extent3D extent, size_t componentCount)
+    {
+        std::vector<uint8_t> downsampled(static_cast<size_t>(extent.width) * extent.height * componentCount * sizeof(T));
+
+        const auto load = [source, sourceExtent, componentCount](uint32_t x, uint32_t y, size_t component)
+        {
+            T value;
+            std::memcpy(&value, source + ((static_cast<size_t>(y) * sourceExtent.width + x) * componentCount + component) * sizeof(T), sizeof(T));
+            return static_cast<uint32_t>(value);
+        };
+
+        for (uint32_t y = 0; y < extent.height; y++)
+        {
+            const uint32_t y0 = std::min(y * 2, sourceExtent.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, sourceExtent.height - 1);
+            for (uint32_t x = 0; x < extent.width; x++)
+            {
+                const uint32_t x0 = std::min(x * 2, sourceExtent.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, sourceExtent.width - 1);
+                for (size_t component = 0; component < componentCount; component++)
+                {
+                    const auto value = static_cast<T>((load(x0, y0, component) + load(x1, y0, component) + load(x0, y1, component) + load(x1, y1, component) + 2) / 4);
+                    std::memcpy(downsampled.data() + ((static_cast<size_t>(y) * extent.width + x) * componentCount + component) * sizeof(T), &value, sizeof(T));
+                }
+            }
+        }
+
+        return downsampled;
+    }
+
+    std::vector<uint8_t> Image::GenerateMipChain(vk::Format format, const uint8_t *data, size_t dataSize, vk::Extent3D extent, uint32_t mipLevels)
+    {
+        const size_t componentSize = GetDownsampleComponentSize(format);
+        if (componentSize == 0 || extent.depth != 1)
+        {
+            throw std::runtime_error("Cannot generate mipmaps for an image with format " + vk::to_string(format));
+        }
+        if (dataSize != VkFormatImageSize(format, extent))
+        {
+            throw std::runtime_error("Cannot generate mipmaps from data which is not the size of the first mip level");
+        }
+        const size_t componentCount = VkFormatByteWidth(format) / componentSize;
+
+        std::vector<uint8_t> mipChain(data, data + dataSize);
+        size_t sourceOffset = 0;
+        for (uint32_t mip = 1; mip < mipLevels; mip++)
+        {
+            const size_t offset = mipChain.size();
+            const auto sourceExtent = GetMipExtent(extent, mip - 1);
+            const auto mipExtent = GetMipExtent(extent, mip);
+            const auto downsampled = (componentSize == 1) ? DownsampleMip<uint8_t>(mipChain.data() + sourceOffset, sourceExtent, mipExtent, componentCount) : DownsampleMip<uint16_t>(mipChain.data() + sourceOffset, sourceExtent, mipExtent, componentCount);
+            mipChain.insert(mipChain.end(), downsampled.begin(), downsampled.end());
+            sourceOffset = offset;
+        }
+
+        return mipChain;
+    }
+
+    void Image::WriteMipChain(const uint8_t *textureData, size_t textureDataSize, vk::ImageAspectFlags aspectFlags, const Spinner::CommandBuffer::Pointer &commandBuffer)
+    {
+        if (ImageType != vk::ImageType::e2D || ArrayLayers != 1)
+        {
+            throw std::runtime_error("Cannot write a mip chain to an image which is not a single 2D layer");
+        }
+
+        // Levels are tightly packed, whole blocks of a compressed format keep every offset aligned to the block size
+        std::vector<vk::BufferImageCopy> regions;
+        vk::DeviceSize offset = 0;
+        for (uint32_t mip = 0; mip < MipLevels; mip++)
+        {
+            vk::BufferImageCopy region;
+            region.bufferOffset = offset;
+            region.imageSubresource = vk::ImageSubresourceLayers(aspectFlags, mip, 0, 1);
+            region.imageExtent = GetMipExtent(ImageExtent, mip);
+            regions.push_back(region);
+            offset += GetMipLevelSize(mip);
+        }
+
+        auto stagingBuffer = Buffer::CreateBuffer(textureDataSize, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu, 0, true);
+        stagingBuffer->Write(textureData, textureDataSize, 0u, nullptr);
+
+        commandBuffer->TrackObject(stagingBuffer);
+        commandBuffer->TrackObject(shared_from_this());
+
+        const vk::ImageSubresourceRange fullRange(aspectFlags, 0, MipLevels, 0, ArrayLayers);
+        commandBuffer->TransitionImageLayout(VkImage, CurrentImageLayout, vk::ImageLayout::eTransferDstOptimal, aspectFlags, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eAllCommands, fullRange);
+        commandBuffer->CopyBufferToImage(stagingBuffer->VkBuffer, VkImage, vk::ImageLayout::eTransferDstOptimal, regions);
+        commandBuffer->TransitionImageLayout(VkImage, vk::ImageLayout::eTransferDstOptimal, CurrentImageLayout, aspectFlags, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eAllCommands, fullRange);
+    }
+
     vk::ImageView Image::CreateImageView(vk::ImageAspectFlags imageAspectFlags, vk::ImageViewType imageViewType, std::optional<vk::ImageSubresourceRange> subresourceRange)
     {
         if (!subresourceRange.has_value())
         {
-            subresourceRange = vk::ImageSubresourceRange(imageAspectFlags, 0, 1, 0, 1);
+            subresourceRange = vk::ImageSubresourceRange(imageAspectFlags, 0, MipLevels, 0, 1);
         }
 
         vk::ImageViewCreateInfo createInfo;
@@ -170,6 +406,13 @@ namespace Spinner
 
     vk::ImageView Image::CreateMainImageView(vk::ImageAspectFlags imageAspectFlags, vk::ImageViewType imageViewType, std::optional<vk::ImageSubresourceRange> subresourceRange)
     {
+        if (!subresourceRange.has_value())
+        {
+            subresourceRange = vk::ImageSubresourceRange(imageAspectFlags, 0, MipLevels, 0, 1);
+        }
+
+        MainImageViewType = imageViewType;
+        MainImageViewSubresourceRange = subresourceRange.value();
         MainImageView = CreateImageView(imageAspectFlags, imageViewType, subresourceRange);
         return MainImageView;
     }
@@ -209,6 +452,116 @@ namespace Spinner
         return ImageTiling;
     }
 
+    uint32_t Image::GetMipLevels() const noexcept
+    {
+        return MipLevels;
+    }
+
+    uint32_t Image::GetMipLevelCount(vk::Extent3D extent)
+    {
+        uint32_t largest = std::max(extent.width, std::max(extent.height, extent.depth));
+        uint32_t mipLevels = 1;
+        while (largest > 1)
+        {
+            largest >>= 1;
+            mipLevels++;
+        }
+        return mipLevels;
+    }
+
+    vk::Extent3D Image::GetMipExtent(vk::Extent3D extent, uint32_t mipLevel)
+    {
+        return {std::max(1u, extent.width >> mipLevel), std::max(1u, extent.height >> mipLevel), std::max(1u, extent.depth >> mipLevel)};
+    }
+
+    bool Image::CanBlitMipmaps(vk::Format format)
+    {
+        constexpr vk::FormatFeatureFlags blitFeatures = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst;
+        return (Graphics::GetPhysicalDevice().getFormatProperties(format).optimalTilingFeatures & blitFeatures) == blitFeatures;
+    }
+
+    bool Image::IsMovable() const
+    {
+        // Attachments are excluded as their views are held outside of the image, sampled images only need their main view recreated
+        constexpr vk::ImageUsageFlags attachmentUsage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eInputAttachment;
+        return MemoryUsage == vma::MemoryUsage::eGpuOnly && ImageTiling == vk::ImageTiling::eOptimal && static_cast<bool>(ImageUsageFlags & vk::ImageUsageFlagBits::eTransferSrc) && !static_cast<bool>(ImageUsageFlags & attachmentUsage);
+    }
+
+    bool Image::BeginMove(::VmaAllocation destination, const CommandBuffer::Pointer &commandBuffer)
+    {
+        // Any views other than the main image view may be held elsewhere and cannot be recreated
+        if (!IsMovable() || MovedFromImage || VkImageViews.size() > (MainImageView ? 1 : 0))
+        {
+            return false;
+        }
+
+        vk::ImageCreateInfo createInfo;
+        createInfo.imageType = ImageType;
+        createInfo.extent = ImageExtent;
+        createInfo.tiling = ImageTiling;
+        createInfo.mipLevels = MipLevels;
+        createInfo.arrayLayers = ArrayLayers;
+        createInfo.format = Format;
+        createInfo.initialLayout = vk::ImageLayout::eUndefined;
+        createInfo.usage = ImageUsageFlags | vk::ImageUsageFlagBits::eTransferDst;
+        createInfo.samples = vk::SampleCountFlagBits::e1;
+        createInfo.sharingMode = vk::SharingMode::eExclusive;
+        createInfo.flags = ImageCreateFlags;
+
+        auto &device = Graphics::GetDevice();
+        vk::Image newImage = device.createImage(createInfo);
+        Graphics::GetAllocator().bindImageMemory(vma::Allocation(destination), newImage);
+
+        const vk::ImageSubresourceRange fullRange(vk::ImageAspectFlagBits::eColor, 0, MipLevels, 0, ArrayLayers);
+
+        if (CurrentImageLayout != vk::ImageLayout::eUndefined)
+        {
+            std::vector<vk::ImageCopy> regions;
+            for (uint32_t mip = 0; mip < MipLevels; mip++)
+            {
+                vk::ImageCopy region;
+                region.srcSubresource = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mip, 0, ArrayLayers);
+                region.dstSubresource = region.srcSubresource;
+                region.extent = GetMipExtent(ImageExtent, mip);
+                regions.push_back(region);
+            }
+
+            commandBuffer->TransitionImageLayout(VkImage, CurrentImageLayout, vk::ImageLayout::eTransferSrcOptimal, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eAllCommands, fullRange);
+            commandBuffer->TransitionImageLayout(newImage, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eAllCommands, fullRange);
+            commandBuffer->VkCommandBuffer.copyImage(VkImage, vk::ImageLayout::eTransferSrcOptimal, newImage, vk::ImageLayout::eTransferDstOptimal, regions);
+            // The old image goes back to its layout as frames in flight may still sample it
+            commandBuffer->TransitionImageLayout(VkImage, vk::ImageLayout::eTransferSrcOptimal, CurrentImageLayout, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eAllCommands, fullRange);
+            commandBuffer->TransitionImageLayout(newImage, vk::ImageLayout::eTransferDstOptimal, CurrentImageLayout, vk::ImageAspectFlagBits::eColor, vk::PipelineStageFlagBits2::eAllCommands, vk::PipelineStageFlagBits2::eAllCommands, fullRange);
+        }
+
+        MovedFromImage = VkImage;
+        VkImage = newImage;
+
+        if (MainImageView)
+        {
+            MovedFromImageView = MainImageView;
+            std::erase(VkImageViews, MainImageView);
+            MainImageView = CreateImageView(MainImageViewSubresourceRange.aspectMask, MainImageViewType, MainImageViewSubresourceRange);
+        }
+
+        return true;
+    }
+
+    void Image::FinishMove()
+    {
+        auto &device = Graphics::GetDevice();
+        if (MovedFromImageView)
+        {
+            device.destroyImageView(MovedFromImageView);
+            MovedFromImageView = nullptr;
+        }
+        if (MovedFromImage)
+        {
+            device.destroyImage(MovedFromImage);
+            MovedFromImage = nullptr;
+        }
+    }
+
     // Always loads as RGBA8 or RGBA16
     std::vector<uint8_t> Image::DecodeEmbeddedImageData(const std::vector<uint8_t> &data, int &width, int &height, int &channels, bool &is16Bit)
     {
@@ -221,9 +574,14 @@ namespace Spinner
         if (is16Bit)
         {
             auto image = stbi_load_16_from_memory(data.data(), dataSize, &width, &height, &channels, STBI_rgb_alpha);
+            if (image == nullptr)
+            {
+                return {};
+            }
             size_t imageSize = width * height * STBI_rgb_alpha * sizeof(stbi_us);
 
-            std::vector<uint8_t> decodedData = {reinterpret_cast<uint8_t *>(&image[0]), reinterpret_cast<uint8_t *>(&image[imageSize - 1])};
+            auto imageBytes = reinterpret_cast<const uint8_t *>(image);
+            std::vector<uint8_t> decodedData(imageBytes, imageBytes + imageSize);
 
             stbi_image_free(image);
 
@@ -233,9 +591,13 @@ namespace Spinner
         }
 
         auto image = stbi_load_from_memory(data.data(), dataSize, &width, &height, &channels, STBI_rgb_alpha);
+        if (image == nullptr)
+        {
+            return {};
+        }
         size_t imageSize = width * height * STBI_rgb_alpha * sizeof(stbi_uc);
 
-        std::vector<uint8_t> decodedData = {image[0], image[imageSize - 1]};
+        std::vector<uint8_t> decodedData(image, image + imageSize);
 
         stbi_image_free(image);
 
@@ -263,7 +625,7 @@ namespace Spinner
             {
                 size_t imageSize = width * height * STBI_rgb_alpha * sizeof(stbi_us);
 
-                image = CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR16G16B16A16Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
+                image = CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR16G16B16A16Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
                 image->Write(reinterpret_cast<uint8_t *>(loadedImage), imageSize, vk::ImageAspectFlagBits::eColor, nullptr);
 
                 stbi_image_free(loadedImage);
@@ -276,7 +638,7 @@ namespace Spinner
             {
                 size_t imageSize = width * height * STBI_rgb_alpha * sizeof(stbi_uc);
 
-                image = CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
+                image = CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
                 image->Write(reinterpret_cast<uint8_t *>(loadedImage), imageSize, vk::ImageAspectFlagBits::eColor, nullptr);
 
                 stbi_image_free(loadedImage);
@@ -295,6 +657,20 @@ namespace Spinner
             throw std::runtime_error("Cannot create texture as it does not exist at " + texturePath);
         }
 
+        // Files used by several materials or models are only read and uploaded once while any of them is alive
+        return TextureCache::GetOrCreate({TextureCache::GetFileSource(texturePath), vk::Format::eUndefined, mipLevels}, [&texturePath, mipLevels]()
+        {
+            return LoadTextureFile(texturePath, mipLevels);
+        });
+    }
+
+    Image::Pointer Image::LoadTextureFile(const std::string &texturePath, uint32_t mipLevels)
+    {
+        if (texturePath.ends_with(Ktx2File::Extension))
+        {
+            return LoadFromKtx2File(*Ktx2File::Open(texturePath), mipLevels);
+        }
+
         Image::Pointer image;
 
         int width = 0, height = 0, channels = 0;
@@ -309,7 +685,7 @@ namespace Spinner
                 throw std::runtime_error("Could not load texture from path " + texturePath);
             }
 
-            image = Image::CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR16G16B16A16Uint, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
+            image = Image::CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR16G16B16A16Uint, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
 
             auto pixels = reinterpret_cast<uint8_t *>(loadedImage);
 
@@ -326,7 +702,7 @@ namespace Spinner
                 throw std::runtime_error("Could not load texture from path " + texturePath);
             }
 
-            image = Image::CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
+            image = Image::CreateImage({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
 
             image->Write(loadedImage, image->GetImageSize(), vk::ImageAspectFlagBits::eColor, nullptr);
 
@@ -336,6 +712,70 @@ namespace Spinner
         return image;
     }
 
+    Image::Pointer Image::LoadFromKtx2File(const Ktx2File &file, uint32_t mipLevels)
+    {
+        // A stored mip chain is used as is, block compressed formats cannot generate one
+        if (file.GetMipLevels() > 1 || VkFormatIsBlockCompressed(file.GetFormat()))
+        {
+            mipLevels = file.GetMipLevels();
+        }
+
+        auto image = Image::CreateImage(file.GetExtent(), file.GetFormat(), vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
+        image->Write(file.GetData(), vk::ImageAspectFlagBits::eColor, nullptr);
+
+        return image;
+    }
+
+    // Reads count (at most 32) bits from a little endian block, starting at bit offset
+    static uint32_t GetBlockBits(const uint8_t *block, uint32_t offset, uint32_t count)
+    {
+        uint32_t bits = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint32_t bit = offset + i;
+            bits |= ((block[bit / 8] >> (bit % 8)) & 1u) << i;
+        }
+        return bits;
+    }
+
+    // Whether any texel of a BC3/BC4/BC5 style alpha block is below 255
+    static bool IsTransparentAlphaBlock(const uint8_t *block)
+    {
+        const uint32_t alpha0 = block[0];
+        const uint32_t alpha1 = block[1];
+        if (alpha0 == 255 && alpha1 == 255)
+        {
+            return false;
+        }
+
+        std::array<uint32_t, 8> palette{alpha0, alpha1};
+        if (alpha0 > alpha1)
+        {
+            for (uint32_t i = 1; i < 7; i++)
+            {
+                palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 1; i < 5; i++)
+            {
+                palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        for (uint32_t texel = 0; texel < 16; texel++)
+        {
+            if (palette[GetBlockBits(block + 2, texel * 3, 3)] < 255)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool Image::IsTransparentTexture(const vk::Format format, const uint8_t *textureData, const size_t textureSize)
     {
         constexpr size_t CheckEveryXPixels = 4; // We don't need to check every pixel, we'll skip every X pixels
@@ -412,6 +852,83 @@ namespace Spinner
                 break;
             }
 
+            // Block compressed, every block is checked as each one covers 16 texels
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+            {
+                for (size_t i = 0; i + 8 <= textureSize; i += 8)
+                {
+                    const uint8_t *block = textureData + i;
+                    const uint32_t color0 = block[0] | (block[1] << 8);
+                    const uint32_t color1 = block[2] | (block[3] << 8);
+                    if (color0 > color1)
+                    {
+                        continue;
+                    }
+
+                    // In the 3 color mode index 3 is transparent black
+                    for (uint32_t texel = 0; texel < 16; texel++)
+                    {
+                        if (GetBlockBits(block + 4, texel * 2, 2) == 3)
+                        {
+                            return true;
+                        }
+                    }
+                }
+                break;
+            }
+            case vk::Format::eBc2UnormBlock:
+            case vk::Format::eBc2SrgbBlock:
+            {
+                for (size_t i = 0; i + 16 <= textureSize; i += 16)
+                {
+                    for (size_t j = 0; j < 8; j++)
+                    {
+                        if (textureData[i + j] != 0xFF)
+                        {
+                            return true;
+                        }
+                    }
+                }
+                break;
+            }
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+            {
+                for (size_t i = 0; i + 16 <= textureSize; i += 16)
+                {
+                    if (IsTransparentAlphaBlock(textureData + i))
+                    {
+                        return true;
+                    }
+                }
+                break;
+            }
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+            {
+                // Modes 0-3 are opaque. Mode 6 is checked by its alpha endpoints, the other alpha modes (and the reserved mode which decodes to transparent black) are assumed to be transparent
+                for (size_t i = 0; i + 16 <= textureSize; i += 16)
+                {
+                    const uint8_t *block = textureData + i;
+                    if ((block[0] & 0x0F) != 0)
+                    {
+                        continue;
+                    }
+                    if ((block[0] & 0x7F) == 0x40)
+                    {
+                        const uint32_t alpha0 = (GetBlockBits(block, 49, 7) << 1) | GetBlockBits(block, 63, 1);
+                        const uint32_t alpha1 = (GetBlockBits(block, 56, 7) << 1) | GetBlockBits(block, 64, 1);
+                        if (alpha0 == 255 && alpha1 == 255)
+                        {
+                            continue;
+                        }
+                    }
+                    return true;
+                }
+                break;
+            }
+
             default:
                 break;
         }
@@ -10,6 +10,7 @@ namespace Spinner
 {
     class CommandBuffer;
     class Buffer;
+    class Ktx2File;
 
     class Image : public std::enable_shared_from_this<Image>
     {
@@ -17,11 +18,16 @@ namespace Spinner
 
         friend class Buffer;
 
+        friend class MemoryDefragmenter;
+
     public:
         using Pointer = std::shared_ptr<Image>;
 
-        Image(vk::Extent2D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType imageType = vk::ImageType::e2D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly, uint32_t arrayLayers = 1, vk::ImageCreateFlags imageCreateFlags = {});
-        Image(vk::Extent3D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType imageType = vk::ImageType::e3D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly, uint32_t arrayLayers = 1, vk::ImageCreateFlags imageCreateFlags = {});
+        /// Pass as mipLevels to allocate every level down to 1x1, which Write then generates from the first level
+        static constexpr uint32_t FullMipChain = 0;
+
+        Image(vk::Extent2D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType imageType = vk::ImageType::e2D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly, uint32_t arrayLayers = 1, vk::ImageCreateFlags imageCreateFlags = {});
+        Image(vk::Extent3D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType imageType = vk::ImageType::e3D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly, uint32_t arrayLayers = 1, vk::ImageCreateFlags imageCreateFlags = {});
         virtual ~Image();
 
     public:
@@ -29,14 +35,24 @@ namespace Spinner
         vk::Extent2D GetExtent2D() const noexcept;
         vk::Format GetFormat() const noexcept;
         vk::Image GetImage() const noexcept;
+        /// Size of the first mip level of one layer, block compressed formats round up to whole blocks
         vk::DeviceSize GetImageSize() const;
+        vk::DeviceSize GetMipLevelSize(uint32_t mipLevel) const;
+        /// Size of every mip level of one layer, tightly packed from the first level
+        vk::DeviceSize GetMipChainSize() const;
         vk::ImageLayout GetCurrentImageLayout() const noexcept;
         vk::ImageType GetImageType() const noexcept;
         vk::ImageTiling GetImageTiling() const noexcept;
+        uint32_t GetMipLevels() const noexcept;
 
+        /// Writes either the first mip level and generates the rest of the mip chain from it, or every mip level (GetMipChainSize) as is.
+        /// Block compressed formats cannot generate their mip chain
         void Write(const uint8_t *textureData, size_t textureDataSize, vk::ImageAspectFlags aspectFlags, Spinner::CommandBuffer::Pointer commandBuffer = nullptr);
         void Write(const std::vector<uint8_t> &textureData, vk::ImageAspectFlags aspectFlags, Spinner::CommandBuffer::Pointer commandBuffer = nullptr);
 
+        /// Downsamples each mip level into the next with blits, every level must be in the current image layout. Returns false if the format cannot be blitted
+        bool GenerateMipmaps(const Spinner::CommandBuffer::Pointer &commandBuffer);
+
         /// @param imageAspectFlags are ignored if subresourceRange provided
         vk::ImageView CreateImageView(vk::ImageAspectFlags imageAspectFlags, vk::ImageViewType imageViewType = vk::ImageViewType::e2D, std::optional<vk::ImageSubresourceRange> subresourceRange = {});
         void DestroyImageView(vk::ImageView imageView);
@@ -59,20 +75,52 @@ namespace Spinner
         vk::ImageType ImageType;
         vk::ImageTiling ImageTiling;
         uint32_t ArrayLayers;
+        uint32_t MipLevels;
+        vma::MemoryUsage MemoryUsage;
         vk::ImageCreateFlags ImageCreateFlags;
 
+        // Creation parameters of the main image view, used to recreate it when the image is moved
+        vk::ImageViewType MainImageViewType = vk::ImageViewType::e2D;
+        vk::ImageSubresourceRange MainImageViewSubresourceRange;
+
+        // Old handles kept alive while a defragmentation pass moves this image
+        vk::Image MovedFromImage = nullptr;
+        vk::ImageView MovedFromImageView = nullptr;
+
         vk::ImageLayout CurrentImageLayout = vk::ImageLayout::eUndefined;
 
         bool IsTransparent = false;
 
+    protected:
+        /// Uploads a tightly packed mip chain to every level of the first layer
+        void WriteMipChain(const uint8_t *textureData, size_t textureDataSize, vk::ImageAspectFlags aspectFlags, const Spinner::CommandBuffer::Pointer &commandBuffer);
+
+        [[nodiscard]] bool IsMovable() const;
+        /// Binds a new image to the destination allocation, records a copy of every mip and layer into it, then swaps VkImage and the main image view
+        bool BeginMove(::VmaAllocation destination, const CommandBuffer::Pointer &commandBuffer);
+        void FinishMove();
+
+        /// LoadFromTextureFile without the TextureCache
+        static Pointer LoadTextureFile(const std::string &texturePath, uint32_t mipLevels);
+
     public:
-        static Pointer CreateImage(vk::Extent2D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType imageType = vk::ImageType::e2D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly);
-        static Pointer CreateImage3D(vk::Extent3D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType imageType = vk::ImageType::e3D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly);
-        static Pointer CreateCubeImage(vk::Extent2D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly);
+        static Pointer CreateImage(vk::Extent2D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType imageType = vk::ImageType::e2D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly);
+        static Pointer CreateImage3D(vk::Extent3D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType imageType = vk::ImageType::e3D, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly);
+        static Pointer CreateCubeImage(vk::Extent2D extent, vk::Format format, vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageTiling tiling = vk::ImageTiling::eOptimal, uint32_t mipLevels = 1, vma::MemoryUsage memoryUsage = vma::MemoryUsage::eGpuOnly);
         static std::vector<uint8_t> DecodeEmbeddedImageData(const std::vector<uint8_t> &data, int &width, int &height, int &channels, bool &is16Bit);
-        static Pointer LoadFromEmbeddedImageData(const std::vector<uint8_t> &data, int mipLevels = 1);
-        static Pointer LoadFromTextureFile(const std::string &textureFilename, uint32_t mipLevels = 1);
+        static Pointer LoadFromEmbeddedImageData(const std::vector<uint8_t> &data, int mipLevels = FullMipChain);
+        /// Loads PNG, JPEG etc. as RGBA8 or RGBA16, and .ktx2 files in their stored format. The image is shared through the TextureCache
+        static Pointer LoadFromTextureFile(const std::string &textureFilename, uint32_t mipLevels = FullMipChain);
+        /// Uses the file's mip chain when it has more than one level, otherwise generates mipLevels if the format allows
+        static Pointer LoadFromKtx2File(const Ktx2File &file, uint32_t mipLevels = FullMipChain);
         static bool IsTransparentTexture(vk::Format format, const uint8_t *textureData, size_t textureSize);
+        /// Number of mip levels from the extent down to 1x1
+        static uint32_t GetMipLevelCount(vk::Extent3D extent);
+        static vk::Extent3D GetMipExtent(vk::Extent3D extent, uint32_t mipLevel);
+        /// Whether optimal tiled images of the format can be both the source and destination of a blit
+        static bool CanBlitMipmaps(vk::Format format);
+        /// Box filters the mip chain of an 8 or 16 bit unsigned 2D image on the CPU, for formats which cannot be blitted. Returns every level including the first
+        static std::vector<uint8_t> GenerateMipChain(vk::Format format, const uint8_t *data, size_t dataSize, vk::Extent3D extent, uint32_t mipLevels);
     };
 } // Spinner
 
@@ -0,0 +1,283 @@
+#include "JobSystem.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace Spinner
+{
+    JobSystem *JobSystem::Instance = nullptr;
+
+    // Set on worker threads only
+    static thread_local const JobSystem *CurrentJobSystem = nullptr;
+    static thread_local size_t CurrentWorkerIndex = 0;
+
+    JobSystem::JobSystem(size_t workerCount) : MainThreadId(std::this_thread::get_id())
+    {
+        if (workerCount == 0)
+        {
+            workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+
+        for (size_t i = 0; i < workerCount + 2; i++)
+        {
+            Queues.push_back(std::make_unique<JobQueue>());
+        }
+
+        Workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+
+        if (Instance == nullptr)
+        {
+            Instance = this;
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        if (Instance == this)
+        {
+            Instance = nullptr;
+        }
+
+        {
+            std::lock_guard lock(SleepMutex);
+            Stopping = true;
+        }
+        WakeCondition.notify_all();
+
+        // Jobs still queued are discarded
+        for (auto &worker : Workers)
+        {
+            worker.join();
+        }
+    }
+
+    void JobSystem::Run(Job job, JobCounter *counter)
+    {
+        if (counter != nullptr)
+        {
+            counter->Count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Counted first so the count never drops below the jobs actually queued
+        QueuedCount.fetch_add(1, std::memory_order_release);
+        auto &queue = *Queues[GetQueueIndex()];
+        {
+            std::lock_guard lock(queue.Mutex);
+            queue.Jobs.push_back({std::move(job), counter});
+        }
+
+        // Taking the lock orders this with a worker which has just found nothing queued and is about to sleep
+        {
+            std::lock_guard lock(SleepMutex);
+        }
+        WakeCondition.notify_one();
+    }
+
+    void JobSystem::RunAfter(const JobCounter &dependency, Job job, JobCounter *counter)
+    {
+        if (dependency.IsDone() && dependency.FirstException == nullptr)
+        {
+            Run(std::move(job), counter);
+            return;
+        }
+
+        // Waiting inside the job keeps its worker busy with other jobs until the dependency is done
+        Run([this, &dependency, job = std::move(job)]()
+        {
+            Wait(dependency);
+            job();
+        }, counter);
+    }
+
+    void JobSystem::RunOnMainThread(Job job, JobCounter *counter)
+    {
+        if (counter != nullptr)
+        {
+            counter->Count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::lock_guard lock(MainThreadQueue.Mutex);
+        MainThreadQueue.Jobs.push_back({std::move(job), counter});
+    }
+
+    void JobSystem::Wait(const JobCounter &counter)
+    {
+        const auto queueIndex = GetQueueIndex();
+        const bool isMainThread = IsMainThread();
+        while (!counter.IsDone())
+        {
+            if (isMainThread)
+            {
+                RunMainThreadJobs();
+            }
+
+            // The main thread only runs what it queued itself, stealing could hand it a loader's encode chunk and stall the frame
+            if (!TryRunJob(queueIndex, !isMainThread))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (counter.FirstException != nullptr)
+        {
+            std::rethrow_exception(counter.FirstException);
+        }
+    }
+
+    void JobSystem::RunMainThreadJobs()
+    {
+        if (!IsMainThread())
+        {
+            throw std::runtime_error("Main thread jobs can only be run on the thread which created the job system");
+        }
+
+        // Only the jobs queued so far, jobs they queue run next time
+        std::deque<QueuedJob> jobs;
+        {
+            std::lock_guard lock(MainThreadQueue.Mutex);
+            jobs.swap(MainThreadQueue.Jobs);
+        }
+
+        for (auto &job : jobs)
+        {
+            Execute(job);
+        }
+    }
+
+    size_t JobSystem::GetWorkerCount() const noexcept
+    {
+        return Workers.size();
+    }
+
+    bool JobSystem::IsMainThread() const noexcept
+    {
+        return std::this_thread::get_id() == MainThreadId;
+    }
+
+    void JobSystem::WorkerLoop(size_t workerIndex)
+    {
+        CurrentJobSystem = this;
+        CurrentWorkerIndex = workerIndex;
+
+        // Checked between jobs as well as when idle, so shutting down does not run everything still queued
+        while (!Stopping.load(std::memory_order_acquire))
+        {
+            if (TryRunJob(workerIndex))
+            {
+                continue;
+            }
+
+            std::unique_lock lock(SleepMutex);
+            WakeCondition.wait(lock, [this]() { return Stopping || QueuedCount.load(std::memory_order_acquire) > 0; });
+        }
+    }
+
+    size_t JobSystem::GetQueueIndex() const noexcept
+    {
+        if (CurrentJobSystem == this)
+        {
+            return CurrentWorkerIndex;
+        }
+        return IsMainThread() ? Workers.size() : Queues.size() - 1;
+    }
+
+    bool JobSystem::TryRunJob(size_t queueIndex, bool steal)
+    {
+        if (QueuedCount.load(std::memory_order_acquire) == 0)
+        {
+            return false;
+        }
+
+        QueuedJob job;
+        bool found = false;
+
+        // Own queue newest first, it is the most likely to still be in cache
+        {
+            auto &queue = *Queues[queueIndex];
+            std::lock_guard lock(queue.Mutex);
+            if (!queue.Jobs.empty())
+            {
+                job = std::move(queue.Jobs.back());
+                queue.Jobs.pop_back();
+                found = true;
+            }
+        }
+
+        // Then the oldest job of another queue, which tends to be the largest piece of remaining work
+        for (size_t offset = 1; steal && !found && offset < Queues.size(); offset++)
+        {
+            auto &queue = *Queues[(queueIndex + offset) % Queues.size()];
+            std::lock_guard lock(queue.Mutex);
+            if (!queue.Jobs.empty())
+            {
+                job = std::move(queue.Jobs.front());
+                queue.Jobs.pop_front();
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+
+        QueuedCount.fetch_sub(1, std::memory_order_relaxed);
+        Execute(job);
+        return true;
+    }
+
+    // For jobs without a counter, whose exceptions have nowhere to go
+    static void ReportException(const std::exception_ptr &exception)
+    {
+        try
+        {
+            std::rethrow_exception(exception);
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "Job threw an exception: " << ex.what() << '\n';
+        }
+        catch (...)
+        {
+            std::cerr << "Job threw an exception of unknown type\n";
+        }
+    }
+
+    void JobSystem::Execute(QueuedJob &job)
+    {
+        // Anything thrown is caught so the counter is always released, an exception escaping a worker would terminate
+        try
+        {
+            job.Function();
+        }
+        catch (...)
+        {
+            if (job.Counter != nullptr)
+            {
+                std::lock_guard lock(job.Counter->ExceptionMutex);
+                if (job.Counter->FirstException == nullptr)
+                {
+                    job.Counter->FirstException = std::current_exception();
+                }
+            }
+            else
+            {
+                ReportException(std::current_exception());
+            }
+        }
+
+        if (job.Counter != nullptr)
+        {
+            job.Counter->Count.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    JobSystem *JobSystem::Get() noexcept
+    {
+        return Instance;
+    }
+} // Spinner
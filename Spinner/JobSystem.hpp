@@ -0,0 +1,161 @@
+#ifndef SPINNER_JOBSYSTEM_HPP
+#define SPINNER_JOBSYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Spinner
+{
+    /// Counts a group of jobs which have not finished yet, JobSystem::Wait returns once it reaches zero. Must outlive its jobs
+    class JobCounter
+    {
+        friend class JobSystem;
+
+    public:
+        [[nodiscard]] inline bool IsDone() const noexcept
+        {
+            return Count.load(std::memory_order_acquire) == 0;
+        }
+
+    protected:
+        std::atomic<uint32_t> Count = 0;
+        std::exception_ptr FirstException; // Written before the job's count is released, so it is safe to read once done
+        std::mutex ExceptionMutex;
+    };
+
+    /// Fixed set of worker threads, each with its own queue. Workers take their newest job first and steal the oldest from other queues
+    /// when theirs is empty. Threads waiting on a counter run jobs in the meantime, so jobs may wait on jobs of their own.
+    /// The main thread has a queue of its own and only runs jobs from it while it waits, so it never picks up another thread's long job
+    /// in the middle of a frame. Main thread jobs only run on the thread which created the job system, from RunMainThreadJobs or while it waits
+    class JobSystem
+    {
+    public:
+        using Pointer = std::shared_ptr<JobSystem>;
+        using Job = std::function<void()>;
+
+        /// 0 workers uses one less than the hardware's threads, the main thread makes up the last while it waits
+        explicit JobSystem(size_t workerCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+
+    public:
+        /// An exception the job throws is kept by counter for Wait to rethrow, without a counter it is only reported
+        void Run(Job job, JobCounter *counter = nullptr);
+        /// Runs job once dependency is done. When one of dependency's jobs threw, job is skipped and the exception passes on to counter
+        void RunAfter(const JobCounter &dependency, Job job, JobCounter *counter = nullptr);
+        void RunOnMainThread(Job job, JobCounter *counter = nullptr);
+        /// Runs queued jobs until counter is done, then rethrows the first exception one of its jobs threw
+        void Wait(const JobCounter &counter);
+        /// Runs every main thread job queued so far, called by App once per frame
+        void RunMainThreadJobs();
+
+        /// Calls function(begin, end) over [0, count) in chunks of grainSize spread across the workers, the calling thread runs the first chunk.
+        /// Returns once every chunk has finished, then rethrows an exception one of them threw
+        template<typename Function>
+        void ParallelFor(size_t count, size_t grainSize, Function &&function)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            grainSize = std::max<size_t>(grainSize, 1);
+            if (count <= grainSize || Workers.empty())
+            {
+                function(static_cast<size_t>(0), count);
+                return;
+            }
+
+            JobCounter counter;
+            for (size_t begin = grainSize; begin < count; begin += grainSize)
+            {
+                const auto end = std::min(begin + grainSize, count);
+                Run([&function, begin, end]() { function(begin, end); }, &counter);
+            }
+
+            // The chunks reference function, so they must all finish before anything is rethrown
+            std::exception_ptr callerException;
+            try
+            {
+                function(static_cast<size_t>(0), grainSize);
+            }
+            catch (...)
+            {
+                callerException = std::current_exception();
+            }
+            Wait(counter);
+
+            if (callerException != nullptr)
+            {
+                std::rethrow_exception(callerException);
+            }
+        }
+
+        [[nodiscard]] size_t GetWorkerCount() const noexcept;
+        [[nodiscard]] bool IsMainThread() const noexcept;
+
+    protected:
+        struct QueuedJob
+        {
+            Job Function;
+            JobCounter *Counter = nullptr;
+        };
+
+        struct JobQueue
+        {
+            std::mutex Mutex;
+            std::deque<QueuedJob> Jobs;
+        };
+
+        std::vector<std::thread> Workers;
+        std::vector<std::unique_ptr<JobQueue>> Queues; // One per worker, one for the main thread, then one shared by every other thread
+        JobQueue MainThreadQueue;
+        const std::thread::id MainThreadId;
+
+        std::atomic<size_t> QueuedCount = 0; // Jobs in Queues not yet taken
+        std::atomic<bool> Stopping = false;
+        std::mutex SleepMutex;
+        std::condition_variable WakeCondition;
+
+    protected:
+        void WorkerLoop(size_t workerIndex);
+        /// The calling thread's queue, workers and the main thread own one each and every other thread shares the last
+        [[nodiscard]] size_t GetQueueIndex() const noexcept;
+        /// Runs the newest job of queueIndex's queue, or when steal is set the oldest of another's. Returns false when no job was found
+        bool TryRunJob(size_t queueIndex, bool steal = true);
+        static void Execute(QueuedJob &job);
+
+    protected:
+        static JobSystem *Instance;
+
+    public:
+        /// The App's job system, nullptr when there is none so callers can run their work inline
+        [[nodiscard]] static JobSystem *Get() noexcept;
+
+        /// ParallelFor on the App's job system, or the whole range on the calling thread when there is none
+        template<typename Function>
+        static void ParallelForOrInline(size_t count, size_t grainSize, Function &&function)
+        {
+            if (auto *jobs = Get(); jobs != nullptr)
+            {
+                jobs->ParallelFor(count, grainSize, std::forward<Function>(function));
+            }
+            else if (count > 0)
+            {
+                function(static_cast<size_t>(0), count);
+            }
+        }
+    };
+} // Spinner
+
+#endif //SPINNER_JOBSYSTEM_HPP
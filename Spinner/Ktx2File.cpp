@@ -0,0 +1,294 @@
+#include "Ktx2File.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+#include "Image.hpp"
+#include "MappedFile.hpp"
+#include "Utilities.hpp"
+#include "VulkanUtilities.hpp"
+
+namespace Spinner
+{
+    static_assert(sizeof(Ktx2File::Header) == 80);
+    static_assert(sizeof(Ktx2File::LevelIndex) == 24);
+
+    // Khronos Data Format values used by the basic data format descriptor
+    static constexpr uint32_t DfdModelBc1a = 128;
+    static constexpr uint32_t DfdModelBc3 = 130;
+    static constexpr uint32_t DfdModelBc5 = 132;
+    static constexpr uint32_t DfdModelBc7 = 134;
+    static constexpr uint32_t DfdPrimariesBt709 = 1;
+    static constexpr uint32_t DfdTransferLinear = 1;
+    static constexpr uint32_t DfdTransferSrgb = 2;
+    static constexpr uint32_t DfdVersion = 2;
+
+    struct DfdSample
+    {
+        uint32_t BitOffset;
+        uint32_t BitLength;
+        uint32_t Channel;
+    };
+
+    // Returns the descriptor as 32 bit words, starting with its total size in bytes
+    static std::vector<uint32_t> CreateDataFormatDescriptor(vk::Format format)
+    {
+        uint32_t colorModel;
+        std::vector<DfdSample> samples;
+        switch (format)
+        {
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+                colorModel = DfdModelBc1a;
+                samples = {{0, 64, 0}};
+                break;
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+                colorModel = DfdModelBc1a;
+                samples = {{0, 64, 1}}; // Alpha present
+                break;
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+                colorModel = DfdModelBc3;
+                samples = {{0, 64, 15}, {64, 64, 0}}; // Alpha then color
+                break;
+            case vk::Format::eBc5UnormBlock:
+                colorModel = DfdModelBc5;
+                samples = {{0, 64, 0}, {64, 64, 1}}; // Red then green
+                break;
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+                colorModel = DfdModelBc7;
+                samples = {{0, 128, 0}};
+                break;
+            default:
+                throw std::runtime_error("Cannot describe format " + vk::to_string(format) + " in a KTX2 file");
+        }
+
+        const bool isSrgb = format == vk::Format::eBc1RgbSrgbBlock || format == vk::Format::eBc1RgbaSrgbBlock || format == vk::Format::eBc3SrgbBlock || format == vk::Format::eBc7SrgbBlock;
+        const auto blockExtent = VkFormatBlockExtent(format);
+        const auto blockSize = static_cast<uint32_t>(VkFormatBlockSize(format));
+        const auto descriptorBlockSize = static_cast<uint32_t>(24 + samples.size() * 16);
+
+        std::vector<uint32_t> words;
+        words.push_back(4 + descriptorBlockSize);
+        words.push_back(0); // Khronos vendor, basic descriptor type
+        words.push_back(DfdVersion | (descriptorBlockSize << 16));
+        words.push_back(colorModel | (DfdPrimariesBt709 << 8) | ((isSrgb ? DfdTransferSrgb : DfdTransferLinear) << 16));
+        words.push_back((blockExtent.width - 1) | ((blockExtent.height - 1) << 8));
+        words.push_back(blockSize);
+        words.push_back(0);
+        for (const auto &sample : samples)
+        {
+            words.push_back(sample.BitOffset | ((sample.BitLength - 1) << 16) | (sample.Channel << 24));
+            words.push_back(0); // Sample position
+            words.push_back(0); // Lower
+            words.push_back(0xFFFF'FFFF); // Upper
+        }
+        return words;
+    }
+
+    // The key/value data, only the recommended writer entry
+    static std::vector<uint8_t> CreateKeyValueData()
+    {
+        // Null terminated key then null terminated value
+        const std::string entry = std::string("KTXwriter") + '\0' + "Spinner" + '\0';
+        const auto length = static_cast<uint32_t>(entry.size());
+
+        std::vector<uint8_t> data(AlignUp<size_t>(sizeof(uint32_t) + entry.size(), 4));
+        std::memcpy(data.data(), &length, sizeof(uint32_t));
+        std::memcpy(data.data() + sizeof(uint32_t), entry.data(), entry.size());
+        return data;
+    }
+
+    Ktx2File::Ktx2File(vk::Format format, vk::Extent2D extent, uint32_t mipLevels, std::vector<uint8_t> mipChain) : Format(format), Extent(extent), MipLevels(mipLevels), Data(std::move(mipChain))
+    {
+    }
+
+    Ktx2File::Ktx2File(std::span<const uint8_t> bytes)
+    {
+        Header header;
+        if (bytes.size() < sizeof(Header))
+        {
+            throw std::runtime_error("KTX2 file is smaller than its header");
+        }
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+
+        if (header.Identifier != Identifier)
+        {
+            throw std::runtime_error("File is not a KTX2 file");
+        }
+        if (header.SupercompressionScheme != 0 || header.VkFormat == 0)
+        {
+            throw std::runtime_error("Supercompressed KTX2 files are not supported");
+        }
+        if (header.PixelWidth == 0 || header.PixelHeight == 0 || header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1)
+        {
+            throw std::runtime_error("Only single 2D KTX2 textures are supported");
+        }
+
+        Format = static_cast<vk::Format>(header.VkFormat);
+        Extent = vk::Extent2D{header.PixelWidth, header.PixelHeight};
+        MipLevels = std::max(1u, header.LevelCount); // 0 asks the loader to generate the mip chain
+        if (MipLevels > Image::GetMipLevelCount({Extent.width, Extent.height, 1}))
+        {
+            throw std::runtime_error("KTX2 file has more mip levels than its extent allows");
+        }
+
+        if (bytes.size() < sizeof(Header) + MipLevels * sizeof(LevelIndex))
+        {
+            throw std::runtime_error("KTX2 level index is out of bounds");
+        }
+
+        std::vector<LevelIndex> levels(MipLevels);
+        std::memcpy(levels.data(), bytes.data() + sizeof(Header), MipLevels * sizeof(LevelIndex));
+
+        size_t dataSize = 0;
+        for (uint32_t mip = 0; mip < MipLevels; mip++)
+        {
+            dataSize += VkFormatImageSize(Format, Image::GetMipExtent({Extent.width, Extent.height, 1}, mip));
+        }
+        Data.reserve(dataSize);
+
+        for (uint32_t mip = 0; mip < MipLevels; mip++)
+        {
+            const auto &level = levels[mip];
+            const size_t levelSize = VkFormatImageSize(Format, Image::GetMipExtent({Extent.width, Extent.height, 1}, mip));
+            if (level.ByteLength != levelSize || level.ByteOffset > bytes.size() || level.ByteLength > bytes.size() - level.ByteOffset)
+            {
+                throw std::runtime_error("KTX2 mip level " + std::to_string(mip) + " is out of bounds");
+            }
+            Data.insert(Data.end(), bytes.begin() + static_cast<ptrdiff_t>(level.ByteOffset), bytes.begin() + static_cast<ptrdiff_t>(level.ByteOffset + level.ByteLength));
+        }
+    }
+
+    vk::Format Ktx2File::GetFormat() const noexcept
+    {
+        return Format;
+    }
+
+    vk::Extent2D Ktx2File::GetExtent() const noexcept
+    {
+        return Extent;
+    }
+
+    uint32_t Ktx2File::GetMipLevels() const noexcept
+    {
+        return MipLevels;
+    }
+
+    const std::vector<uint8_t> &Ktx2File::GetData() const noexcept
+    {
+        return Data;
+    }
+
+    void Ktx2File::Write(const std::string &filePath) const
+    {
+        const auto descriptor = CreateDataFormatDescriptor(Format);
+        const auto keyValueData = CreateKeyValueData();
+        const size_t blockSize = VkFormatBlockSize(Format);
+
+        Header header;
+        header.Identifier = Identifier;
+        header.VkFormat = static_cast<uint32_t>(Format);
+        header.TypeSize = VkFormatIsBlockCompressed(Format) ? 1 : static_cast<uint32_t>(blockSize);
+        header.PixelWidth = Extent.width;
+        header.PixelHeight = Extent.height;
+        header.PixelDepth = 0;
+        header.LayerCount = 0;
+        header.FaceCount = 1;
+        header.LevelCount = MipLevels;
+        header.SupercompressionScheme = 0;
+        header.DfdByteOffset = static_cast<uint32_t>(sizeof(Header) + MipLevels * sizeof(LevelIndex));
+        header.DfdByteLength = static_cast<uint32_t>(descriptor.size() * sizeof(uint32_t));
+        header.KvdByteOffset = header.DfdByteOffset + header.DfdByteLength;
+        header.KvdByteLength = static_cast<uint32_t>(keyValueData.size());
+
+        // Levels are stored from the smallest, each aligned to both the block size and 4 bytes
+        const uint64_t levelAlignment = std::lcm<uint64_t>(blockSize, 4);
+        std::vector<LevelIndex> levels(MipLevels);
+        std::vector<size_t> dataOffsets(MipLevels);
+        size_t dataOffset = 0;
+        for (uint32_t mip = 0; mip < MipLevels; mip++)
+        {
+            dataOffsets[mip] = dataOffset;
+            levels[mip].ByteLength = VkFormatImageSize(Format, Image::GetMipExtent({Extent.width, Extent.height, 1}, mip));
+            levels[mip].UncompressedByteLength = levels[mip].ByteLength;
+            dataOffset += levels[mip].ByteLength;
+        }
+        if (dataOffset != Data.size())
+        {
+            throw std::runtime_error("Cannot write a KTX2 file whose data is not the size of its mip chain");
+        }
+
+        uint64_t offset = header.KvdByteOffset + header.KvdByteLength;
+        for (uint32_t mip = MipLevels; mip-- > 0;)
+        {
+            offset = (offset + levelAlignment - 1) / levelAlignment * levelAlignment;
+            levels[mip].ByteOffset = offset;
+            offset += levels[mip].ByteLength;
+        }
+
+        std::filesystem::create_directories(std::filesystem::path(filePath).parent_path());
+        const std::string temporaryPath = filePath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Failed to open KTX2 file for writing: " + temporaryPath);
+            }
+
+            uint64_t written = 0;
+            const auto writeAt = [&file, &written](uint64_t position, const void *bytes, size_t size)
+            {
+                static constexpr std::array<char, 16> Padding{};
+                file.write(Padding.data(), static_cast<std::streamsize>(position - written));
+                file.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(size));
+                written = position + size;
+            };
+
+            writeAt(0, &header, sizeof(Header));
+            writeAt(sizeof(Header), levels.data(), levels.size() * sizeof(LevelIndex));
+            writeAt(header.DfdByteOffset, descriptor.data(), header.DfdByteLength);
+            writeAt(header.KvdByteOffset, keyValueData.data(), keyValueData.size());
+            for (uint32_t mip = MipLevels; mip-- > 0;)
+            {
+                writeAt(levels[mip].ByteOffset, Data.data() + dataOffsets[mip], levels[mip].ByteLength);
+            }
+
+            if (!file.good())
+            {
+                throw std::runtime_error("Failed to write KTX2 file: " + temporaryPath);
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, filePath);
+    }
+
+    Ktx2File::Pointer Ktx2File::Open(const std::string &filePath)
+    {
+        auto file = MappedFile::Open(filePath);
+        return std::make_shared<Ktx2File>(file->GetBytes());
+    }
+
+    bool Ktx2File::CanWrite(vk::Format format)
+    {
+        switch (format)
+        {
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+            case vk::Format::eBc5UnormBlock:
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+                return true;
+            default:
+                return false;
+        }
+    }
+} // Spinner
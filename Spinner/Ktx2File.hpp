@@ -0,0 +1,78 @@
+#ifndef SPINNER_KTX2FILE_HPP
+#define SPINNER_KTX2FILE_HPP
+
+#include <vulkan/vulkan.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <span>
+#include <array>
+#include <vector>
+
+namespace Spinner
+{
+    /// A single 2D texture in the KTX 2.0 container, with its mip chain tightly packed from the first level.
+    /// Supercompressed (Basis Universal, Zstandard) files, arrays, cube maps and 3D textures are not supported
+    class Ktx2File
+    {
+    public:
+        using Pointer = std::shared_ptr<Ktx2File>;
+
+        static constexpr std::array<uint8_t, 12> Identifier = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+        static constexpr std::string_view Extension = ".ktx2";
+
+        struct Header
+        {
+            std::array<uint8_t, 12> Identifier{};
+            uint32_t VkFormat = 0;
+            uint32_t TypeSize = 0;
+            uint32_t PixelWidth = 0;
+            uint32_t PixelHeight = 0;
+            uint32_t PixelDepth = 0;
+            uint32_t LayerCount = 0;
+            uint32_t FaceCount = 0;
+            uint32_t LevelCount = 0;
+            uint32_t SupercompressionScheme = 0;
+            uint32_t DfdByteOffset = 0;
+            uint32_t DfdByteLength = 0;
+            uint32_t KvdByteOffset = 0;
+            uint32_t KvdByteLength = 0;
+            uint64_t SgdByteOffset = 0;
+            uint64_t SgdByteLength = 0;
+        };
+
+        struct LevelIndex
+        {
+            uint64_t ByteOffset = 0;
+            uint64_t ByteLength = 0;
+            uint64_t UncompressedByteLength = 0;
+        };
+
+        /// mipChain holds every level tightly packed from the first, see Image::GetMipChainSize
+        Ktx2File(vk::Format format, vk::Extent2D extent, uint32_t mipLevels, std::vector<uint8_t> mipChain);
+        /// Parses a whole file, throws if it is invalid or unsupported
+        explicit Ktx2File(std::span<const uint8_t> bytes);
+
+    protected:
+        vk::Format Format = vk::Format::eUndefined;
+        vk::Extent2D Extent;
+        uint32_t MipLevels = 1;
+        std::vector<uint8_t> Data;
+
+    public:
+        [[nodiscard]] vk::Format GetFormat() const noexcept;
+        [[nodiscard]] vk::Extent2D GetExtent() const noexcept;
+        [[nodiscard]] uint32_t GetMipLevels() const noexcept;
+        [[nodiscard]] const std::vector<uint8_t> &GetData() const noexcept;
+
+        /// Writes to a temporary file which then replaces filePath, so readers never see a partial file
+        void Write(const std::string &filePath) const;
+
+    public:
+        static Pointer Open(const std::string &filePath);
+        /// Whether Write can describe the format, BC1, BC3, BC5 and BC7
+        static bool CanWrite(vk::Format format);
+    };
+} // Spinner
+
+#endif //SPINNER_KTX2FILE_HPP
@@ -0,0 +1,151 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Spinner
+{
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string &filePath)
+    {
+        FileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (FileHandle == INVALID_HANDLE_VALUE)
+        {
+            FileHandle = nullptr;
+            throw std::runtime_error("Failed to open file for mapping: " + filePath);
+        }
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(FileHandle, &fileSize))
+        {
+            Close();
+            throw std::runtime_error("Failed to get the size of file: " + filePath);
+        }
+        Size = static_cast<size_t>(fileSize.QuadPart);
+
+        // Empty files cannot be mapped
+        if (Size == 0)
+        {
+            return;
+        }
+
+        MappingHandle = CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (MappingHandle == nullptr)
+        {
+            Close();
+            throw std::runtime_error("Failed to map file: " + filePath);
+        }
+
+        Data = static_cast<const uint8_t *>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (Data == nullptr)
+        {
+            Close();
+            throw std::runtime_error("Failed to map file: " + filePath);
+        }
+    }
+
+    void MappedFile::Close()
+    {
+        if (Data != nullptr)
+        {
+            UnmapViewOfFile(Data);
+            Data = nullptr;
+        }
+        if (MappingHandle != nullptr)
+        {
+            CloseHandle(MappingHandle);
+            MappingHandle = nullptr;
+        }
+        if (FileHandle != nullptr)
+        {
+            CloseHandle(FileHandle);
+            FileHandle = nullptr;
+        }
+        Size = 0;
+    }
+#else
+    MappedFile::MappedFile(const std::string &filePath)
+    {
+        FileDescriptor = open(filePath.c_str(), O_RDONLY);
+        if (FileDescriptor < 0)
+        {
+            throw std::runtime_error("Failed to open file for mapping: " + filePath);
+        }
+
+        struct stat fileStatus{};
+        if (fstat(FileDescriptor, &fileStatus) != 0)
+        {
+            Close();
+            throw std::runtime_error("Failed to get the size of file: " + filePath);
+        }
+        Size = static_cast<size_t>(fileStatus.st_size);
+
+        // Empty files cannot be mapped
+        if (Size == 0)
+        {
+            return;
+        }
+
+        void *data = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+        if (data == MAP_FAILED)
+        {
+            Close();
+            throw std::runtime_error("Failed to map file: " + filePath);
+        }
+        Data = static_cast<const uint8_t *>(data);
+
+        // Files are mostly read front to back, e.g. when hashing or uploading
+        madvise(data, Size, MADV_SEQUENTIAL);
+    }
+
+    void MappedFile::Close()
+    {
+        if (Data != nullptr)
+        {
+            munmap(const_cast<uint8_t *>(Data), Size);
+            Data = nullptr;
+        }
+        if (FileDescriptor >= 0)
+        {
+            close(FileDescriptor);
+            FileDescriptor = -1;
+        }
+        Size = 0;
+    }
+#endif
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    const uint8_t *MappedFile::GetData() const
+    {
+        return Data;
+    }
+
+    size_t MappedFile::GetSize() const
+    {
+        return Size;
+    }
+
+    std::span<const uint8_t> MappedFile::GetBytes() const
+    {
+        return {Data, Size};
+    }
+
+    MappedFile::Pointer MappedFile::Open(const std::string &filePath)
+    {
+        return std::make_shared<MappedFile>(filePath);
+    }
+} // Spinner
@@ -0,0 +1,46 @@
+#ifndef SPINNER_MAPPEDFILE_HPP
+#define SPINNER_MAPPEDFILE_HPP
+
+#include <memory>
+#include <string>
+#include <span>
+#include <cstdint>
+
+namespace Spinner
+{
+    /// Read only memory mapping of a whole file, pages are loaded by the OS on first access
+    class MappedFile
+    {
+    public:
+        using Pointer = std::shared_ptr<MappedFile>;
+
+        explicit MappedFile(const std::string &filePath);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+    protected:
+        const uint8_t *Data = nullptr;
+        size_t Size = 0;
+#ifdef _WIN32
+        void *FileHandle = nullptr;
+        void *MappingHandle = nullptr;
+#else
+        int FileDescriptor = -1;
+#endif
+
+    protected:
+        void Close();
+
+    public:
+        [[nodiscard]] const uint8_t *GetData() const;
+        [[nodiscard]] size_t GetSize() const;
+        [[nodiscard]] std::span<const uint8_t> GetBytes() const;
+
+    public:
+        static Pointer Open(const std::string &filePath);
+    };
+} // Spinner
+
+#endif //SPINNER_MAPPEDFILE_HPP
@@ -0,0 +1,254 @@
+#include "MemoryDefragmenter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <imgui.h>
+
+#include "Graphics.hpp"
+#include "Buffer.hpp"
+#include "Image.hpp"
+
+namespace Spinner
+{
+    MemoryDefragmenter::MemoryDefragmenter(vma::Allocator allocator) : Allocator(allocator)
+    {
+    }
+
+    MemoryDefragmenter::~MemoryDefragmenter()
+    {
+        Finish();
+    }
+
+    void MemoryDefragmenter::Begin(vk::DeviceSize maxBytesPerPass, uint32_t maxAllocationsPerPass)
+    {
+        if (IsRunning())
+        {
+            return;
+        }
+
+        VmaDefragmentationInfo info{};
+        info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        info.pool = nullptr; // Default pools
+        info.maxBytesPerPass = maxBytesPerPass;
+        info.maxAllocationsPerPass = maxAllocationsPerPass;
+
+        vk::detail::resultCheck(static_cast<vk::Result>(vmaBeginDefragmentation(static_cast<VmaAllocator>(Allocator), &info, &Context)), "Failed to begin defragmentation");
+
+        CurrentStatistics = {};
+    }
+
+    void MemoryDefragmenter::Update(uint64_t completedEpoch, uint64_t currentEpoch)
+    {
+        if (!IsRunning())
+        {
+            return;
+        }
+
+        if (PassActive)
+        {
+            // Frames recorded before the handles were swapped may still be using the old resources
+            if (completedEpoch < PassEpoch)
+            {
+                return;
+            }
+
+            EndPass();
+            return;
+        }
+
+        BeginPass(currentEpoch);
+    }
+
+    void MemoryDefragmenter::BeginPass(uint64_t currentEpoch)
+    {
+        PassInfo = {};
+        auto result = vmaBeginDefragmentationPass(static_cast<VmaAllocator>(Allocator), Context, &PassInfo);
+        if (result == VK_SUCCESS)
+        {
+            // Nothing left to move
+            End();
+            return;
+        }
+        vk::detail::resultCheck(static_cast<vk::Result>(result), "Failed to begin defragmentation pass", {vk::Result::eIncomplete});
+
+        auto commandBuffer = Graphics::BeginSingleTimeCommands();
+
+        for (uint32_t i = 0; i < PassInfo.moveCount; i++)
+        {
+            auto &move = PassInfo.pMoves[i];
+
+            if (auto buffer = MovableBuffers.find(move.srcAllocation); buffer != MovableBuffers.end() && buffer->second->BeginMove(move.dstTmpAllocation, commandBuffer))
+            {
+                MovingBuffers.push_back(buffer->second);
+                continue;
+            }
+
+            if (auto image = MovableImages.find(move.srcAllocation); image != MovableImages.end() && image->second->BeginMove(move.dstTmpAllocation, commandBuffer))
+            {
+                MovingImages.push_back(image->second);
+                continue;
+            }
+
+            // Not owned by a movable resource (mapped, attachment, etc.)
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        }
+
+        // Not waited on, EndPass only runs once the frame recorded after this submission has completed
+        PassCommandBuffer = commandBuffer;
+        PassFence = Graphics::SubmitSingleTimeCommands(commandBuffer);
+
+        PassActive = true;
+        PassEpoch = currentEpoch;
+    }
+
+    void MemoryDefragmenter::EndPass()
+    {
+        // Already signalled once PassEpoch has completed, and Finish is only called with the device idle
+        Graphics::FinishSingleTimeCommands(PassCommandBuffer, PassFence, true);
+        PassCommandBuffer = nullptr;
+        PassFence = nullptr;
+
+        for (auto *buffer : MovingBuffers)
+        {
+            buffer->FinishMove();
+        }
+        for (auto *image : MovingImages)
+        {
+            image->FinishMove();
+        }
+        MovingBuffers.clear();
+        MovingImages.clear();
+
+        auto result = vmaEndDefragmentationPass(static_cast<VmaAllocator>(Allocator), Context, &PassInfo);
+        PassActive = false;
+        PassInfo = {};
+        CurrentStatistics.Passes++;
+
+        if (result == VK_SUCCESS)
+        {
+            End();
+            return;
+        }
+        vk::detail::resultCheck(static_cast<vk::Result>(result), "Failed to end defragmentation pass", {vk::Result::eIncomplete});
+    }
+
+    void MemoryDefragmenter::End()
+    {
+        VmaDefragmentationStats stats{};
+        vmaEndDefragmentation(static_cast<VmaAllocator>(Allocator), Context, &stats);
+        Context = nullptr;
+
+        CurrentStatistics.BytesMoved = stats.bytesMoved;
+        CurrentStatistics.BytesFreed = stats.bytesFreed;
+        CurrentStatistics.AllocationsMoved = stats.allocationsMoved;
+        CurrentStatistics.DeviceMemoryBlocksFreed = stats.deviceMemoryBlocksFreed;
+
+        LastStatistics = CurrentStatistics;
+        TotalBytesFreed += stats.bytesFreed;
+    }
+
+    void MemoryDefragmenter::Finish()
+    {
+        if (PassActive)
+        {
+            EndPass();
+        }
+        if (IsRunning())
+        {
+            End();
+        }
+    }
+
+    bool MemoryDefragmenter::IsRunning() const
+    {
+        return Context != nullptr;
+    }
+
+    const MemoryDefragmenter::Statistics &MemoryDefragmenter::GetLastStatistics() const
+    {
+        return LastStatistics;
+    }
+
+    vk::DeviceSize MemoryDefragmenter::GetTotalBytesFreed() const
+    {
+        return TotalBytesFreed;
+    }
+
+    void MemoryDefragmenter::RegisterBuffer(Buffer *buffer)
+    {
+        MovableBuffers[static_cast<VmaAllocation>(buffer->VmaAllocation)] = buffer;
+    }
+
+    void MemoryDefragmenter::UnregisterBuffer(Buffer *buffer)
+    {
+        MovableBuffers.erase(static_cast<VmaAllocation>(buffer->VmaAllocation));
+    }
+
+    void MemoryDefragmenter::RegisterImage(Image *image)
+    {
+        MovableImages[static_cast<VmaAllocation>(image->VmaAllocation)] = image;
+    }
+
+    void MemoryDefragmenter::UnregisterImage(Image *image)
+    {
+        MovableImages.erase(static_cast<VmaAllocation>(image->VmaAllocation));
+    }
+
+    bool MemoryDefragmenter::ReleaseMovingAllocation(VmaAllocation allocation)
+    {
+        if (!PassActive)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < PassInfo.moveCount; i++)
+        {
+            auto &move = PassInfo.pMoves[i];
+            if (move.srcAllocation != allocation || move.operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+            {
+                continue;
+            }
+
+            // VMA frees both the source and the temporary destination allocation when the pass ends
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+            std::erase_if(MovingBuffers, [allocation](const Buffer *buffer) { return static_cast<VmaAllocation>(buffer->VmaAllocation) == allocation; });
+            std::erase_if(MovingImages, [allocation](const Image *image) { return static_cast<VmaAllocation>(image->VmaAllocation) == allocation; });
+            return true;
+        }
+
+        return false;
+    }
+
+    void MemoryDefragmenter::RenderDebugUI()
+    {
+        const auto memoryProperties = Graphics::GetPhysicalDevice().getMemoryProperties();
+        std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+        vmaGetHeapBudgets(static_cast<VmaAllocator>(Allocator), budgets.data());
+
+        constexpr double MiB = 1024.0 * 1024.0;
+
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+        {
+            const auto &budget = budgets[i];
+            const bool deviceLocal = static_cast<bool>(memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+            ImGui::Text("Heap %u%s: %.1f / %.1f MiB used", i, deviceLocal ? " (device local)" : "", static_cast<double>(budget.usage) / MiB, static_cast<double>(budget.budget) / MiB);
+            ImGui::Text("    %u allocations in %u blocks, %.1f MiB allocated of %.1f MiB reserved", budget.statistics.allocationCount, budget.statistics.blockCount, static_cast<double>(budget.statistics.allocationBytes) / MiB, static_cast<double>(budget.statistics.blockBytes) / MiB);
+        }
+
+        ImGui::Separator();
+
+        ImGui::Text("Movable resources: %zu buffers, %zu images", MovableBuffers.size(), MovableImages.size());
+        if (IsRunning())
+        {
+            ImGui::Text("Defragmenting... pass %u", CurrentStatistics.Passes + 1);
+        }
+        else if (ImGui::Button("Defragment"))
+        {
+            Begin();
+        }
+
+        ImGui::Text("Last defragmentation: %u allocations moved (%.2f MiB) in %u passes", LastStatistics.AllocationsMoved, static_cast<double>(LastStatistics.BytesMoved) / MiB, LastStatistics.Passes);
+        ImGui::Text("Last reclaimed: %.2f MiB, %u blocks freed", static_cast<double>(LastStatistics.BytesFreed) / MiB, LastStatistics.DeviceMemoryBlocksFreed);
+        ImGui::Text("Total reclaimed: %.2f MiB", static_cast<double>(TotalBytesFreed) / MiB);
+    }
+} // Spinner
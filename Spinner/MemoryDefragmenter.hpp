@@ -0,0 +1,82 @@
+#ifndef SPINNER_MEMORYDEFRAGMENTER_HPP
+#define SPINNER_MEMORYDEFRAGMENTER_HPP
+
+#include <vulkan/vulkan.hpp>
+#include <vk_mem_alloc.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "CommandBuffer.hpp"
+
+namespace Spinner
+{
+    class Buffer;
+    class Image;
+
+    /// Incrementally defragments device memory with VMA, running at most one pass per frame.
+    /// Movable Buffers and Images keep their identity and swap their Vulkan handles in place, so anything holding their shared pointers does not need fixing up
+    class MemoryDefragmenter
+    {
+    public:
+        explicit MemoryDefragmenter(vma::Allocator allocator);
+        ~MemoryDefragmenter();
+
+        struct Statistics
+        {
+            vk::DeviceSize BytesMoved = 0;
+            vk::DeviceSize BytesFreed = 0;
+            uint32_t AllocationsMoved = 0;
+            uint32_t DeviceMemoryBlocksFreed = 0;
+            uint32_t Passes = 0;
+        };
+
+    protected:
+        vma::Allocator Allocator;
+        VmaDefragmentationContext Context = nullptr;
+        VmaDefragmentationPassMoveInfo PassInfo{};
+        bool PassActive = false;
+        uint64_t PassEpoch = 0;
+        // The pass's copies, submitted without waiting. Done by the time PassEpoch completes, as the frame is submitted after them
+        CommandBuffer::Pointer PassCommandBuffer;
+        vk::Fence PassFence = nullptr;
+
+        std::unordered_map<VmaAllocation, Buffer *> MovableBuffers;
+        std::unordered_map<VmaAllocation, Image *> MovableImages;
+        // Resources which have started moving during the active pass
+        std::vector<Buffer *> MovingBuffers;
+        std::vector<Image *> MovingImages;
+
+        Statistics CurrentStatistics{};
+        Statistics LastStatistics{};
+        vk::DeviceSize TotalBytesFreed = 0;
+
+    protected:
+        void BeginPass(uint64_t currentEpoch);
+        void EndPass();
+        void End();
+
+    public:
+        /// Starts a defragmentation, the moves happen over the following frames via Update
+        void Begin(vk::DeviceSize maxBytesPerPass = 64ull * 1024ull * 1024ull, uint32_t maxAllocationsPerPass = 64);
+        /// Runs or finishes a pass. Old resources are only destroyed after the GPU has completed the epoch the pass started in
+        void Update(uint64_t completedEpoch, uint64_t currentEpoch);
+        /// Finishes any active pass and ends defragmentation. The device must be idle
+        void Finish();
+        [[nodiscard]] bool IsRunning() const;
+
+        [[nodiscard]] const Statistics &GetLastStatistics() const;
+        [[nodiscard]] vk::DeviceSize GetTotalBytesFreed() const;
+
+        void RegisterBuffer(Buffer *buffer);
+        void UnregisterBuffer(Buffer *buffer);
+        void RegisterImage(Image *image);
+        void UnregisterImage(Image *image);
+
+        /// Returns true if the allocation is being moved by the active pass. VMA then frees it when the pass ends, so the caller must not
+        bool ReleaseMovingAllocation(VmaAllocation allocation);
+
+        void RenderDebugUI();
+    };
+} // Spinner
+
+#endif //SPINNER_MEMORYDEFRAGMENTER_HPP
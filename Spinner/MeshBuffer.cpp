@@ -2,22 +2,35 @@
 
 #include <utility>
 #include "Graphics.hpp"
+#include "VulkanUtilities.hpp"
 
 namespace Spinner
 {
-    MeshBuffer::MeshBuffer(void *vertexData, size_t vertexDataSize, MeshBuffer::IndexType *indices, uint32_t indexCount, std::vector<vk::VertexInputAttributeDescription2EXT> attributeDescriptions, vk::VertexInputBindingDescription2EXT bindingDescription) :
-            Buffer(vertexDataSize + (indexCount * sizeof(IndexType)), MeshBuffer::MeshBufferUsageFlags, vma::MemoryUsage::eGpuOnly, 0, false), VertexAttributeDescriptions(std::move(attributeDescriptions)), VertexBindingDescription(bindingDescription), IndexCount(indexCount)
+    static size_t GetIndexDataOffset(size_t vertexDataSize, vk::IndexType indexType)
     {
-        size_t indexSize = indexCount * sizeof(IndexType);
+        // Index buffer offsets must be a multiple of the index size
+        const size_t indexTypeSize = VkIndexTypeByteWidth(indexType);
+        return (vertexDataSize + indexTypeSize - 1) / indexTypeSize * indexTypeSize;
+    }
+
+    MeshBuffer::MeshBuffer(const void *vertexData, size_t vertexDataSize, const void *indices, uint32_t indexCount, vk::IndexType indexType, std::vector<vk::VertexInputAttributeDescription2EXT> attributeDescriptions, vk::VertexInputBindingDescription2EXT bindingDescription, const CommandBuffer::Pointer &commandBuffer) :
+            Buffer(GetIndexDataOffset(vertexDataSize, indexType) + (indexCount * VkIndexTypeByteWidth(indexType)), MeshBuffer::MeshBufferUsageFlags, vma::MemoryUsage::eGpuOnly, 0, false), VertexAttributeDescriptions(std::move(attributeDescriptions)), VertexBindingDescription(bindingDescription), IndexCount(indexCount), IndexBufferType(indexType)
+    {
+        size_t indexSize = indexCount * VkIndexTypeByteWidth(indexType);
 
+        Lods = {Lod{0, indexCount, 0.0f}};
         VertexDataOffset = 0;
-        IndexDataOffset = vertexDataSize;
+        IndexDataOffset = GetIndexDataOffset(vertexDataSize, indexType);
 
-        auto commandBuffer = Graphics::BeginSingleTimeCommands();
+        // Uploads are recorded into the given command buffer, otherwise they are submitted immediately
+        auto uploadCommandBuffer = (commandBuffer != nullptr) ? commandBuffer : Graphics::BeginSingleTimeCommands();
 
-        Write(vertexData, vertexDataSize, VertexDataOffset, commandBuffer);
-        Write(indices, indexSize, IndexDataOffset, commandBuffer);
+        Write(vertexData, vertexDataSize, VertexDataOffset, uploadCommandBuffer);
+        Write(indices, indexSize, IndexDataOffset, uploadCommandBuffer);
 
-        Graphics::EndSingleTimeCommands(commandBuffer);
+        if (commandBuffer == nullptr)
+        {
+            Graphics::EndSingleTimeCommands(uploadCommandBuffer);
+        }
     }
 } // Spinner
\ No newline at end of file
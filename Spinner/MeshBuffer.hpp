@@ -2,11 +2,10 @@
 #define SPINNER_MESHBUFFER_HPP
 
 #include "Buffer.hpp"
+#include "GLM.hpp"
 
 namespace Spinner
 {
-    class CommandBuffer;
-
     class MeshBuffer : public Buffer
     {
         friend class CommandBuffer;
@@ -14,18 +13,39 @@ namespace Spinner
     public:
         using Pointer = std::shared_ptr<MeshBuffer>;
         using IndexType = uint32_t;
+        using ShortIndexType = uint16_t;
+
+        /// Meshes with at most this many vertices store 16 bit indices, 0xFFFF is left free as it is the primitive restart index
+        static constexpr size_t MaxShortIndexVertexCount = 0xFFFF;
+
+        /// A range of the index buffer drawing the mesh at a level of detail, all levels share the vertex data
+        struct Lod
+        {
+            uint32_t FirstIndex = 0;
+            uint32_t IndexCount = 0;
+            // Largest distance from the full detail surface, in mesh space
+            float Error = 0.0f;
+        };
 
         static constexpr vk::BufferUsageFlags MeshBufferUsageFlags = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc;
 
-        MeshBuffer(void *vertexData, size_t vertexDataSize, IndexType *indices, uint32_t indexCount, std::vector<vk::VertexInputAttributeDescription2EXT> attributeDescriptions, vk::VertexInputBindingDescription2EXT bindingDescription);
+        MeshBuffer(const void *vertexData, size_t vertexDataSize, const void *indices, uint32_t indexCount, vk::IndexType indexType, std::vector<vk::VertexInputAttributeDescription2EXT> attributeDescriptions, vk::VertexInputBindingDescription2EXT bindingDescription, const CommandBuffer::Pointer &commandBuffer = nullptr);
         ~MeshBuffer() override = default;
 
     public:
         std::vector<vk::VertexInputAttributeDescription2EXT> VertexAttributeDescriptions;
         vk::VertexInputBindingDescription2EXT VertexBindingDescription;
         uint32_t IndexCount;
+        vk::IndexType IndexBufferType;
         size_t VertexDataOffset;
         size_t IndexDataOffset;
+        // Transform from quantized vertex positions back to mesh space, position = offset + quantized * scale
+        glm::vec4 PositionDequantizeOffset = {0.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec4 PositionDequantizeScale = {1.0f, 1.0f, 1.0f, 1.0f};
+        // Finest first, defaults to the whole index buffer
+        std::vector<Lod> Lods;
+        // Mesh space bounds used for LOD selection, xyz is the center and w the radius
+        glm::vec4 BoundingSphere = {0.0f, 0.0f, 0.0f, 0.0f};
     };
 
 } // Spinner
@@ -1,5 +1,7 @@
 #include "MeshBuilder.hpp"
 
+#include <algorithm>
+
 #include "VulkanUtilities.hpp"
 
 namespace Spinner
@@ -53,6 +55,7 @@ namespace Spinner
 
     MeshBuilder &MeshBuilder::SetIndices(MeshBuffer::IndexType *indices, uint32_t indexCount)
     {
+        ShortIndices.clear();
         if (indexCount != 0)
         {
             Indices = {&indices[0], &indices[indexCount]};
@@ -67,12 +70,58 @@ namespace Spinner
 
     MeshBuilder &MeshBuilder::SetIndices(const std::vector<MeshBuffer::IndexType> &indices)
     {
+        ShortIndices.clear();
         Indices = indices;
 
         return *this;
     }
 
-    MeshBuffer::Pointer MeshBuilder::Create()
+    MeshBuilder &MeshBuilder::SetIndices(MeshBuffer::ShortIndexType *indices, uint32_t indexCount)
+    {
+        Indices.clear();
+        if (indexCount != 0)
+        {
+            ShortIndices = {&indices[0], &indices[indexCount]};
+        }
+        else
+        {
+            ShortIndices.clear();
+        }
+
+        return *this;
+    }
+
+    MeshBuilder &MeshBuilder::SetIndices(const std::vector<MeshBuffer::ShortIndexType> &indices)
+    {
+        Indices.clear();
+        ShortIndices = indices;
+
+        return *this;
+    }
+
+    MeshBuilder &MeshBuilder::SetPositionDequantization(const glm::vec3 &offset, const glm::vec3 &scale)
+    {
+        PositionDequantizeOffset = glm::vec4(offset, 0.0f);
+        PositionDequantizeScale = glm::vec4(scale, 1.0f);
+
+        return *this;
+    }
+
+    MeshBuilder &MeshBuilder::SetLods(const std::vector<MeshBuffer::Lod> &lods)
+    {
+        Lods = lods;
+
+        return *this;
+    }
+
+    MeshBuilder &MeshBuilder::SetBoundingSphere(const glm::vec3 &center, float radius)
+    {
+        BoundingSphere = glm::vec4(center, radius);
+
+        return *this;
+    }
+
+    MeshBuffer::Pointer MeshBuilder::Create(const CommandBuffer::Pointer &commandBuffer)
     {
         std::vector<vk::VertexInputAttributeDescription2EXT> attributeDescriptions(Attributes.size(), vk::VertexInputAttributeDescription2EXT{});
         vk::VertexInputBindingDescription2EXT bindingDescription;
@@ -89,6 +138,46 @@ namespace Spinner
             attributeDescriptions[i].offset = Attributes[i].Offset;
         }
 
-        return std::make_shared<MeshBuffer>(VertexData.data(), VertexData.size(), Indices.data(), static_cast<uint32_t>(Indices.size()), attributeDescriptions, bindingDescription);
+        // Narrow 32 bit indices when every vertex can be addressed with 16 bits
+        const size_t vertexCount = (Stride != 0) ? VertexData.size() / Stride : 0;
+        if (!Indices.empty() && vertexCount <= MeshBuffer::MaxShortIndexVertexCount)
+        {
+            ShortIndices.resize(Indices.size());
+            std::transform(Indices.begin(), Indices.end(), ShortIndices.begin(), [](MeshBuffer::IndexType index) { return static_cast<MeshBuffer::ShortIndexType>(index); });
+            Indices.clear();
+        }
+
+        MeshBuffer::Pointer meshBuffer;
+        if (!ShortIndices.empty())
+        {
+            meshBuffer = std::make_shared<MeshBuffer>(VertexData.data(), VertexData.size(), ShortIndices.data(), static_cast<uint32_t>(ShortIndices.size()), vk::IndexType::eUint16, attributeDescriptions, bindingDescription, commandBuffer);
+        }
+        else
+        {
+            meshBuffer = std::make_shared<MeshBuffer>(VertexData.data(), VertexData.size(), Indices.data(), static_cast<uint32_t>(Indices.size()), vk::IndexType::eUint32, attributeDescriptions, bindingDescription, commandBuffer);
+        }
+        meshBuffer->PositionDequantizeOffset = PositionDequantizeOffset;
+        meshBuffer->PositionDequantizeScale = PositionDequantizeScale;
+        if (!Lods.empty())
+        {
+            meshBuffer->Lods = Lods;
+        }
+        meshBuffer->BoundingSphere = BoundingSphere;
+        return meshBuffer;
+    }
+
+    const std::vector<uint8_t> &MeshBuilder::GetVertexData() const
+    {
+        return VertexData;
+    }
+
+    const std::vector<MeshBuffer::IndexType> &MeshBuilder::GetIndices() const
+    {
+        return Indices;
+    }
+
+    const std::vector<MeshBuffer::ShortIndexType> &MeshBuilder::GetShortIndices() const
+    {
+        return ShortIndices;
     }
 } // Spinner
\ No newline at end of file
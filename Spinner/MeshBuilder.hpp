@@ -32,7 +32,31 @@ namespace Spinner
 
         constexpr static inline VertexAttribute CreateVec4(uint32_t location, uint32_t offset)
         {
-            return VertexAttribute{vk::Format::eR32Sfloat, location, offset};
+            return VertexAttribute{vk::Format::eR32G32B32A32Sfloat, location, offset};
+        }
+
+        /// Two half floats, e.g. texture coordinates
+        constexpr static inline VertexAttribute CreateHalfVec2(uint32_t location, uint32_t offset)
+        {
+            return VertexAttribute{vk::Format::eR16G16Sfloat, location, offset};
+        }
+
+        /// Two signed normalized shorts, e.g. an octahedral encoded direction
+        constexpr static inline VertexAttribute CreateOctahedral(uint32_t location, uint32_t offset)
+        {
+            return VertexAttribute{vk::Format::eR16G16Snorm, location, offset};
+        }
+
+        /// Four unsigned normalized shorts, e.g. a position quantized to the mesh bounds
+        constexpr static inline VertexAttribute CreateUnormShortVec4(uint32_t location, uint32_t offset)
+        {
+            return VertexAttribute{vk::Format::eR16G16B16A16Unorm, location, offset};
+        }
+
+        /// Four unsigned normalized bytes, e.g. a vertex color
+        constexpr static inline VertexAttribute CreateUnormByteVec4(uint32_t location, uint32_t offset)
+        {
+            return VertexAttribute{vk::Format::eR8G8B8A8Unorm, location, offset};
         }
 
         constexpr static inline VertexAttribute CreateUint(uint32_t location, uint32_t offset)
@@ -71,13 +95,33 @@ namespace Spinner
 
         MeshBuilder &SetIndices(MeshBuffer::IndexType *indices, uint32_t indexCount);
         MeshBuilder &SetIndices(const std::vector<MeshBuffer::IndexType> &indices);
-        MeshBuffer::Pointer Create();
+        MeshBuilder &SetIndices(MeshBuffer::ShortIndexType *indices, uint32_t indexCount);
+        MeshBuilder &SetIndices(const std::vector<MeshBuffer::ShortIndexType> &indices);
+        /// Sets the transform which the vertex shader applies to quantized positions
+        MeshBuilder &SetPositionDequantization(const glm::vec3 &offset, const glm::vec3 &scale);
+        /// Index ranges of each level of detail, finest first. Without any the whole index buffer is one level
+        MeshBuilder &SetLods(const std::vector<MeshBuffer::Lod> &lods);
+        MeshBuilder &SetBoundingSphere(const glm::vec3 &center, float radius);
+        /// Creates the mesh buffer, storing 16 bit indices when the vertex count allows it.
+        /// Uploads are recorded into commandBuffer if given, which must be submitted before the mesh buffer is used
+        MeshBuffer::Pointer Create(const CommandBuffer::Pointer &commandBuffer = nullptr);
+
+        [[nodiscard]] const std::vector<uint8_t> &GetVertexData() const;
+        /// After Create, only one of these holds the indices which were uploaded
+        [[nodiscard]] const std::vector<MeshBuffer::IndexType> &GetIndices() const;
+        [[nodiscard]] const std::vector<MeshBuffer::ShortIndexType> &GetShortIndices() const;
 
     protected:
         std::vector<VertexAttribute> Attributes;
         std::vector<uint8_t> VertexData;
+        // Only one of Indices or ShortIndices is used at a time
         std::vector<MeshBuffer::IndexType> Indices;
+        std::vector<MeshBuffer::ShortIndexType> ShortIndices;
         uint32_t Stride;
+        glm::vec4 PositionDequantizeOffset = {0.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec4 PositionDequantizeScale = {1.0f, 1.0f, 1.0f, 1.0f};
+        std::vector<MeshBuffer::Lod> Lods;
+        glm::vec4 BoundingSphere = {0.0f, 0.0f, 0.0f, 0.0f};
     };
 
 } // Spinner
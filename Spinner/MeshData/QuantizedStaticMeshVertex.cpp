@@ -0,0 +1,170 @@
+#include "QuantizedStaticMeshVertex.hpp"
+
+#include <cstring>
+
+#include "../Lighting.hpp"
+#include "../Scene.hpp"
+
+namespace Spinner::MeshData
+{
+    ShaderGroup::Pointer QuantizedStaticMeshVertex::ShaderGroup;
+    ShaderGroup::Pointer QuantizedStaticMeshVertex::ShadowShaderGroup;
+
+    std::vector<VertexAttribute> QuantizedStaticMeshVertex::GetVertexAttributes(bool quantizePositions)
+    {
+        const uint32_t positionSize = quantizePositions ? 8 : 12;
+
+        return std::vector<VertexAttribute>{
+            quantizePositions ? VertexAttribute::CreateUnormShortVec4(VertexAttribute::AutoLocation, 0) : VertexAttribute::CreateVec3(VertexAttribute::AutoLocation, 0), // Position
+            VertexAttribute::CreateOctahedral(VertexAttribute::AutoLocation, positionSize), // Normal
+            VertexAttribute::CreateOctahedral(VertexAttribute::AutoLocation, positionSize + 4), // Tangent
+            VertexAttribute::CreateUnormByteVec4(VertexAttribute::AutoLocation, positionSize + 8), // Color + tangent handedness
+            VertexAttribute::CreateHalfVec2(VertexAttribute::AutoLocation, positionSize + 12), // UV
+        };
+    }
+
+    size_t QuantizedStaticMeshVertex::GetStride(bool quantizePositions)
+    {
+        return quantizePositions ? 24 : 28;
+    }
+
+    MeshBuilder QuantizedStaticMeshVertex::CreateMeshBuilder(bool quantizePositions)
+    {
+        return MeshBuilder(GetVertexAttributes(quantizePositions), GetStride(quantizePositions));
+    }
+
+    MeshBuilder QuantizedStaticMeshVertex::CreateMeshBuilder(const std::vector<StaticMeshVertex> &vertices, bool quantizePositions)
+    {
+        const auto attributes = GetVertexAttributes(quantizePositions);
+        const size_t stride = GetStride(quantizePositions);
+
+        // Positions are stored relative to the mesh bounds
+        glm::vec3 boundsMin(0.0f);
+        glm::vec3 boundsScale(1.0f);
+        if (quantizePositions && !vertices.empty())
+        {
+            boundsMin = vertices[0].Position;
+            glm::vec3 boundsMax = vertices[0].Position;
+            for (const auto &vertex : vertices)
+            {
+                boundsMin = glm::min(boundsMin, vertex.Position);
+                boundsMax = glm::max(boundsMax, vertex.Position);
+            }
+
+            boundsScale = boundsMax - boundsMin;
+            for (glm::length_t i = 0; i < 3; i++)
+            {
+                if (boundsScale[i] <= 0.0f)
+                {
+                    boundsScale[i] = 1.0f;
+                }
+            }
+        }
+
+        std::vector<uint8_t> vertexData(vertices.size() * stride);
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const auto &vertex = vertices[i];
+            uint8_t *destination = &vertexData[i * stride];
+
+            if (quantizePositions)
+            {
+                const uint64_t position = glm::packUnorm4x16(glm::vec4((vertex.Position - boundsMin) / boundsScale, 1.0f));
+                std::memcpy(destination + attributes[0].Offset, &position, sizeof(position));
+            }
+            else
+            {
+                std::memcpy(destination + attributes[0].Offset, &vertex.Position, sizeof(vertex.Position));
+            }
+
+            const uint32_t normal = glm::packSnorm2x16(EncodeOctahedral(vertex.Normal));
+            const uint32_t tangent = glm::packSnorm2x16(EncodeOctahedral(glm::vec3(vertex.Tangent)));
+            const uint32_t color = glm::packUnorm4x8(glm::vec4(vertex.Color, vertex.Tangent.w < 0.0f ? 0.0f : 1.0f));
+            const uint32_t uv = glm::packHalf2x16(vertex.UV);
+
+            std::memcpy(destination + attributes[1].Offset, &normal, sizeof(normal));
+            std::memcpy(destination + attributes[2].Offset, &tangent, sizeof(tangent));
+            std::memcpy(destination + attributes[3].Offset, &color, sizeof(color));
+            std::memcpy(destination + attributes[4].Offset, &uv, sizeof(uv));
+        }
+
+        auto builder = CreateMeshBuilder(quantizePositions);
+        builder.SetVertexData(vertexData).SetPositionDequantization(boundsMin, boundsScale);
+        return builder;
+    }
+
+    void QuantizedStaticMeshVertex::CreateShaders()
+    {
+        // Descriptor Set Layout and push constants
+        auto descriptorSetLayout = DescriptorSetLayout::CreateDescriptorSetLayout(StaticMeshVertex::GetDescriptorSetLayoutBindings(), {});
+
+        // Scene
+        auto sceneDescriptorSetLayout = DescriptorSetLayout::CreateDescriptorSetLayout(Spinner::Scene::GetDescriptorSetLayoutBindings(), {});
+
+        // Lighting
+        auto lightingDescriptorSetLayout = DescriptorSetLayout::CreateDescriptorSetLayout(Lighting::GetDescriptorSetLayoutBindings(), {}, Lighting::GetDescriptorBindingFlags());
+
+        // Shader creation
+        ShaderCreateInfo vertexShaderCreateInfo;
+        vertexShaderCreateInfo.ShaderStage = vk::ShaderStageFlagBits::eVertex;
+        vertexShaderCreateInfo.ShaderName = "staticmeshquantized";
+        vertexShaderCreateInfo.NextStage = vk::ShaderStageFlagBits::eFragment;
+        vertexShaderCreateInfo.DescriptorSetLayouts = {descriptorSetLayout};
+        vertexShaderCreateInfo.SceneDescriptorSetLayout = sceneDescriptorSetLayout;
+        vertexShaderCreateInfo.LightingDescriptorSetLayout = lightingDescriptorSetLayout;
+
+        ShaderCreateInfo fragmentShaderCreateInfo;
+        fragmentShaderCreateInfo.ShaderStage = vk::ShaderStageFlagBits::eFragment;
+        fragmentShaderCreateInfo.ShaderName = "staticmesh";
+        fragmentShaderCreateInfo.NextStage = {};
+        fragmentShaderCreateInfo.DescriptorSetLayouts = {descriptorSetLayout};
+        fragmentShaderCreateInfo.SceneDescriptorSetLayout = sceneDescriptorSetLayout;
+        fragmentShaderCreateInfo.LightingDescriptorSetLayout = lightingDescriptorSetLayout;
+        fragmentShaderCreateInfo.UpdateDrawComponentCallback = StaticMeshVertex::UpdateDrawComponentCallback;
+
+        ShaderGroup = ShaderGroup::CreateShaderGroup({vertexShaderCreateInfo, fragmentShaderCreateInfo});
+
+        ShaderCreateInfo shadowVertexShaderCreateInfo;
+        shadowVertexShaderCreateInfo.ShaderStage = vk::ShaderStageFlagBits::eVertex;
+        shadowVertexShaderCreateInfo.ShaderName = "staticshadowquantized";
+        shadowVertexShaderCreateInfo.NextStage = vk::ShaderStageFlagBits::eFragment;
+        shadowVertexShaderCreateInfo.DescriptorSetLayouts = {descriptorSetLayout};
+        shadowVertexShaderCreateInfo.SceneDescriptorSetLayout = sceneDescriptorSetLayout;
+        shadowVertexShaderCreateInfo.LightingDescriptorSetLayout = nullptr;
+
+        ShaderCreateInfo shadowFragmentShaderCreateInfo;
+        shadowFragmentShaderCreateInfo.ShaderStage = vk::ShaderStageFlagBits::eFragment;
+        shadowFragmentShaderCreateInfo.ShaderName = "staticshadow";
+        shadowFragmentShaderCreateInfo.NextStage = {};
+        shadowFragmentShaderCreateInfo.DescriptorSetLayouts = {descriptorSetLayout};
+        shadowFragmentShaderCreateInfo.SceneDescriptorSetLayout = sceneDescriptorSetLayout;
+        shadowFragmentShaderCreateInfo.LightingDescriptorSetLayout = nullptr;
+        shadowFragmentShaderCreateInfo.UpdateDrawComponentCallback = StaticMeshVertex::UpdateDrawComponentCallback;
+
+        ShadowShaderGroup = ShaderGroup::CreateShaderGroup({shadowVertexShaderCreateInfo, shadowFragmentShaderCreateInfo});
+    }
+
+    void QuantizedStaticMeshVertex::DestroyShaders()
+    {
+        ShaderGroup.reset();
+        ShadowShaderGroup.reset();
+    }
+
+    glm::vec2 QuantizedStaticMeshVertex::EncodeOctahedral(glm::vec3 direction)
+    {
+        const float length = glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z);
+        if (length <= 0.0f)
+        {
+            return {0.0f, 0.0f};
+        }
+        direction /= length;
+
+        glm::vec2 encoded(direction.x, direction.y);
+        if (direction.z < 0.0f)
+        {
+            const glm::vec2 signs(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+            encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * signs;
+        }
+        return encoded;
+    }
+} // Spinner
@@ -0,0 +1,34 @@
+#ifndef SPINNER_QUANTIZEDSTATICMESHVERTEX_HPP
+#define SPINNER_QUANTIZEDSTATICMESHVERTEX_HPP
+
+#include "StaticMeshVertex.hpp"
+
+namespace Spinner::MeshData
+{
+    /// Compact alternative to StaticMeshVertex, 24 bytes with quantized positions or 28 bytes with full precision positions.
+    /// Position: R16G16B16A16Unorm relative to the mesh bounds (dequantized with MeshBuffer::PositionDequantizeOffset/Scale), or R32G32B32Sfloat
+    /// Normal & Tangent: octahedral encoded R16G16Snorm
+    /// Color: R8G8B8A8Unorm, tangent handedness stored in alpha
+    /// UV: R16G16Sfloat
+    struct QuantizedStaticMeshVertex
+    {
+        // Vertex & shader descriptions
+        static std::vector<VertexAttribute> GetVertexAttributes(bool quantizePositions);
+        static size_t GetStride(bool quantizePositions);
+        static MeshBuilder CreateMeshBuilder(bool quantizePositions);
+
+        /// Encodes full precision vertices into the compact layout, indices are still to be set
+        static MeshBuilder CreateMeshBuilder(const std::vector<StaticMeshVertex> &vertices, bool quantizePositions = true);
+
+        // Shaders, the fragment stages are shared with StaticMeshVertex
+        static Spinner::ShaderGroup::Pointer ShaderGroup;
+        static Spinner::ShaderGroup::Pointer ShadowShaderGroup;
+        static void CreateShaders();
+        static void DestroyShaders();
+
+        /// Maps a unit direction onto the [-1, 1] square by projecting onto an octahedron and folding the lower half over
+        static glm::vec2 EncodeOctahedral(glm::vec3 direction);
+    };
+} // Spinner
+
+#endif //SPINNER_QUANTIZEDSTATICMESHVERTEX_HPP
@@ -0,0 +1,879 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace Spinner
+{
+    /// Post-transform vertex cache simulation, a vertex is a hit if it was added within the last Size misses
+    class FifoVertexCache
+    {
+    public:
+        FifoVertexCache(size_t vertexCount, uint32_t cacheSize) : Timestamps(vertexCount, 0), Size(cacheSize), Time(cacheSize + 1)
+        {
+        }
+
+        /// Returns true on a cache miss
+        inline bool Access(MeshOptimizer::IndexType vertex)
+        {
+            if (Time - Timestamps[vertex] <= Size)
+            {
+                return false;
+            }
+
+            Timestamps[vertex] = Time++;
+            return true;
+        }
+
+        inline uint32_t AccessTriangle(const MeshOptimizer::IndexType *triangle)
+        {
+            return static_cast<uint32_t>(Access(triangle[0])) + static_cast<uint32_t>(Access(triangle[1])) + static_cast<uint32_t>(Access(triangle[2]));
+        }
+
+        inline void Reset()
+        {
+            Time += Size + 1;
+        }
+
+    protected:
+        std::vector<uint64_t> Timestamps;
+        uint64_t Size;
+        uint64_t Time;
+    };
+
+    float MeshOptimizer::Statistics::GetACMR() const
+    {
+        return TriangleCount != 0 ? static_cast<float>(VertexShaderInvocations) / static_cast<float>(TriangleCount) : 0.0f;
+    }
+
+    float MeshOptimizer::Statistics::GetATVR() const
+    {
+        return VertexCount != 0 ? static_cast<float>(VertexShaderInvocations) / static_cast<float>(VertexCount) : 0.0f;
+    }
+
+    float MeshOptimizer::Statistics::GetOverdraw() const
+    {
+        return PixelsCovered != 0 ? static_cast<float>(PixelsShaded) / static_cast<float>(PixelsCovered) : 0.0f;
+    }
+
+    MeshOptimizer::Statistics &MeshOptimizer::Statistics::operator+=(const MeshOptimizer::Statistics &other)
+    {
+        VertexCount += other.VertexCount;
+        TriangleCount += other.TriangleCount;
+        VertexShaderInvocations += other.VertexShaderInvocations;
+        PixelsShaded += other.PixelsShaded;
+        PixelsCovered += other.PixelsCovered;
+        return *this;
+    }
+
+    std::vector<MeshOptimizer::IndexType> MeshOptimizer::GenerateVertexRemap(const void *vertices, size_t vertexCount, size_t vertexSize, const std::vector<IndexType> &indices, size_t &uniqueVertexCount)
+    {
+        const auto vertexBytes = reinterpret_cast<const char *>(vertices);
+
+        std::vector<IndexType> remap(vertexCount, UnusedVertex);
+        std::unordered_map<std::string_view, IndexType> uniqueVertices;
+        uniqueVertices.reserve(vertexCount);
+
+        uniqueVertexCount = 0;
+        for (auto index : indices)
+        {
+            if (index >= vertexCount)
+            {
+                throw std::runtime_error("Cannot optimize mesh with an index outside of its vertices");
+            }
+            if (remap[index] != UnusedVertex)
+            {
+                continue;
+            }
+
+            auto [uniqueVertex, inserted] = uniqueVertices.try_emplace(std::string_view(&vertexBytes[index * vertexSize], vertexSize), static_cast<IndexType>(uniqueVertexCount));
+            if (inserted)
+            {
+                uniqueVertexCount++;
+            }
+            remap[index] = uniqueVertex->second;
+        }
+
+        return remap;
+    }
+
+    std::vector<MeshOptimizer::IndexType> MeshOptimizer::GenerateVertexFetchRemap(const std::vector<IndexType> &indices, size_t vertexCount, size_t &referencedVertexCount)
+    {
+        std::vector<IndexType> remap(vertexCount, UnusedVertex);
+
+        referencedVertexCount = 0;
+        for (auto index : indices)
+        {
+            if (remap[index] == UnusedVertex)
+            {
+                remap[index] = static_cast<IndexType>(referencedVertexCount++);
+            }
+        }
+
+        return remap;
+    }
+
+    void MeshOptimizer::RemapIndices(std::vector<IndexType> &indices, const std::vector<IndexType> &remap)
+    {
+        for (auto &index : indices)
+        {
+            index = remap[index];
+        }
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(std::vector<IndexType> &indices, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t> *hardClusters)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (hardClusters != nullptr)
+        {
+            hardClusters->assign(1, 0);
+        }
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        // Vertex to triangle adjacency
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (auto index : indices)
+        {
+            liveTriangles[index]++;
+        }
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+        }
+
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        std::vector<int64_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<IndexType> deadEnd;
+        deadEnd.reserve(indices.size());
+        std::vector<IndexType> candidates;
+        std::vector<IndexType> output;
+        output.reserve(indices.size());
+
+        int64_t time = static_cast<int64_t>(cacheSize) + 1;
+        size_t cursor = 0;
+        int64_t fanningVertex = 0;
+
+        while (fanningVertex >= 0)
+        {
+            // Emit every remaining triangle around the fanning vertex
+            candidates.clear();
+            for (uint32_t i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++)
+            {
+                const uint32_t triangle = adjacency[i];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const IndexType vertex = indices[triangle * 3 + k];
+                    output.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+
+                    if (time - cacheTime[vertex] > static_cast<int64_t>(cacheSize))
+                    {
+                        cacheTime[vertex] = time++;
+                    }
+                }
+                emitted[triangle] = true;
+            }
+
+            // Prefer the oldest candidate which will still be in the cache after its own fan is emitted
+            int64_t nextVertex = -1;
+            int64_t bestPriority = -1;
+            for (auto vertex : candidates)
+            {
+                if (liveTriangles[vertex] == 0)
+                {
+                    continue;
+                }
+
+                int64_t priority = 0;
+                if (time - cacheTime[vertex] + 2 * static_cast<int64_t>(liveTriangles[vertex]) <= static_cast<int64_t>(cacheSize))
+                {
+                    priority = time - cacheTime[vertex];
+                }
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            // Dead end, go back through recently emitted vertices
+            while (nextVertex < 0 && !deadEnd.empty())
+            {
+                const IndexType vertex = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[vertex] > 0)
+                {
+                    nextVertex = vertex;
+                }
+            }
+
+            // Otherwise continue with the next vertex which has triangles left, the cache is cold again
+            if (nextVertex < 0)
+            {
+                while (cursor < vertexCount && liveTriangles[cursor] == 0)
+                {
+                    cursor++;
+                }
+                if (cursor < vertexCount)
+                {
+                    nextVertex = static_cast<int64_t>(cursor);
+
+                    const auto clusterStart = static_cast<uint32_t>(output.size() / 3);
+                    if (hardClusters != nullptr && clusterStart > hardClusters->back())
+                    {
+                        hardClusters->push_back(clusterStart);
+                    }
+                }
+            }
+
+            fanningVertex = nextVertex;
+        }
+
+        indices = std::move(output);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(std::vector<IndexType> &indices, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &hardClusters, uint32_t cacheSize, float threshold)
+    {
+        const auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        // Split each hard cluster wherever the running ACMR is within the threshold of the whole cluster
+        std::vector<uint32_t> clusters;
+        FifoVertexCache cache(positions.size(), cacheSize);
+        for (size_t c = 0; c < std::max<size_t>(hardClusters.size(), 1); c++)
+        {
+            const uint32_t start = hardClusters.empty() ? 0 : hardClusters[c];
+            const uint32_t end = (c + 1 < hardClusters.size()) ? hardClusters[c + 1] : triangleCount;
+
+            cache.Reset();
+            uint32_t hardClusterMisses = 0;
+            for (uint32_t t = start; t < end; t++)
+            {
+                hardClusterMisses += cache.AccessTriangle(&indices[t * 3]);
+            }
+            const float clusterThreshold = threshold * static_cast<float>(hardClusterMisses) / static_cast<float>(end - start);
+
+            cache.Reset();
+            clusters.push_back(start);
+            uint32_t clusterStart = start;
+            uint32_t clusterMisses = 0;
+            for (uint32_t t = start; t < end; t++)
+            {
+                clusterMisses += cache.AccessTriangle(&indices[t * 3]);
+
+                if (t + 1 < end && static_cast<float>(clusterMisses) <= clusterThreshold * static_cast<float>(t + 1 - clusterStart))
+                {
+                    clusterStart = t + 1;
+                    clusterMisses = 0;
+                    clusters.push_back(clusterStart);
+                    cache.Reset();
+                }
+            }
+        }
+
+        // Area weighted centroid and average normal of each cluster
+        std::vector<glm::vec3> clusterCentroids(clusters.size(), glm::vec3(0.0f));
+        std::vector<glm::vec3> clusterNormals(clusters.size(), glm::vec3(0.0f));
+        std::vector<float> clusterAreas(clusters.size(), 0.0f);
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            const uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+            for (uint32_t t = clusters[c]; t < end; t++)
+            {
+                const auto &p0 = positions[indices[t * 3 + 0]];
+                const auto &p1 = positions[indices[t * 3 + 1]];
+                const auto &p2 = positions[indices[t * 3 + 2]];
+
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+                const glm::vec3 centre = (p0 + p1 + p2) / 3.0f;
+
+                clusterCentroids[c] += centre * area;
+                clusterNormals[c] += normal;
+                clusterAreas[c] += area;
+            }
+
+            meshCentroid += clusterCentroids[c];
+            meshArea += clusterAreas[c];
+        }
+        if (meshArea > 0.0f)
+        {
+            meshCentroid /= meshArea;
+        }
+
+        // Clusters facing away from the centre of the mesh are likely to occlude the rest, so draw them first
+        std::vector<float> clusterSortKeys(clusters.size(), 0.0f);
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            const float normalLength = glm::length(clusterNormals[c]);
+            if (clusterAreas[c] <= 0.0f || normalLength <= 0.0f)
+            {
+                continue;
+            }
+            clusterSortKeys[c] = glm::dot(clusterCentroids[c] / clusterAreas[c] - meshCentroid, clusterNormals[c] / normalLength);
+        }
+
+        std::vector<size_t> clusterOrder(clusters.size());
+        std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](size_t a, size_t b) { return clusterSortKeys[a] > clusterSortKeys[b]; });
+
+        std::vector<IndexType> output;
+        output.reserve(indices.size());
+        for (auto c : clusterOrder)
+        {
+            const uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+            output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+        }
+        indices = std::move(output);
+    }
+
+    static void RasterizeOverdraw(const std::vector<MeshOptimizer::IndexType> &indices, const std::vector<glm::vec3> &positions, MeshOptimizer::Statistics &statistics)
+    {
+        if (positions.empty())
+        {
+            return;
+        }
+
+        constexpr uint32_t GridSize = MeshOptimizer::OverdrawGridSize;
+        constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+        // Uniformly scale the mesh into the unit cube
+        glm::vec3 boundsMin = positions[0];
+        glm::vec3 boundsMax = positions[0];
+        for (const auto &position : positions)
+        {
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+        float extent = std::max(boundsMax.x - boundsMin.x, std::max(boundsMax.y - boundsMin.y, boundsMax.z - boundsMin.z));
+        if (extent <= 0.0f)
+        {
+            extent = 1.0f;
+        }
+
+        std::vector<float> depthBuffer(GridSize * GridSize);
+
+        // Orthographic views from both sides of each axis, only front faces are drawn
+        for (glm::length_t axis = 0; axis < 3; axis++)
+        {
+            for (int side = 0; side < 2; side++)
+            {
+                std::fill(depthBuffer.begin(), depthBuffer.end(), Infinity);
+
+                for (size_t t = 0; t + 2 < indices.size(); t += 3)
+                {
+                    glm::vec3 screen[3];
+                    for (size_t k = 0; k < 3; k++)
+                    {
+                        const glm::vec3 normalized = (positions[indices[t + k]] - boundsMin) / extent;
+                        const float u = normalized[(axis + 1) % 3];
+                        const float v = normalized[(axis + 2) % 3];
+                        const float depth = normalized[axis];
+
+                        // The opposite side is mirrored so front faces keep a positive area
+                        screen[k] = (side == 0) ? glm::vec3(u * GridSize, v * GridSize, -depth) : glm::vec3((1.0f - u) * GridSize, v * GridSize, depth);
+                    }
+
+                    const auto edge = [](const glm::vec3 &a, const glm::vec3 &b, float x, float y) { return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x); };
+
+                    const float area = edge(screen[0], screen[1], screen[2].x, screen[2].y);
+                    if (area <= 0.0f)
+                    {
+                        continue;
+                    }
+
+                    const auto minX = static_cast<int32_t>(std::max(0.0f, std::floor(std::min(screen[0].x, std::min(screen[1].x, screen[2].x)))));
+                    const auto minY = static_cast<int32_t>(std::max(0.0f, std::floor(std::min(screen[0].y, std::min(screen[1].y, screen[2].y)))));
+                    const auto maxX = static_cast<int32_t>(std::min(static_cast<float>(GridSize - 1), std::ceil(std::max(screen[0].x, std::max(screen[1].x, screen[2].x)))));
+                    const auto maxY = static_cast<int32_t>(std::min(static_cast<float>(GridSize - 1), std::ceil(std::max(screen[0].y, std::max(screen[1].y, screen[2].y)))));
+
+                    for (int32_t y = minY; y <= maxY; y++)
+                    {
+                        for (int32_t x = minX; x <= maxX; x++)
+                        {
+                            const float px = static_cast<float>(x) + 0.5f;
+                            const float py = static_cast<float>(y) + 0.5f;
+
+                            const float w0 = edge(screen[1], screen[2], px, py);
+                            const float w1 = edge(screen[2], screen[0], px, py);
+                            const float w2 = edge(screen[0], screen[1], px, py);
+                            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                            {
+                                continue;
+                            }
+
+                            const float depth = (w0 * screen[0].z + w1 * screen[1].z + w2 * screen[2].z) / area;
+                            float &storedDepth = depthBuffer[y * GridSize + x];
+                            if (depth <= storedDepth)
+                            {
+                                if (storedDepth == Infinity)
+                                {
+                                    statistics.PixelsCovered++;
+                                }
+                                storedDepth = depth;
+                                statistics.PixelsShaded++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    MeshOptimizer::Statistics MeshOptimizer::AnalyzeMesh(const std::vector<IndexType> &indices, const std::vector<glm::vec3> &positions, uint32_t cacheSize)
+    {
+        Statistics statistics{};
+        statistics.VertexCount = positions.size();
+        statistics.TriangleCount = indices.size() / 3;
+
+        FifoVertexCache cache(positions.size(), cacheSize);
+        for (size_t t = 0; t < statistics.TriangleCount; t++)
+        {
+            statistics.VertexShaderInvocations += cache.AccessTriangle(&indices[t * 3]);
+        }
+
+        RasterizeOverdraw(indices, positions, statistics);
+
+        return statistics;
+    }
+
+    /// Summed squared distance to a set of weighted planes, as a symmetric 4x4 matrix
+    struct Quadric
+    {
+        double A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+        double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+        double C = 0.0;
+        double Weight = 0.0;
+
+        /// Plane through point with the given unit normal
+        static Quadric FromPlane(const glm::vec3 &normal, const glm::vec3 &point, double weight)
+        {
+            const double nx = normal.x, ny = normal.y, nz = normal.z;
+            const double d = -(nx * point.x + ny * point.y + nz * point.z);
+
+            Quadric quadric;
+            quadric.A00 = weight * nx * nx;
+            quadric.A01 = weight * nx * ny;
+            quadric.A02 = weight * nx * nz;
+            quadric.A11 = weight * ny * ny;
+            quadric.A12 = weight * ny * nz;
+            quadric.A22 = weight * nz * nz;
+            quadric.B0 = weight * nx * d;
+            quadric.B1 = weight * ny * d;
+            quadric.B2 = weight * nz * d;
+            quadric.C = weight * d * d;
+            quadric.Weight = weight;
+            return quadric;
+        }
+
+        Quadric &operator+=(const Quadric &other)
+        {
+            A00 += other.A00;
+            A01 += other.A01;
+            A02 += other.A02;
+            A11 += other.A11;
+            A12 += other.A12;
+            A22 += other.A22;
+            B0 += other.B0;
+            B1 += other.B1;
+            B2 += other.B2;
+            C += other.C;
+            Weight += other.Weight;
+            return *this;
+        }
+
+        /// Weighted mean squared distance of point to the planes
+        [[nodiscard]] double Evaluate(const glm::vec3 &point) const
+        {
+            const double x = point.x, y = point.y, z = point.z;
+            const double error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) + 2.0 * (B0 * x + B1 * y + B2 * z) + C;
+            return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+        }
+    };
+
+    static inline uint64_t GetEdgeKey(MeshOptimizer::IndexType a, MeshOptimizer::IndexType b)
+    {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    }
+
+    std::vector<MeshOptimizer::IndexType> MeshOptimizer::Simplify(const std::vector<IndexType> &indices, const std::vector<glm::vec3> &positions, size_t targetIndexCount, float targetError, float *resultError)
+    {
+        // Multiplier of the border planes, which keep open borders from shrinking
+        constexpr double BorderWeight = 10.0;
+        constexpr uint32_t MaxPasses = 100;
+
+        std::vector<IndexType> result = indices;
+        float error = 0.0f;
+        const size_t vertexCount = positions.size();
+        if (result.size() <= targetIndexCount || result.size() % 3 != 0 || vertexCount == 0)
+        {
+            if (resultError != nullptr)
+            {
+                *resultError = error;
+            }
+            return result;
+        }
+
+        // Work in the unit cube so the error is relative to the mesh's extent
+        glm::vec3 boundsMin = positions[0];
+        glm::vec3 boundsMax = positions[0];
+        for (const auto &position : positions)
+        {
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+        const glm::vec3 boundsSize = boundsMax - boundsMin;
+        const float extent = std::max(boundsSize.x, std::max(boundsSize.y, boundsSize.z));
+        const float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+        std::vector<glm::vec3> scaled(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            scaled[i] = (positions[i] - boundsMin) * scale;
+        }
+
+        // Vertices which only differ in other attributes (e.g. a UV seam) share a position, collapses move positions.
+        // positionOf maps each vertex to the first vertex with the same position
+        std::vector<IndexType> sortedVertices(vertexCount);
+        std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+        const auto lessPosition = [&positions](IndexType a, IndexType b)
+        {
+            const auto &pa = positions[a];
+            const auto &pb = positions[b];
+            return pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : (pa.z != pb.z ? pa.z < pb.z : a < b));
+        };
+        std::sort(sortedVertices.begin(), sortedVertices.end(), lessPosition);
+
+        std::vector<IndexType> positionOf(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const auto vertex = sortedVertices[i];
+            const bool samePosition = i > 0 && positions[sortedVertices[i - 1]].x == positions[vertex].x && positions[sortedVertices[i - 1]].y == positions[vertex].y && positions[sortedVertices[i - 1]].z == positions[vertex].z;
+            positionOf[vertex] = samePosition ? positionOf[sortedVertices[i - 1]] : vertex;
+        }
+
+        // Edge usage, an edge used by one triangle is an open border and by more than two is non-manifold
+        std::unordered_map<uint64_t, uint32_t> edgeTriangleCounts;
+        edgeTriangleCounts.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                const auto a = positionOf[result[i + e]];
+                const auto b = positionOf[result[i + (e + 1) % 3]];
+                if (a != b)
+                {
+                    edgeTriangleCounts[GetEdgeKey(a, b)]++;
+                }
+            }
+        }
+
+        enum class VertexKind : uint8_t
+        {
+            Manifold,
+            Border, // Only moves along its border edges
+            Locked, // Never moves
+        };
+        std::vector<VertexKind> kinds(vertexCount, VertexKind::Manifold);
+        for (const auto &[key, count] : edgeTriangleCounts)
+        {
+            const auto a = static_cast<IndexType>(key >> 32);
+            const auto b = static_cast<IndexType>(key & 0xFFFF'FFFF);
+            if (count > 2)
+            {
+                kinds[a] = VertexKind::Locked;
+                kinds[b] = VertexKind::Locked;
+            }
+            else if (count == 1)
+            {
+                kinds[a] = (kinds[a] == VertexKind::Locked) ? VertexKind::Locked : VertexKind::Border;
+                kinds[b] = (kinds[b] == VertexKind::Locked) ? VertexKind::Locked : VertexKind::Border;
+            }
+        }
+
+        // Plane quadrics of every triangle, plus planes perpendicular to open borders
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const IndexType triangle[3] = {positionOf[result[i]], positionOf[result[i + 1]], positionOf[result[i + 2]]};
+            const glm::vec3 normal = glm::cross(scaled[triangle[1]] - scaled[triangle[0]], scaled[triangle[2]] - scaled[triangle[0]]);
+            const float normalLength = glm::length(normal);
+            if (normalLength == 0.0f)
+            {
+                continue;
+            }
+            const glm::vec3 unitNormal = normal / normalLength;
+            const auto area = static_cast<double>(normalLength) * 0.5;
+
+            const auto plane = Quadric::FromPlane(unitNormal, scaled[triangle[0]], area);
+            for (auto position : triangle)
+            {
+                quadrics[position] += plane;
+            }
+
+            for (int e = 0; e < 3; e++)
+            {
+                const auto a = triangle[e];
+                const auto b = triangle[(e + 1) % 3];
+                if (a == b || edgeTriangleCounts[GetEdgeKey(a, b)] != 1)
+                {
+                    continue;
+                }
+
+                const glm::vec3 edge = scaled[b] - scaled[a];
+                const glm::vec3 borderNormal = glm::cross(edge, unitNormal);
+                const float borderNormalLength = glm::length(borderNormal);
+                if (borderNormalLength == 0.0f)
+                {
+                    continue;
+                }
+
+                const auto borderPlane = Quadric::FromPlane(borderNormal / borderNormalLength, scaled[a], static_cast<double>(glm::dot(edge, edge)) * BorderWeight);
+                quadrics[a] += borderPlane;
+                quadrics[b] += borderPlane;
+            }
+        }
+
+        struct Collapse
+        {
+            IndexType From; // Position which moves
+            IndexType To;
+            double Error;
+        };
+
+        std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+        std::vector<uint32_t> positionTriangles;
+        std::vector<Collapse> collapses;
+        std::vector<uint64_t> edges;
+        std::vector<uint8_t> locked(vertexCount);
+        std::vector<IndexType> vertexRemap(vertexCount);
+        std::vector<std::pair<IndexType, IndexType>> wedgeTargets;
+
+        for (uint32_t pass = 0; pass < MaxPasses && result.size() > targetIndexCount; pass++)
+        {
+            const size_t triangleCount = result.size() / 3;
+
+            // Triangles around each position
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (auto index : result)
+            {
+                triangleOffsets[positionOf[index] + 1]++;
+            }
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                triangleOffsets[i + 1] += triangleOffsets[i];
+            }
+            positionTriangles.resize(result.size());
+            {
+                std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+                for (size_t i = 0; i < result.size(); i++)
+                {
+                    positionTriangles[fill[positionOf[result[i]]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            // Cheapest valid direction of every edge
+            edges.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int e = 0; e < 3; e++)
+                {
+                    const auto a = positionOf[result[i + e]];
+                    const auto b = positionOf[result[i + (e + 1) % 3]];
+                    if (a != b)
+                    {
+                        edges.push_back(GetEdgeKey(a, b));
+                    }
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            collapses.clear();
+            for (auto key : edges)
+            {
+                const auto a = static_cast<IndexType>(key >> 32);
+                const auto b = static_cast<IndexType>(key & 0xFFFF'FFFF);
+                const bool borderEdge = edgeTriangleCounts[key] == 1;
+
+                const auto canMove = [&kinds, borderEdge](IndexType from)
+                {
+                    return kinds[from] == VertexKind::Manifold || (kinds[from] == VertexKind::Border && borderEdge);
+                };
+
+                Quadric merged = quadrics[a];
+                merged += quadrics[b];
+                const double errorAB = canMove(a) ? merged.Evaluate(scaled[b]) : std::numeric_limits<double>::infinity();
+                const double errorBA = canMove(b) ? merged.Evaluate(scaled[a]) : std::numeric_limits<double>::infinity();
+                if (errorAB <= errorBA && errorAB != std::numeric_limits<double>::infinity())
+                {
+                    collapses.push_back({a, b, errorAB});
+                }
+                else if (errorBA != std::numeric_limits<double>::infinity())
+                {
+                    collapses.push_back({b, a, errorBA});
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) { return a.Error < b.Error; });
+
+            // A manifold collapse removes two triangles
+            const size_t targetTriangleCount = targetIndexCount / 3;
+            const size_t collapseGoal = (triangleCount - targetTriangleCount) / 2 + 1;
+            const double maxError = static_cast<double>(targetError) * static_cast<double>(targetError);
+
+            std::fill(locked.begin(), locked.end(), 0);
+            std::iota(vertexRemap.begin(), vertexRemap.end(), 0);
+            size_t collapseCount = 0;
+
+            for (const auto &collapse : collapses)
+            {
+                if (collapse.Error > maxError || collapseCount >= collapseGoal)
+                {
+                    break;
+                }
+                if (locked[collapse.From] || locked[collapse.To])
+                {
+                    continue;
+                }
+
+                // Every vertex at From must have an edge to a vertex at To, which it is then merged with, so attribute seams stay intact
+                wedgeTargets.clear();
+                bool valid = true;
+                for (uint32_t t = triangleOffsets[collapse.From]; t < triangleOffsets[collapse.From + 1] && valid; t++)
+                {
+                    const IndexType *triangle = &result[positionTriangles[t] * 3];
+                    IndexType fromVertex = UnusedVertex;
+                    IndexType toVertex = UnusedVertex;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        if (positionOf[triangle[c]] == collapse.From)
+                        {
+                            fromVertex = triangle[c];
+                        }
+                        else if (positionOf[triangle[c]] == collapse.To)
+                        {
+                            toVertex = triangle[c];
+                        }
+                    }
+
+                    if (toVertex != UnusedVertex)
+                    {
+                        wedgeTargets.emplace_back(fromVertex, toVertex);
+                        continue;
+                    }
+
+                    // The triangle remains, so it must not flip
+                    glm::vec3 corners[3];
+                    glm::vec3 movedCorners[3];
+                    for (int c = 0; c < 3; c++)
+                    {
+                        corners[c] = scaled[positionOf[triangle[c]]];
+                        movedCorners[c] = (positionOf[triangle[c]] == collapse.From) ? scaled[collapse.To] : corners[c];
+                    }
+                    const glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                    const glm::vec3 movedNormal = glm::cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+                    if (glm::dot(normal, movedNormal) <= 0.0f)
+                    {
+                        valid = false;
+                    }
+                }
+
+                for (uint32_t t = triangleOffsets[collapse.From]; t < triangleOffsets[collapse.From + 1] && valid; t++)
+                {
+                    const IndexType *triangle = &result[positionTriangles[t] * 3];
+                    for (int c = 0; c < 3; c++)
+                    {
+                        if (positionOf[triangle[c]] == collapse.From && std::none_of(wedgeTargets.begin(), wedgeTargets.end(), [vertex = triangle[c]](const auto &target) { return target.first == vertex; }))
+                        {
+                            valid = false;
+                        }
+                    }
+                }
+
+                if (!valid)
+                {
+                    continue;
+                }
+
+                for (const auto &[fromVertex, toVertex] : wedgeTargets)
+                {
+                    vertexRemap[fromVertex] = toVertex;
+                }
+                quadrics[collapse.To] += quadrics[collapse.From];
+
+                // Neighbouring triangles change shape, so they cannot be checked against this pass's adjacency again
+                for (uint32_t t = triangleOffsets[collapse.From]; t < triangleOffsets[collapse.From + 1]; t++)
+                {
+                    const IndexType *triangle = &result[positionTriangles[t] * 3];
+                    for (int c = 0; c < 3; c++)
+                    {
+                        locked[positionOf[triangle[c]]] = 1;
+                    }
+                }
+
+                error = std::max(error, static_cast<float>(std::sqrt(collapse.Error)));
+                collapseCount++;
+            }
+
+            if (collapseCount == 0)
+            {
+                break;
+            }
+
+            // Remap and remove the triangles which collapsed
+            size_t writeIndex = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const IndexType a = vertexRemap[result[i]];
+                const IndexType b = vertexRemap[result[i + 1]];
+                const IndexType c = vertexRemap[result[i + 2]];
+                if (positionOf[a] == positionOf[b] || positionOf[b] == positionOf[c] || positionOf[a] == positionOf[c])
+                {
+                    continue;
+                }
+                result[writeIndex++] = a;
+                result[writeIndex++] = b;
+                result[writeIndex++] = c;
+            }
+            result.resize(writeIndex);
+        }
+
+        if (resultError != nullptr)
+        {
+            *resultError = error;
+        }
+        return result;
+    }
+} // Spinner
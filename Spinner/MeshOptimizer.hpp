@@ -0,0 +1,120 @@
+#ifndef SPINNER_MESHOPTIMIZER_HPP
+#define SPINNER_MESHOPTIMIZER_HPP
+
+#include <vector>
+#include "MeshBuffer.hpp"
+#include "GLM.hpp"
+
+namespace Spinner
+{
+    /// Import time index & vertex reordering for triangle lists.
+    /// Removes duplicate vertices, reorders triangles for the post-transform vertex cache (Tipsify) and then for overdraw,
+    /// and finally reorders vertices in the order they are first referenced for vertex fetch locality
+    class MeshOptimizer
+    {
+    public:
+        using IndexType = MeshBuffer::IndexType;
+
+        static constexpr uint32_t DefaultCacheSize = 16;
+        /// How much worse (as a ratio) a cluster's ACMR can be than its hard boundary cluster when splitting for overdraw ordering
+        static constexpr float DefaultOverdrawThreshold = 1.05f;
+        static constexpr uint32_t OverdrawGridSize = 256;
+
+        struct Statistics
+        {
+            size_t VertexCount = 0;
+            size_t TriangleCount = 0;
+            size_t VertexShaderInvocations = 0; // Post-transform cache misses with a FIFO cache of DefaultCacheSize
+            uint64_t PixelsShaded = 0; // Summed over 6 axis aligned orthographic views
+            uint64_t PixelsCovered = 0;
+
+            /// Average cache miss ratio, vertex shader invocations per triangle
+            [[nodiscard]] float GetACMR() const;
+            /// Average transformed vertex ratio, vertex shader invocations per vertex
+            [[nodiscard]] float GetATVR() const;
+            /// Fragment shader invocations per covered pixel
+            [[nodiscard]] float GetOverdraw() const;
+
+            Statistics &operator+=(const Statistics &other);
+        };
+
+    public:
+        /// Returns a remap table from old to new vertex indices which merges vertices with identical bytes, and the unique vertex count
+        static std::vector<IndexType> GenerateVertexRemap(const void *vertices, size_t vertexCount, size_t vertexSize, const std::vector<IndexType> &indices, size_t &uniqueVertexCount);
+        /// Returns a remap table from old to new vertex indices which orders vertices by first use, and the referenced vertex count
+        static std::vector<IndexType> GenerateVertexFetchRemap(const std::vector<IndexType> &indices, size_t vertexCount, size_t &referencedVertexCount);
+        static void RemapIndices(std::vector<IndexType> &indices, const std::vector<IndexType> &remap);
+
+        /// Tipsify triangle ordering. Optionally outputs the first triangle of each cluster which starts from a cold cache
+        static void OptimizeVertexCache(std::vector<IndexType> &indices, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize, std::vector<uint32_t> *hardClusters = nullptr);
+        /// Splits the hard clusters further while the ACMR stays within the threshold, then sorts the clusters so outward facing ones draw first
+        static void OptimizeOverdraw(std::vector<IndexType> &indices, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &hardClusters, uint32_t cacheSize = DefaultCacheSize, float threshold = DefaultOverdrawThreshold);
+
+        static Statistics AnalyzeMesh(const std::vector<IndexType> &indices, const std::vector<glm::vec3> &positions, uint32_t cacheSize = DefaultCacheSize);
+
+        /// Quadric error edge collapse onto existing vertices, so the result indexes the same vertex buffer.
+        /// Stops at the target index count or when the next collapse exceeds targetError, errors are relative to the largest extent of the mesh's bounds
+        static std::vector<IndexType> Simplify(const std::vector<IndexType> &indices, const std::vector<glm::vec3> &positions, size_t targetIndexCount, float targetError, float *resultError = nullptr);
+
+        /// Runs every stage on a triangle list, Vertex must have a glm::vec3 Position
+        template<typename Vertex>
+        static void OptimizeMesh(std::vector<Vertex> &vertices, std::vector<IndexType> &indices, Statistics *before = nullptr, Statistics *after = nullptr)
+        {
+            if (before != nullptr)
+            {
+                *before = AnalyzeMesh(indices, GetPositions(vertices));
+            }
+
+            // Duplicate vertices
+            size_t vertexCount = 0;
+            auto remap = GenerateVertexRemap(vertices.data(), vertices.size(), sizeof(Vertex), indices, vertexCount);
+            RemapIndices(indices, remap);
+            RemapVertices(vertices, remap, vertexCount);
+
+            // Vertex cache then overdraw
+            std::vector<uint32_t> hardClusters;
+            OptimizeVertexCache(indices, vertices.size(), DefaultCacheSize, &hardClusters);
+            OptimizeOverdraw(indices, GetPositions(vertices), hardClusters);
+
+            // Vertex fetch
+            remap = GenerateVertexFetchRemap(indices, vertices.size(), vertexCount);
+            RemapIndices(indices, remap);
+            RemapVertices(vertices, remap, vertexCount);
+
+            if (after != nullptr)
+            {
+                *after = AnalyzeMesh(indices, GetPositions(vertices));
+            }
+        }
+
+    protected:
+        template<typename Vertex>
+        static void RemapVertices(std::vector<Vertex> &vertices, const std::vector<IndexType> &remap, size_t newVertexCount)
+        {
+            std::vector<Vertex> remapped(newVertexCount);
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                if (remap[i] != UnusedVertex)
+                {
+                    remapped[remap[i]] = vertices[i];
+                }
+            }
+            vertices = std::move(remapped);
+        }
+
+        template<typename Vertex>
+        static std::vector<glm::vec3> GetPositions(const std::vector<Vertex> &vertices)
+        {
+            std::vector<glm::vec3> positions(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                positions[i] = vertices[i].Position;
+            }
+            return positions;
+        }
+
+        static constexpr IndexType UnusedVertex = 0xFFFF'FFFF;
+    };
+} // Spinner
+
+#endif //SPINNER_MESHOPTIMIZER_HPP
@@ -0,0 +1,302 @@
+#include "ModelCache.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "Utilities.hpp"
+
+namespace Spinner
+{
+    static_assert(std::is_trivially_copyable_v<ModelCache::Header>);
+    static_assert(std::is_trivially_copyable_v<ModelCache::NodeRecord>);
+    static_assert(std::is_trivially_copyable_v<ModelCache::PrimitiveRecord>);
+
+    // Each size is the sum of the record's member sizes, so a mismatch means the compiler added padding which would be written uninitialized
+    static_assert(sizeof(ModelCache::StringReference) == 16 && sizeof(ModelCache::BlobReference) == 16);
+    static_assert(sizeof(ModelCache::ImageRecord) == 56);
+    static_assert(sizeof(ModelCache::TextureRecord) == 48);
+    static_assert(sizeof(ModelCache::MaterialRecord) == 48);
+    static_assert(sizeof(ModelCache::AttributeRecord) == 12);
+    static_assert(sizeof(ModelCache::LodRecord) == 12);
+    static_assert(sizeof(ModelCache::PrimitiveRecord) == 112);
+    static_assert(sizeof(ModelCache::LightRecord) == 28);
+    static_assert(sizeof(ModelCache::MeshRecord) == 24);
+    static_assert(sizeof(ModelCache::NodeRecord) == 72);
+    static_assert(sizeof(ModelCache::SectionRecord) == 16);
+    static_assert(sizeof(ModelCache::Header) == 32 + sizeof(ModelCache::SectionRecord) * static_cast<size_t>(ModelCache::Section::Count));
+
+    // Size of a single record in each section, strings and blobs are byte arrays
+    static constexpr std::array<size_t, static_cast<size_t>(ModelCache::Section::Count)> SectionRecordSizes = {
+        1,
+        1,
+        sizeof(ModelCache::ImageRecord),
+        sizeof(ModelCache::TextureRecord),
+        sizeof(ModelCache::MaterialRecord),
+        sizeof(ModelCache::AttributeRecord),
+        sizeof(ModelCache::LodRecord),
+        sizeof(ModelCache::PrimitiveRecord),
+        sizeof(ModelCache::LightRecord),
+        sizeof(ModelCache::MeshRecord),
+        sizeof(ModelCache::NodeRecord),
+    };
+
+    ModelCache::StringReference ModelCache::Writer::AddString(std::string_view string)
+    {
+        StringReference reference{Strings.size(), string.size()};
+        Strings.append(string);
+        return reference;
+    }
+
+    ModelCache::BlobReference ModelCache::Writer::AddBlob(const void *data, size_t size)
+    {
+        // Every blob starts aligned, so it can be read in place as its element type
+        BlobsSize = AlignUp<uint64_t>(BlobsSize, SectionAlignment);
+        BlobReference reference{BlobsSize, size};
+        Blobs.emplace_back(static_cast<const uint8_t *>(data), size);
+        BlobsSize += size;
+        return reference;
+    }
+
+    template<typename T>
+    static std::span<const uint8_t> GetBytes(const std::vector<T> &records)
+    {
+        return {reinterpret_cast<const uint8_t *>(records.data()), records.size() * sizeof(T)};
+    }
+
+    void ModelCache::Writer::Write(const std::string &cachePath, uint64_t sourceKey, uint32_t flags) const
+    {
+        Header header{};
+        header.Magic = Magic;
+        header.Version = ImporterVersion;
+        header.Flags = flags;
+        header.SourceKey = sourceKey;
+
+        const std::array<std::span<const uint8_t>, static_cast<size_t>(Section::Count)> sectionData = {
+            std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(Strings.data()), Strings.size()),
+            std::span<const uint8_t>(), // Blobs are written one at a time below
+            GetBytes(Images),
+            GetBytes(Textures),
+            GetBytes(Materials),
+            GetBytes(Attributes),
+            GetBytes(Lods),
+            GetBytes(Primitives),
+            GetBytes(Lights),
+            GetBytes(Meshes),
+            GetBytes(Nodes),
+        };
+
+        uint64_t offset = sizeof(Header);
+        for (size_t i = 0; i < sectionData.size(); i++)
+        {
+            offset = AlignUp<uint64_t>(offset, SectionAlignment);
+            header.Sections[i].Offset = offset;
+            header.Sections[i].Size = (i == static_cast<size_t>(Section::Blobs)) ? BlobsSize : sectionData[i].size();
+            offset += header.Sections[i].Size;
+        }
+        header.FileSize = offset;
+
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path());
+        const std::string temporaryPath = cachePath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Failed to open model cache for writing: " + temporaryPath);
+            }
+
+            uint64_t written = 0;
+            const auto writeAt = [&file, &written](uint64_t position, std::span<const uint8_t> bytes)
+            {
+                static constexpr std::array<char, SectionAlignment> Padding{};
+                file.write(Padding.data(), static_cast<std::streamsize>(position - written));
+                file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+                written = position + bytes.size();
+            };
+
+            writeAt(0, {reinterpret_cast<const uint8_t *>(&header), sizeof(Header)});
+            for (size_t i = 0; i < sectionData.size(); i++)
+            {
+                const uint64_t sectionOffset = header.Sections[i].Offset;
+                if (i != static_cast<size_t>(Section::Blobs))
+                {
+                    writeAt(sectionOffset, sectionData[i]);
+                    continue;
+                }
+
+                uint64_t blobOffset = 0;
+                for (const auto &blob : Blobs)
+                {
+                    blobOffset = AlignUp<uint64_t>(blobOffset, SectionAlignment);
+                    writeAt(sectionOffset + blobOffset, blob);
+                    blobOffset += blob.size();
+                }
+                writeAt(sectionOffset + BlobsSize, {});
+            }
+
+            if (!file.good())
+            {
+                throw std::runtime_error("Failed to write model cache: " + temporaryPath);
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, cachePath);
+    }
+
+    ModelCache::ModelCache(MappedFile::Pointer file) : File(std::move(file))
+    {
+        if (File->GetSize() < sizeof(Header))
+        {
+            throw std::runtime_error("Model cache is smaller than its header");
+        }
+        FileHeader = reinterpret_cast<const Header *>(File->GetData());
+
+        if (FileHeader->Magic != Magic || FileHeader->Version != ImporterVersion || FileHeader->FileSize != File->GetSize())
+        {
+            throw std::runtime_error("Model cache has an unknown format or version");
+        }
+
+        for (size_t i = 0; i < FileHeader->Sections.size(); i++)
+        {
+            const auto &section = FileHeader->Sections[i];
+            if (section.Offset % SectionAlignment != 0 || section.Offset > File->GetSize() || section.Size > File->GetSize() - section.Offset || section.Size % SectionRecordSizes[i] != 0)
+            {
+                throw std::runtime_error("Model cache section " + std::to_string(i) + " is out of bounds");
+            }
+        }
+    }
+
+    uint64_t ModelCache::GetSourceKey() const
+    {
+        return FileHeader->SourceKey;
+    }
+
+    uint32_t ModelCache::GetFlags() const
+    {
+        return FileHeader->Flags;
+    }
+
+    std::string_view ModelCache::GetString(const StringReference &string) const
+    {
+        const auto &section = FileHeader->Sections[static_cast<size_t>(Section::Strings)];
+        if (string.Offset > section.Size || string.Length > section.Size - string.Offset)
+        {
+            throw std::runtime_error("Model cache string is out of bounds");
+        }
+        return {reinterpret_cast<const char *>(File->GetData() + section.Offset + string.Offset), string.Length};
+    }
+
+    std::span<const uint8_t> ModelCache::GetBlob(const BlobReference &blob) const
+    {
+        const auto &section = FileHeader->Sections[static_cast<size_t>(Section::Blobs)];
+        if (blob.Offset > section.Size || blob.Size > section.Size - blob.Offset)
+        {
+            throw std::runtime_error("Model cache blob is out of bounds");
+        }
+        return {File->GetData() + section.Offset + blob.Offset, blob.Size};
+    }
+
+    std::span<const ModelCache::ImageRecord> ModelCache::GetImages() const
+    {
+        return GetRecords<ImageRecord>(Section::Images);
+    }
+
+    std::span<const ModelCache::TextureRecord> ModelCache::GetTextures() const
+    {
+        return GetRecords<TextureRecord>(Section::Textures);
+    }
+
+    std::span<const ModelCache::MaterialRecord> ModelCache::GetMaterials() const
+    {
+        return GetRecords<MaterialRecord>(Section::Materials);
+    }
+
+    std::span<const ModelCache::AttributeRecord> ModelCache::GetAttributes() const
+    {
+        return GetRecords<AttributeRecord>(Section::Attributes);
+    }
+
+    std::span<const ModelCache::LodRecord> ModelCache::GetLods() const
+    {
+        return GetRecords<LodRecord>(Section::Lods);
+    }
+
+    std::span<const ModelCache::PrimitiveRecord> ModelCache::GetPrimitives() const
+    {
+        return GetRecords<PrimitiveRecord>(Section::Primitives);
+    }
+
+    std::span<const ModelCache::LightRecord> ModelCache::GetLights() const
+    {
+        return GetRecords<LightRecord>(Section::Lights);
+    }
+
+    std::span<const ModelCache::MeshRecord> ModelCache::GetMeshes() const
+    {
+        return GetRecords<MeshRecord>(Section::Meshes);
+    }
+
+    std::span<const ModelCache::NodeRecord> ModelCache::GetNodes() const
+    {
+        return GetRecords<NodeRecord>(Section::Nodes);
+    }
+
+    ModelCache::Pointer ModelCache::Open(const std::string &cachePath, uint64_t sourceKey)
+    {
+        if (!FileExists(cachePath))
+        {
+            return nullptr;
+        }
+
+        try
+        {
+            auto cache = std::make_shared<ModelCache>(MappedFile::Open(cachePath));
+            if (cache->GetSourceKey() != sourceKey)
+            {
+                return nullptr;
+            }
+            return cache;
+        }
+        catch (const std::exception &)
+        {
+            // Rebaked by the importer
+            return nullptr;
+        }
+    }
+
+    uint64_t ModelCache::ComputeSourceKey(const std::string &sourcePath, uint64_t settingsKey)
+    {
+        auto sourceFile = MappedFile::Open(sourcePath);
+        uint64_t key = HashBytes(sourceFile->GetBytes(), settingsKey);
+        key ^= HashBytes({reinterpret_cast<const uint8_t *>(&ImporterVersion), sizeof(ImporterVersion)});
+        return key;
+    }
+
+    uint64_t ModelCache::HashBytes(std::span<const uint8_t> bytes, uint64_t seed)
+    {
+        // FNV-1a over 64 bit words, finished with the MurmurHash3 mixer so small changes spread over every bit
+        constexpr uint64_t Prime = 0x100000001B3ull;
+        uint64_t hash = 0xCBF29CE484222325ull ^ seed;
+
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes.data() + i, sizeof(uint64_t));
+            hash = (hash ^ word) * Prime;
+            hash ^= hash >> 32;
+        }
+        for (; i < bytes.size(); i++)
+        {
+            hash = (hash ^ bytes[i]) * Prime;
+        }
+
+        hash ^= bytes.size();
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+} // Spinner
@@ -0,0 +1,241 @@
+#ifndef SPINNER_MODELCACHE_HPP
+#define SPINNER_MODELCACHE_HPP
+
+#include <vulkan/vulkan.hpp>
+#include <array>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "Light.hpp"
+#include "GLM.hpp"
+
+namespace Spinner
+{
+    /// Baked result of importing a model, laid out to be memory mapped and read in place.
+    /// Holds the final vertex & index blobs, decoded images or references to texture files, materials and the node hierarchy.
+    /// Every record is trivially copyable, strings and blobs are referenced by offset into their sections
+    class ModelCache
+    {
+    public:
+        using Pointer = std::shared_ptr<ModelCache>;
+
+        /// Bump whenever the importer's output or the cache layout changes, every existing cache then becomes stale
+        static constexpr uint32_t ImporterVersion = 6;
+        static constexpr std::array<char, 8> Magic = {'S', 'P', 'N', 'M', 'O', 'D', 'E', 'L'};
+        static constexpr uint64_t SectionAlignment = 16;
+        static constexpr int32_t NoIndex = -1;
+
+        enum class Section : uint32_t
+        {
+            Strings,
+            Blobs,
+            Images,
+            Textures,
+            Materials,
+            Attributes,
+            Lods,
+            Primitives,
+            Lights,
+            Meshes,
+            Nodes,
+            Count
+        };
+
+        // Records are written to the file as raw bytes, compiler inserted padding would be written uninitialized.
+        // Each record spells out its padding as a zeroed member instead, ModelCache.cpp checks that no implicit padding remains
+        struct StringReference
+        {
+            uint64_t Offset = 0;
+            uint64_t Length = 0;
+        };
+
+        struct BlobReference
+        {
+            uint64_t Offset = 0;
+            uint64_t Size = 0;
+        };
+
+        struct ImageRecord
+        {
+            BlobReference Pixels; // Empty when the image is loaded from TextureFilename instead
+            StringReference TextureFilename;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            vk::Format Format = vk::Format::eUndefined;
+            uint32_t Padding = 0;
+            uint64_t SourceHash = 0; // TextureCache::GetContentSource of the encoded image
+        };
+
+        struct TextureRecord
+        {
+            StringReference Name;
+            int32_t ImageIndex = NoIndex; // NoIndex uses the magenta texture
+            vk::Filter MinFilter = vk::Filter::eLinear;
+            vk::Filter MagFilter = vk::Filter::eLinear;
+            vk::SamplerMipmapMode MipFilter = vk::SamplerMipmapMode::eLinear;
+            vk::SamplerAddressMode AddressModeU = vk::SamplerAddressMode::eRepeat;
+            vk::SamplerAddressMode AddressModeV = vk::SamplerAddressMode::eRepeat;
+            float MaxLod = vk::LodClampNone;
+            uint32_t Padding = 0;
+        };
+
+        struct MaterialRecord
+        {
+            StringReference Name;
+            glm::vec4 Color = {1, 1, 1, 1};
+            float Roughness = 0.5f;
+            float Metallic = 0.0f;
+            int32_t ColorTextureIndex = NoIndex;
+            uint32_t Padding = 0;
+        };
+
+        struct AttributeRecord
+        {
+            vk::Format Format = vk::Format::eUndefined;
+            uint32_t Location = 0;
+            uint32_t Offset = 0;
+        };
+
+        struct LodRecord
+        {
+            uint32_t FirstIndex = 0;
+            uint32_t IndexCount = 0;
+            float Error = 0.0f;
+        };
+
+        struct PrimitiveRecord
+        {
+            BlobReference VertexData;
+            BlobReference IndexData;
+            uint32_t IndexCount = 0;
+            vk::IndexType IndexType = vk::IndexType::eUint32;
+            uint32_t Stride = 0;
+            uint32_t FirstAttribute = 0;
+            uint32_t AttributeCount = 0;
+            glm::vec4 PositionDequantizeOffset = {0, 0, 0, 0};
+            glm::vec4 PositionDequantizeScale = {1, 1, 1, 1};
+            uint32_t FirstLod = 0;
+            uint32_t LodCount = 0;
+            glm::vec4 BoundingSphere = {0, 0, 0, 0};
+            uint32_t Padding = 0;
+        };
+
+        struct LightRecord
+        {
+            LightType Type = LightType::None;
+            glm::vec3 Color = {1, 1, 1};
+            float Strength = 1.0f;
+            float InnerSpotAngle = 0.0f;
+            float OuterSpotAngle = 0.0f;
+        };
+
+        /// A mesh component, drawing one primitive with one material
+        struct MeshRecord
+        {
+            StringReference Name;
+            int32_t PrimitiveIndex = NoIndex;
+            int32_t MaterialIndex = NoIndex; // NoIndex creates an unnamed material
+        };
+
+        /// Nodes are stored depth first so parents always come before their children, the first node is the root
+        struct NodeRecord
+        {
+            StringReference Name;
+            int32_t ParentIndex = NoIndex;
+            int32_t LightIndex = NoIndex;
+            uint32_t FirstMesh = 0;
+            uint32_t MeshCount = 0;
+            glm::vec3 Position = {0, 0, 0};
+            glm::quat Rotation = {1, 0, 0, 0};
+            glm::vec3 Scale = {1, 1, 1};
+        };
+
+        struct SectionRecord
+        {
+            uint64_t Offset = 0;
+            uint64_t Size = 0;
+        };
+
+        struct Header
+        {
+            std::array<char, 8> Magic{};
+            uint32_t Version = 0;
+            uint32_t Flags = 0;
+            uint64_t SourceKey = 0;
+            uint64_t FileSize = 0;
+            std::array<SectionRecord, static_cast<size_t>(Section::Count)> Sections{};
+        };
+
+        /// Collects records while baking and writes them out as a cache file.
+        /// Blobs are referenced rather than copied, so their data must outlive the call to Write
+        class Writer
+        {
+        public:
+            std::vector<ImageRecord> Images;
+            std::vector<TextureRecord> Textures;
+            std::vector<MaterialRecord> Materials;
+            std::vector<AttributeRecord> Attributes;
+            std::vector<LodRecord> Lods;
+            std::vector<PrimitiveRecord> Primitives;
+            std::vector<LightRecord> Lights;
+            std::vector<MeshRecord> Meshes;
+            std::vector<NodeRecord> Nodes;
+
+        protected:
+            std::string Strings;
+            std::vector<std::span<const uint8_t>> Blobs;
+            uint64_t BlobsSize = 0;
+
+        public:
+            StringReference AddString(std::string_view string);
+            BlobReference AddBlob(const void *data, size_t size);
+
+            /// Writes to a temporary file first, so a partially written cache is never picked up
+            void Write(const std::string &cachePath, uint64_t sourceKey, uint32_t flags) const;
+        };
+
+    public:
+        explicit ModelCache(MappedFile::Pointer file);
+
+    protected:
+        MappedFile::Pointer File;
+        const Header *FileHeader = nullptr;
+
+    protected:
+        template<typename T>
+        [[nodiscard]] std::span<const T> GetRecords(Section section) const
+        {
+            const auto &sectionRecord = FileHeader->Sections[static_cast<size_t>(section)];
+            return {reinterpret_cast<const T *>(File->GetData() + sectionRecord.Offset), sectionRecord.Size / sizeof(T)};
+        }
+
+    public:
+        [[nodiscard]] uint64_t GetSourceKey() const;
+        [[nodiscard]] uint32_t GetFlags() const;
+
+        [[nodiscard]] std::string_view GetString(const StringReference &string) const;
+        [[nodiscard]] std::span<const uint8_t> GetBlob(const BlobReference &blob) const;
+
+        [[nodiscard]] std::span<const ImageRecord> GetImages() const;
+        [[nodiscard]] std::span<const TextureRecord> GetTextures() const;
+        [[nodiscard]] std::span<const MaterialRecord> GetMaterials() const;
+        [[nodiscard]] std::span<const AttributeRecord> GetAttributes() const;
+        [[nodiscard]] std::span<const LodRecord> GetLods() const;
+        [[nodiscard]] std::span<const PrimitiveRecord> GetPrimitives() const;
+        [[nodiscard]] std::span<const LightRecord> GetLights() const;
+        [[nodiscard]] std::span<const MeshRecord> GetMeshes() const;
+        [[nodiscard]] std::span<const NodeRecord> GetNodes() const;
+
+    public:
+        /// Maps a cache file, returns nullptr if it does not exist, is invalid or was baked from a different source
+        static Pointer Open(const std::string &cachePath, uint64_t sourceKey);
+
+        /// Hashes the source file's contents together with the importer version and the import settings
+        static uint64_t ComputeSourceKey(const std::string &sourcePath, uint64_t settingsKey);
+        static uint64_t HashBytes(std::span<const uint8_t> bytes, uint64_t seed = 0);
+    };
+} // Spinner
+
+#endif //SPINNER_MODELCACHE_HPP
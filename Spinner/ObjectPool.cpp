@@ -0,0 +1,217 @@
+#include "ObjectPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace Spinner
+{
+    static constexpr size_t SizeClassCount = ObjectPool::MaxPooledSize / ObjectPool::BlockAlignment;
+
+    ObjectPool::ObjectPool(size_t blockSize, size_t blocksPerSlab) : BlockSize(((std::max(blockSize, sizeof(FreeBlock)) + BlockAlignment - 1) / BlockAlignment) * BlockAlignment), BlocksPerSlab(std::max<size_t>(blocksPerSlab, 1))
+    {
+    }
+
+    ObjectPool::~ObjectPool()
+    {
+        for (auto *slab : Slabs)
+        {
+            ::operator delete(slab, std::align_val_t{BlockAlignment});
+        }
+    }
+
+    void *ObjectPool::Allocate()
+    {
+        std::lock_guard lock(Mutex);
+        AllocatedCount.fetch_add(1, std::memory_order_relaxed);
+        if (FreeList != nullptr)
+        {
+            auto *block = FreeList;
+            FreeList = block->Next;
+            return block;
+        }
+
+        if (SlabCursor == SlabEnd)
+        {
+            const auto slabBytes = BlockSize * BlocksPerSlab;
+            auto *slab = static_cast<std::byte *>(::operator new(slabBytes, std::align_val_t{BlockAlignment}));
+            Slabs.push_back(slab);
+            SlabCursor = slab;
+            SlabEnd = slab + slabBytes;
+        }
+
+        auto *block = SlabCursor;
+        SlabCursor += BlockSize;
+        return block;
+    }
+
+    void ObjectPool::Free(void *block) noexcept
+    {
+        if (block == nullptr)
+        {
+            return;
+        }
+
+        std::lock_guard lock(Mutex);
+        assert(AllocatedCount.load(std::memory_order_relaxed) > 0);
+        AllocatedCount.fetch_sub(1, std::memory_order_relaxed);
+        auto *freeBlock = static_cast<FreeBlock *>(block);
+        freeBlock->Next = FreeList;
+        FreeList = freeBlock;
+    }
+
+    size_t ObjectPool::GetBlockSize() const noexcept
+    {
+        return BlockSize;
+    }
+
+    size_t ObjectPool::GetAllocatedCount() const noexcept
+    {
+        return AllocatedCount.load(std::memory_order_relaxed);
+    }
+
+    size_t ObjectPool::GetSlabCount() const
+    {
+        std::lock_guard lock(Mutex);
+        return Slabs.size();
+    }
+
+    size_t ObjectPool::Trim()
+    {
+        std::lock_guard lock(Mutex);
+        if (Slabs.empty())
+        {
+            return 0;
+        }
+
+        // Each block's slab is found by address
+        auto slabs = Slabs;
+        std::sort(slabs.begin(), slabs.end(), std::less<>());
+        const auto findSlab = [&slabs](const void *block)
+        {
+            return static_cast<size_t>(std::upper_bound(slabs.begin(), slabs.end(), static_cast<const std::byte *>(block), std::less<>()) - slabs.begin()) - 1;
+        };
+
+        // Blocks past the cursor were never handed out, so they count as free too
+        std::vector<size_t> freeCounts(slabs.size(), 0);
+        for (auto *block = FreeList; block != nullptr; block = block->Next)
+        {
+            freeCounts[findSlab(block)]++;
+        }
+        if (SlabCursor != nullptr)
+        {
+            freeCounts[findSlab(SlabEnd - 1)] += static_cast<size_t>(SlabEnd - SlabCursor) / BlockSize;
+        }
+
+        std::vector<uint8_t> released(slabs.size(), 0);
+        bool anyReleased = false;
+        for (size_t i = 0; i < slabs.size(); i++)
+        {
+            released[i] = freeCounts[i] == BlocksPerSlab;
+            anyReleased = anyReleased || released[i];
+        }
+        if (!anyReleased)
+        {
+            return 0;
+        }
+
+        // The free list keeps its order without the released slabs' blocks
+        FreeBlock *freeList = nullptr;
+        FreeBlock **tail = &freeList;
+        for (auto *block = FreeList; block != nullptr; block = block->Next)
+        {
+            if (!released[findSlab(block)])
+            {
+                *tail = block;
+                tail = &block->Next;
+            }
+        }
+        *tail = nullptr;
+        FreeList = freeList;
+
+        if (SlabCursor != nullptr && released[findSlab(SlabEnd - 1)])
+        {
+            SlabCursor = nullptr;
+            SlabEnd = nullptr;
+        }
+
+        size_t releasedBytes = 0;
+        std::erase_if(Slabs, [&](std::byte *slab)
+        {
+            if (!released[findSlab(slab)])
+            {
+                return false;
+            }
+            ::operator delete(slab, std::align_val_t{BlockAlignment});
+            releasedBytes += BlockSize * BlocksPerSlab;
+            return true;
+        });
+        return releasedBytes;
+    }
+
+    using SizeClassPools = std::array<std::unique_ptr<ObjectPool>, SizeClassCount>;
+
+    static SizeClassPools &GetSizeClassPools()
+    {
+        // Never destroyed, objects still alive during static destruction free into them
+        static auto *pools = []
+        {
+            auto *sizeClasses = new SizeClassPools();
+            for (size_t i = 0; i < SizeClassCount; i++)
+            {
+                const auto blockSize = (i + 1) * ObjectPool::BlockAlignment;
+                (*sizeClasses)[i] = std::make_unique<ObjectPool>(blockSize, ObjectPool::SlabSize / blockSize);
+            }
+            return sizeClasses;
+        }();
+
+        return *pools;
+    }
+
+    static ObjectPool &GetSizeClassPool(size_t size)
+    {
+        return *GetSizeClassPools()[(size - 1) / ObjectPool::BlockAlignment];
+    }
+
+    void *ObjectPool::AllocateShared(size_t size)
+    {
+        if (size == 0 || size > MaxPooledSize)
+        {
+            return ::operator new(size);
+        }
+        return GetSizeClassPool(size).Allocate();
+    }
+
+    void ObjectPool::FreeShared(void *block, size_t size) noexcept
+    {
+        if (size == 0 || size > MaxPooledSize)
+        {
+            ::operator delete(block);
+            return;
+        }
+        GetSizeClassPool(size).Free(block);
+    }
+
+    size_t ObjectPool::TrimShared()
+    {
+        size_t releasedBytes = 0;
+        for (auto &pool : GetSizeClassPools())
+        {
+            releasedBytes += pool->Trim();
+        }
+        return releasedBytes;
+    }
+
+    size_t ObjectPool::GetSharedAllocatedCount()
+    {
+        size_t count = 0;
+        for (auto &pool : GetSizeClassPools())
+        {
+            count += pool->GetAllocatedCount();
+        }
+        return count;
+    }
+} // Spinner
@@ -0,0 +1,113 @@
+#ifndef SPINNER_OBJECTPOOL_HPP
+#define SPINNER_OBJECTPOOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Spinner
+{
+    /// Fixed size blocks carved out of large slabs, freed blocks go on a free list and are reused before the slab grows.
+    /// Objects allocated one after another end up next to each other, and freeing a whole model never reaches the system allocator.
+    /// Slabs go back to the system when the pool is trimmed or destroyed
+    class ObjectPool
+    {
+    public:
+        ObjectPool(size_t blockSize, size_t blocksPerSlab);
+        ~ObjectPool();
+
+        ObjectPool(const ObjectPool &) = delete;
+        ObjectPool &operator=(const ObjectPool &) = delete;
+
+        [[nodiscard]] void *Allocate();
+        void Free(void *block) noexcept;
+
+        [[nodiscard]] size_t GetBlockSize() const noexcept;
+        /// Blocks handed out and not yet freed
+        [[nodiscard]] size_t GetAllocatedCount() const noexcept;
+        [[nodiscard]] size_t GetSlabCount() const;
+        /// Releases every slab none of whose blocks are in use, returns the bytes released
+        size_t Trim();
+
+    protected:
+        struct FreeBlock
+        {
+            FreeBlock *Next;
+        };
+
+        const size_t BlockSize;
+        const size_t BlocksPerSlab;
+
+        std::vector<std::byte *> Slabs;
+        FreeBlock *FreeList = nullptr;
+        std::byte *SlabCursor = nullptr; // Next never used block in the newest slab
+        std::byte *SlabEnd = nullptr;
+        std::atomic<size_t> AllocatedCount = 0; // Read without the lock
+
+        mutable std::mutex Mutex; // Objects are created on the main thread, but their last reference may be dropped anywhere
+
+    public:
+        static constexpr size_t BlockAlignment = alignof(std::max_align_t);
+        static constexpr size_t SlabSize = 64 * 1024;
+        /// Larger allocations go straight to operator new
+        static constexpr size_t MaxPooledSize = 2048;
+
+        /// From the shared pool of the size class holding size, or operator new past MaxPooledSize
+        [[nodiscard]] static void *AllocateShared(size_t size);
+        /// size must be the size passed to AllocateShared
+        static void FreeShared(void *block, size_t size) noexcept;
+        /// Trims every shared size class pool, called once a scene has been destroyed. Returns the bytes released
+        static size_t TrimShared();
+        /// Blocks in use across the shared size class pools
+        [[nodiscard]] static size_t GetSharedAllocatedCount();
+    };
+
+    /// Standard allocator over the shared size class pools, for std::allocate_shared so the object and its control block share one pooled block
+    template<typename T>
+    class PoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        PoolAllocator() noexcept = default;
+
+        template<typename U>
+        inline PoolAllocator(const PoolAllocator<U> &) noexcept
+        {
+        }
+
+        [[nodiscard]] inline T *allocate(size_t count)
+        {
+            if constexpr (alignof(T) > ObjectPool::BlockAlignment)
+            {
+                return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t{alignof(T)}));
+            }
+            else
+            {
+                return static_cast<T *>(ObjectPool::AllocateShared(count * sizeof(T)));
+            }
+        }
+
+        inline void deallocate(T *pointer, size_t count) noexcept
+        {
+            if constexpr (alignof(T) > ObjectPool::BlockAlignment)
+            {
+                ::operator delete(pointer, std::align_val_t{alignof(T)});
+            }
+            else
+            {
+                ObjectPool::FreeShared(pointer, count * sizeof(T));
+            }
+        }
+
+        template<typename U>
+        inline bool operator==(const PoolAllocator<U> &) const noexcept
+        {
+            return true;
+        }
+    };
+} // Spinner
+
+#endif //SPINNER_OBJECTPOOL_HPP
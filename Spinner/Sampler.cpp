@@ -1,33 +1,95 @@
 #include "Sampler.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <mutex>
+#include <unordered_map>
+
 #include "Graphics.hpp"
+#include "ModelCache.hpp"
 
 namespace Spinner
 {
-    Sampler::Sampler(vk::Filter minMagFilter, vk::SamplerMipmapMode mipFilter, vk::SamplerAddressMode repeat, float maxAnisotropy, std::optional<vk::CompareOp> compareOp)
+    static constexpr size_t MinPruneSize = 32;
+
+    static std::mutex CacheMutex;
+    static std::unordered_map<Sampler::Settings, std::weak_ptr<Sampler>, Sampler::SettingsHash> CachedSamplers;
+    static size_t NextPruneSize = MinPruneSize;
+
+    // Expects CacheMutex to be locked
+    static void PruneExpired()
     {
-        float maxHardwareAnisotropy = Graphics::GetPhysicalDevice().getProperties().limits.maxSamplerAnisotropy;
-        if (maxHardwareAnisotropy < maxAnisotropy)
-        {
-            maxAnisotropy = maxHardwareAnisotropy;
-        }
+        std::erase_if(CachedSamplers, [](const auto &entry) { return entry.second.expired(); });
+        NextPruneSize = std::max(MinPruneSize, CachedSamplers.size() * 2);
+    }
 
+    // Settings which create the same VkSampler compare equal
+    static Sampler::Settings Normalize(Sampler::Settings settings)
+    {
+        settings.MaxAnisotropy = std::clamp(settings.MaxAnisotropy, 0.0f, Sampler::GetMaxHardwareAnisotropy());
+        // Adding zero turns -0 into 0, so equal floats hash equally
+        settings.MaxAnisotropy += 0.0f;
+        settings.MinLod += 0.0f;
+        settings.MaxLod += 0.0f;
+        return settings;
+    }
+
+    static Sampler::Settings ToSettings(vk::Filter minMagFilter, vk::SamplerMipmapMode mipFilter, vk::SamplerAddressMode repeat, float maxAnisotropy, std::optional<vk::CompareOp> compareOp, float maxLod)
+    {
+        Sampler::Settings settings;
+        settings.MinFilter = settings.MagFilter = minMagFilter;
+        settings.MipFilter = mipFilter;
+        settings.AddressModeU = settings.AddressModeV = settings.AddressModeW = repeat;
+        settings.MaxAnisotropy = maxAnisotropy;
+        settings.CompareOp = compareOp;
+        settings.MaxLod = maxLod;
+        return settings;
+    }
+
+    size_t Sampler::SettingsHash::operator()(const Settings &settings) const noexcept
+    {
+        const std::array<uint32_t, 11> words = {
+            static_cast<uint32_t>(settings.MinFilter),
+            static_cast<uint32_t>(settings.MagFilter),
+            static_cast<uint32_t>(settings.MipFilter),
+            static_cast<uint32_t>(settings.AddressModeU),
+            static_cast<uint32_t>(settings.AddressModeV),
+            static_cast<uint32_t>(settings.AddressModeW),
+            std::bit_cast<uint32_t>(settings.MaxAnisotropy),
+            settings.CompareOp.has_value() ? 1u : 0u,
+            static_cast<uint32_t>(settings.CompareOp.value_or(vk::CompareOp::eNever)),
+            std::bit_cast<uint32_t>(settings.MinLod),
+            std::bit_cast<uint32_t>(settings.MaxLod),
+        };
+        return static_cast<size_t>(ModelCache::HashBytes({reinterpret_cast<const uint8_t *>(words.data()), sizeof(words)}));
+    }
+
+    Sampler::Sampler(const Settings &settings) : SamplerSettings(Normalize(settings))
+    {
         vk::SamplerCreateInfo samplerInfo;
-        samplerInfo.minFilter = samplerInfo.magFilter = minMagFilter;
-        samplerInfo.mipmapMode = mipFilter;
-        samplerInfo.addressModeU = samplerInfo.addressModeV = samplerInfo.addressModeW = repeat;
-        samplerInfo.maxAnisotropy = maxAnisotropy;
-        samplerInfo.anisotropyEnable = maxAnisotropy > 0;
-        samplerInfo.compareEnable = compareOp.has_value();
-        samplerInfo.compareOp = compareOp.value_or(vk::CompareOp::eAlways);
+        samplerInfo.minFilter = SamplerSettings.MinFilter;
+        samplerInfo.magFilter = SamplerSettings.MagFilter;
+        samplerInfo.mipmapMode = SamplerSettings.MipFilter;
+        samplerInfo.addressModeU = SamplerSettings.AddressModeU;
+        samplerInfo.addressModeV = SamplerSettings.AddressModeV;
+        samplerInfo.addressModeW = SamplerSettings.AddressModeW;
+        samplerInfo.maxAnisotropy = SamplerSettings.MaxAnisotropy;
+        samplerInfo.anisotropyEnable = SamplerSettings.MaxAnisotropy > 0;
+        samplerInfo.compareEnable = SamplerSettings.CompareOp.has_value();
+        samplerInfo.compareOp = SamplerSettings.CompareOp.value_or(vk::CompareOp::eAlways);
         samplerInfo.mipLodBias = 0.0f;
-        samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = 0.0f;
+        samplerInfo.minLod = SamplerSettings.MinLod;
+        samplerInfo.maxLod = SamplerSettings.MaxLod;
         samplerInfo.unnormalizedCoordinates = false;
 
         VkSampler = Graphics::GetDevice().createSampler(samplerInfo);
     }
 
+    Sampler::Sampler(vk::Filter minMagFilter, vk::SamplerMipmapMode mipFilter, vk::SamplerAddressMode repeat, float maxAnisotropy, std::optional<vk::CompareOp> compareOp, float maxLod) : Sampler(ToSettings(minMagFilter, mipFilter, repeat, maxAnisotropy, compareOp, maxLod))
+    {
+    }
+
     Sampler::~Sampler()
     {
         if (VkSampler)
@@ -36,13 +98,51 @@ namespace Spinner
         }
     }
 
-    Sampler::Pointer Sampler::CreateSampler(vk::Filter minMagFilter, vk::SamplerMipmapMode mipFilter, vk::SamplerAddressMode repeat, float maxAnisotropy, std::optional<vk::CompareOp> compareOp)
+    Sampler::Pointer Sampler::CreateSampler(const Settings &settings)
     {
-        return std::make_shared<Spinner::Sampler>(minMagFilter, mipFilter, repeat, maxAnisotropy, compareOp);
+        const auto key = Normalize(settings);
+
+        std::scoped_lock lock(CacheMutex);
+        auto &cached = CachedSamplers[key];
+        if (auto sampler = cached.lock())
+        {
+            return sampler;
+        }
+
+        // Created under the lock so concurrent misses of one key never create duplicates
+        auto sampler = std::make_shared<Spinner::Sampler>(key);
+        cached = sampler;
+        if (CachedSamplers.size() >= NextPruneSize)
+        {
+            PruneExpired();
+        }
+        return sampler;
+    }
+
+    Sampler::Pointer Sampler::CreateSampler(vk::Filter minMagFilter, vk::SamplerMipmapMode mipFilter, vk::SamplerAddressMode repeat, float maxAnisotropy, std::optional<vk::CompareOp> compareOp, float maxLod)
+    {
+        return CreateSampler(ToSettings(minMagFilter, mipFilter, repeat, maxAnisotropy, compareOp, maxLod));
+    }
+
+    float Sampler::GetMaxHardwareAnisotropy()
+    {
+        static const float maxHardwareAnisotropy = Graphics::GetPhysicalDevice().getProperties().limits.maxSamplerAnisotropy;
+        return maxHardwareAnisotropy;
+    }
+
+    size_t Sampler::GetCacheSize()
+    {
+        std::scoped_lock lock(CacheMutex);
+        return CachedSamplers.size();
     }
 
     vk::Sampler Sampler::GetSampler() const
     {
         return VkSampler;
     }
+
+    const Sampler::Settings &Sampler::GetSettings() const
+    {
+        return SamplerSettings;
+    }
 } // Spinner
@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.hpp>
 #include <memory>
+#include <optional>
 
 namespace Spinner
 {
@@ -11,16 +12,51 @@ namespace Spinner
     public:
         using Pointer = std::shared_ptr<Sampler>;
 
-        explicit Sampler(vk::Filter minMagFilter = vk::Filter::eLinear, vk::SamplerMipmapMode mipFilter = vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode repeat = vk::SamplerAddressMode::eRepeat, float maxAnisotropy = 8.0f, std::optional<vk::CompareOp> compareOp = {});
+        /// The full sampler state, samplers created through CreateSampler are shared between equal settings
+        struct Settings
+        {
+            vk::Filter MinFilter = vk::Filter::eLinear;
+            vk::Filter MagFilter = vk::Filter::eLinear;
+            vk::SamplerMipmapMode MipFilter = vk::SamplerMipmapMode::eLinear;
+            vk::SamplerAddressMode AddressModeU = vk::SamplerAddressMode::eRepeat;
+            vk::SamplerAddressMode AddressModeV = vk::SamplerAddressMode::eRepeat;
+            vk::SamplerAddressMode AddressModeW = vk::SamplerAddressMode::eRepeat;
+            float MaxAnisotropy = 8.0f; // Clamped to the device's limit, 0 disables anisotropic filtering
+            std::optional<vk::CompareOp> CompareOp = {};
+            float MinLod = 0.0f;
+            float MaxLod = vk::LodClampNone; // Every mip level of the sampled image view, 0.25 samples only the first level while keeping the magnification filter
+
+            bool operator==(const Settings &other) const = default;
+        };
+
+        struct SettingsHash
+        {
+            size_t operator()(const Settings &settings) const noexcept;
+        };
+
+    public:
+        explicit Sampler(const Settings &settings);
+        /// maxLod defaults to every mip level of the sampled image view, 0.25 samples only the first level while keeping the magnification filter
+        explicit Sampler(vk::Filter minMagFilter = vk::Filter::eLinear, vk::SamplerMipmapMode mipFilter = vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode repeat = vk::SamplerAddressMode::eRepeat, float maxAnisotropy = 8.0f, std::optional<vk::CompareOp> compareOp = {}, float maxLod = vk::LodClampNone);
         virtual ~Sampler();
 
         [[nodiscard]] vk::Sampler GetSampler() const;
+        [[nodiscard]] const Settings &GetSettings() const;
 
     protected:
         vk::Sampler VkSampler;
+        Settings SamplerSettings;
 
     public:
-        static Pointer CreateSampler(vk::Filter minMagFilter = vk::Filter::eLinear, vk::SamplerMipmapMode mipFilter = vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode repeat = vk::SamplerAddressMode::eRepeat, float maxAnisotropy = 8.0f, std::optional<vk::CompareOp> compareOp = {});
+        /// Returns the existing sampler with equal settings (after clamping to the device's limits), only creating one when there is none.
+        /// Only weak references are held, so a sampler is destroyed once nothing else uses it. Safe to use from any thread
+        static Pointer CreateSampler(const Settings &settings);
+        static Pointer CreateSampler(vk::Filter minMagFilter = vk::Filter::eLinear, vk::SamplerMipmapMode mipFilter = vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode repeat = vk::SamplerAddressMode::eRepeat, float maxAnisotropy = 8.0f, std::optional<vk::CompareOp> compareOp = {}, float maxLod = vk::LodClampNone);
+
+        /// The device's maxSamplerAnisotropy, queried on first use
+        static float GetMaxHardwareAnisotropy();
+        /// Number of cached samplers, including released samplers which have not been pruned
+        static size_t GetCacheSize();
     };
 } // Spinner
 
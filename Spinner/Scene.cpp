@@ -1,28 +1,52 @@
 #include "Scene.hpp"
 
 #include <map>
+#include <deque>
+#include <future>
+#include <unordered_map>
 #include <utility>
 #include <iostream>
+#include <exception>
+#include <optional>
+#include <numeric>
+#include <cstring>
 #include <tiny_gltf.h>
 #include <imgui.h>
 #include "Utilities.hpp"
 #include "MeshBuilder.hpp"
+#include "MeshOptimizer.hpp"
 #include "MeshData/StaticMeshVertex.hpp"
+#include "MeshData/QuantizedStaticMeshVertex.hpp"
 #include "Components/Components.hpp"
 #include "Material.hpp"
 #include "Image.hpp"
 #include "Texture.hpp"
 #include "Lighting.hpp"
 #include "Graphics.hpp"
+#include "ScopedTimer.hpp"
+#include "ModelCache.hpp"
+#include "VulkanUtilities.hpp"
+#include "Ktx2File.hpp"
+#include "TextureEncoder.hpp"
+#include "TextureCache.hpp"
+#include "ObjectPool.hpp"
+#include "JobSystem.hpp"
 
 namespace Spinner
 {
     Scene::Scene(std::string name) : Name(std::move(name))
     {
-        ObjectTree = std::make_shared<Spinner::SceneObject>("Scene root", true);
+        ObjectTree = std::allocate_shared<Spinner::SceneObject>(PoolAllocator<Spinner::SceneObject>(), "Scene root", true);
         Lighting = GetGlobalLighting();
     }
 
+    Scene::~Scene()
+    {
+        // Objects still referenced elsewhere keep their slabs, every slab the scene's objects emptied goes back to the system
+        ObjectTree.reset();
+        ObjectPool::TrimShared();
+    }
+
     bool Scene::AddObjectToScene(const SceneObject::Pointer &object, SceneObject::Pointer parent)
     {
         if (object == nullptr)
@@ -45,11 +69,61 @@ namespace Spinner
         int MaterialIndex = 0;
     };
 
+    /// A primitive converted on a worker thread, its MeshBuffer is created later on the main thread
+    struct PrimitiveInformation
+    {
+        MeshBuilder Builder;
+        std::string Name;
+        int MaterialIndex = 0;
+    };
+
+    struct ConvertedMesh
+    {
+        std::vector<PrimitiveInformation> Primitives;
+        std::exception_ptr Error;
+        MeshOptimizer::Statistics OptimizationBefore;
+        MeshOptimizer::Statistics OptimizationAfter;
+    };
+
+    struct DecodedImage
+    {
+        std::vector<uint8_t> Pixels; // RGBA8 or RGBA16, or a whole block compressed mip chain
+        int Width = 0;
+        int Height = 0;
+        vk::Format Format = vk::Format::eR8G8B8A8Unorm;
+        uint64_t SourceHash = 0; // TextureCache::GetContentSource of the encoded image
+        Image::Pointer CachedImage; // A live image of the same source, decoding was skipped
+    };
+
+    /// A material texture LoadModelAsync creates once the material is already in use
+    struct PendingTexture
+    {
+        Spinner::Material::Pointer Material;
+        uint32_t Slot = 0;
+        int TextureIndex = -1;
+    };
+
     struct SceneInformation
     {
         std::vector<Spinner::Material::Pointer> Materials;
         std::string Warnings;
         size_t NodeIndex = 0;
+        ModelImportSettings Settings;
+        MeshOptimizer::Statistics OptimizationBefore;
+        MeshOptimizer::Statistics OptimizationAfter;
+
+        // Indexed by glTF image & mesh
+        std::vector<DecodedImage> Images;
+        std::vector<ConvertedMesh> ConvertedMeshes;
+        std::vector<std::vector<MeshInformation>> Meshes;
+
+        // Every GPU upload of the import is recorded into this and submitted once, or once per frame when loading asynchronously
+        CommandBuffer::Pointer UploadCommandBuffer;
+
+        // Set by LoadModelAsync, materials start with their default textures and objects without their mesh components, both are filled in as uploads complete
+        bool DeferUploads = false;
+        std::vector<PendingTexture> PendingTextures;
+        std::vector<std::vector<SceneObject::Pointer>> MeshObjects; // Indexed by glTF mesh
     };
 
     static bool DoesMeshHaveAttribute(const tinygltf::Mesh &mesh, const std::string &attribute)
@@ -68,31 +142,248 @@ namespace Spinner
         return false;
     }
 
-    static bool GetGLTFAttribute(const tinygltf::Model &model, const tinygltf::Primitive &primitive, const std::string &attributeName, tinygltf::Accessor &accessor, tinygltf::BufferView &bufferView, tinygltf::Buffer &buffer)
+    /// Typed, strided view of a glTF accessor which reads straight from the model's buffers.
+    /// Honours the buffer view's byteStride, normalized integer components and sparse substitutions
+    class AccessorView
     {
-        if (primitive.attributes.empty())
-            return false;
+    public:
+        AccessorView(const tinygltf::Model &model, const tinygltf::Accessor &accessor) : Count(accessor.count), ComponentType(accessor.componentType), ComponentCount(tinygltf::GetNumComponentsInType(accessor.type)), Normalized(accessor.normalized)
+        {
+            const int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+            if (componentSize <= 0 || ComponentCount <= 0)
+            {
+                throw std::runtime_error("Cannot read accessor \"" + accessor.name + "\" with an unknown component type or type");
+            }
+            ComponentSize = static_cast<size_t>(componentSize);
+            ElementSize = ComponentSize * ComponentCount;
+            Stride = ElementSize;
 
-        auto attribIter = primitive.attributes.find(attributeName);
-        if (attribIter == primitive.attributes.end())
+            // Accessors without a buffer view are all zeros, unless replaced by sparse values
+            if (accessor.bufferView >= 0)
+            {
+                const auto &bufferView = model.bufferViews.at(accessor.bufferView);
+                const auto &buffer = model.buffers.at(bufferView.buffer);
+                if (bufferView.byteStride != 0)
+                {
+                    Stride = bufferView.byteStride;
+                }
+
+                const size_t offset = bufferView.byteOffset + accessor.byteOffset;
+                if (Count != 0 && offset + (Count - 1) * Stride + ElementSize > buffer.data.size())
+                {
+                    throw std::runtime_error("Accessor \"" + accessor.name + "\" reads outside of its buffer");
+                }
+                Data = &buffer.data[offset];
+            }
+
+            if (accessor.sparse.isSparse && accessor.sparse.count > 0)
+            {
+                const auto &sparse = accessor.sparse;
+                const auto &indicesView = model.bufferViews.at(sparse.indices.bufferView);
+                const auto &valuesView = model.bufferViews.at(sparse.values.bufferView);
+                const auto &indicesBuffer = model.buffers.at(indicesView.buffer);
+                const auto &valuesBuffer = model.buffers.at(valuesView.buffer);
+
+                const int sparseIndexSize = tinygltf::GetComponentSizeInBytes(sparse.indices.componentType);
+                const size_t indicesOffset = indicesView.byteOffset + sparse.indices.byteOffset;
+                const size_t valuesOffset = valuesView.byteOffset + sparse.values.byteOffset;
+                if (sparseIndexSize <= 0 || indicesOffset + sparse.count * sparseIndexSize > indicesBuffer.data.size() || valuesOffset + sparse.count * ElementSize > valuesBuffer.data.size())
+                {
+                    throw std::runtime_error("Sparse accessor \"" + accessor.name + "\" reads outside of its buffers");
+                }
+
+                // Indices are strictly increasing, so they can be binary searched
+                SparseIndices.resize(sparse.count);
+                for (int i = 0; i < sparse.count; i++)
+                {
+                    SparseIndices[i] = ReadInteger(&indicesBuffer.data[indicesOffset + i * sparseIndexSize], sparse.indices.componentType);
+                }
+                SparseValues = &valuesBuffer.data[valuesOffset];
+            }
+        }
+
+        [[nodiscard]] size_t GetCount() const
         {
-            return false;
+            return Count;
         }
 
-        accessor = model.accessors.at(attribIter->second);
-        bufferView = model.bufferViews.at(accessor.bufferView);
-        buffer = model.buffers.at(bufferView.buffer);
+        [[nodiscard]] int GetComponentCount() const
+        {
+            return ComponentCount;
+        }
 
-        return true;
+        [[nodiscard]] int GetComponentType() const
+        {
+            return ComponentType;
+        }
+
+        /// Returns the elements if they can be read directly as an array, otherwise nullptr
+        [[nodiscard]] const uint8_t *GetTightlyPacked() const
+        {
+            return (Data != nullptr && Stride == ElementSize && SparseIndices.empty()) ? Data : nullptr;
+        }
+
+        /// Reads up to 4 components of an element as floats, missing components are taken from defaults
+        [[nodiscard]] glm::vec4 ReadVec4(size_t index, glm::vec4 defaults = {0.0f, 0.0f, 0.0f, 1.0f}) const
+        {
+            const uint8_t *element = GetElement(index);
+            for (int component = 0; component < std::min(ComponentCount, 4); component++)
+            {
+                defaults[component] = (element != nullptr) ? ReadFloat(element + component * ComponentSize) : 0.0f;
+            }
+            return defaults;
+        }
+
+        [[nodiscard]] glm::vec3 ReadVec3(size_t index) const
+        {
+            return glm::vec3(ReadVec4(index));
+        }
+
+        [[nodiscard]] glm::vec2 ReadVec2(size_t index) const
+        {
+            return glm::vec2(ReadVec4(index));
+        }
+
+        /// Reads the first component of an element as an unsigned integer, e.g. an index
+        [[nodiscard]] uint32_t ReadUint(size_t index) const
+        {
+            const uint8_t *element = GetElement(index);
+            return (element != nullptr) ? ReadInteger(element, ComponentType) : 0;
+        }
+
+    protected:
+        const uint8_t *Data = nullptr;
+        size_t Count;
+        size_t Stride = 0;
+        size_t ElementSize = 0;
+        size_t ComponentSize = 0;
+        int ComponentType;
+        int ComponentCount;
+        bool Normalized;
+
+        std::vector<uint32_t> SparseIndices;
+        const uint8_t *SparseValues = nullptr;
+
+    protected:
+        [[nodiscard]] const uint8_t *GetElement(size_t index) const
+        {
+            if (!SparseIndices.empty())
+            {
+                auto sparseIndex = std::lower_bound(SparseIndices.begin(), SparseIndices.end(), static_cast<uint32_t>(index));
+                if (sparseIndex != SparseIndices.end() && *sparseIndex == index)
+                {
+                    return SparseValues + (sparseIndex - SparseIndices.begin()) * ElementSize;
+                }
+            }
+
+            return (Data != nullptr) ? Data + index * Stride : nullptr;
+        }
+
+        template<typename T>
+        static T Load(const uint8_t *data)
+        {
+            // Buffer data is not necessarily aligned for T
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return value;
+        }
+
+        static uint32_t ReadInteger(const uint8_t *data, int componentType)
+        {
+            switch (componentType)
+            {
+                case TINYGLTF_COMPONENT_TYPE_BYTE:
+                    return static_cast<uint8_t>(Load<int8_t>(data));
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                    return Load<uint8_t>(data);
+                case TINYGLTF_COMPONENT_TYPE_SHORT:
+                    return static_cast<uint16_t>(Load<int16_t>(data));
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                    return Load<uint16_t>(data);
+                case TINYGLTF_COMPONENT_TYPE_INT:
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                    return Load<uint32_t>(data);
+                default:
+                    throw std::runtime_error("Cannot read an integer from component type " + std::to_string(componentType));
+            }
+        }
+
+        [[nodiscard]] float ReadFloat(const uint8_t *data) const
+        {
+            switch (ComponentType)
+            {
+                case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                    return Load<float>(data);
+                case TINYGLTF_COMPONENT_TYPE_DOUBLE:
+                    return static_cast<float>(Load<double>(data));
+                case TINYGLTF_COMPONENT_TYPE_BYTE:
+                    return Normalized ? std::max(static_cast<float>(Load<int8_t>(data)) / 127.0f, -1.0f) : static_cast<float>(Load<int8_t>(data));
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                    return Normalized ? static_cast<float>(Load<uint8_t>(data)) / 255.0f : static_cast<float>(Load<uint8_t>(data));
+                case TINYGLTF_COMPONENT_TYPE_SHORT:
+                    return Normalized ? std::max(static_cast<float>(Load<int16_t>(data)) / 32767.0f, -1.0f) : static_cast<float>(Load<int16_t>(data));
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                    return Normalized ? static_cast<float>(Load<uint16_t>(data)) / 65535.0f : static_cast<float>(Load<uint16_t>(data));
+                case TINYGLTF_COMPONENT_TYPE_INT:
+                    return static_cast<float>(Load<int32_t>(data));
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                    return static_cast<float>(Load<uint32_t>(data));
+                default:
+                    return 0.0f;
+            }
+        }
+    };
+
+    static std::optional<AccessorView> GetGLTFAttribute(const tinygltf::Model &model, const tinygltf::Primitive &primitive, const std::string &attributeName)
+    {
+        auto attribIter = primitive.attributes.find(attributeName);
+        if (attribIter == primitive.attributes.end() || attribIter->second < 0)
+        {
+            return std::nullopt;
+        }
+
+        return AccessorView(model, model.accessors.at(attribIter->second));
     }
 
-    static std::vector<MeshInformation> CreateStaticMeshBuffersFromMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh)
+    /// Replaces a triangle list with the concatenated index ranges of successively simplified levels of detail, returning the ranges
+    static std::vector<MeshBuffer::Lod> GenerateLods(std::vector<MeshBuffer::IndexType> &indices, const std::vector<glm::vec3> &positions, float extent)
     {
-        tinygltf::Accessor accessor;
-        tinygltf::BufferView bufferView;
-        tinygltf::Buffer buffer;
+        constexpr uint32_t MaxLodCount = 6;
+        constexpr size_t MinTriangleCount = 64;
+        // Levels which remove less than this fraction of the previous level's triangles are not worth their indices
+        constexpr float MinReduction = 0.1f;
+        // Relative to the mesh's extent, beyond this the silhouette has visibly changed at any distance
+        constexpr float MaxRelativeError = 0.1f;
+
+        std::vector<MeshBuffer::Lod> lods = {MeshBuffer::Lod{0, static_cast<uint32_t>(indices.size()), 0.0f}};
+        std::vector<MeshBuffer::IndexType> previous = indices;
+        float totalRelativeError = 0.0f;
+
+        while (lods.size() < MaxLodCount && previous.size() / 3 > MinTriangleCount && totalRelativeError < MaxRelativeError)
+        {
+            float relativeError = 0.0f;
+            auto simplified = MeshOptimizer::Simplify(previous, positions, previous.size() / 6 * 3, MaxRelativeError - totalRelativeError, &relativeError);
+            if (simplified.empty() || static_cast<float>(simplified.size()) > static_cast<float>(previous.size()) * (1.0f - MinReduction))
+            {
+                break;
+            }
+
+            MeshOptimizer::OptimizeVertexCache(simplified, positions.size());
 
-        std::vector<MeshInformation> meshes;
+            // Each level is simplified from the previous one, so its distance from the full detail surface is bounded by the sum of the errors
+            totalRelativeError += relativeError;
+            lods.push_back(MeshBuffer::Lod{static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(simplified.size()), totalRelativeError * extent});
+            indices.insert(indices.end(), simplified.begin(), simplified.end());
+            previous = std::move(simplified);
+        }
+
+        return lods;
+    }
+
+    // Thread safe, only reads from the model
+    static std::vector<PrimitiveInformation> ConvertStaticMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh, const ModelImportSettings &settings, MeshOptimizer::Statistics &optimizationBefore, MeshOptimizer::Statistics &optimizationAfter)
+    {
+        std::vector<PrimitiveInformation> primitives;
 
         int64_t primitiveIndex = -1;
         for (auto &primitive : mesh.primitives)
@@ -100,132 +391,87 @@ namespace Spinner
             primitiveIndex++;
             std::vector<MeshData::StaticMeshVertex> vertices;
             std::vector<MeshBuffer::IndexType> indices;
+            std::vector<MeshBuffer::ShortIndexType> shortIndices;
 
             // Position
-            size_t vertexCount = 0;
-            if (GetGLTFAttribute(model, primitive, "POSITION", accessor, bufferView, buffer))
+            auto positions = GetGLTFAttribute(model, primitive, "POSITION");
+            const size_t vertexCount = positions.has_value() ? positions->GetCount() : 0;
+            if (vertexCount == 0)
             {
-                vertexCount = accessor.count;
-
-                if (vertices.size() + vertexCount > std::numeric_limits<MeshBuffer::IndexType>::max() - 1)
-                {
-                    throw std::runtime_error(std::string("Cannot create mesh ") + mesh.name + " as it has too many vertices");
-                }
-
-                vertices.resize(vertexCount);
-
-                auto positionBuffer = reinterpret_cast<const float *>(&buffer.data.at(bufferView.byteOffset + accessor.byteOffset));
-                for (size_t i = 0; i < accessor.count; i++)
-                {
-                    auto &vertex = vertices[i];
-
-                    glm::vec3 position = {positionBuffer[i * 3 + 0], positionBuffer[i * 3 + 1], positionBuffer[i * 3 + 2]};
-                    vertex.Position = position;
-                }
+                continue;
+            }
+            if (vertexCount > std::numeric_limits<MeshBuffer::IndexType>::max() - 1)
+            {
+                throw std::runtime_error(std::string("Cannot create mesh ") + mesh.name + " as it has too many vertices");
             }
 
-            if (vertexCount == 0)
+            vertices.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
             {
-                continue;
+                vertices[i].Position = positions->ReadVec3(i);
             }
 
             // Indices
+            if (primitive.indices >= 0)
             {
-                accessor = model.accessors.at(primitive.indices);
-
-                bufferView = model.bufferViews.at(accessor.bufferView);
-                buffer = model.buffers.at(bufferView.buffer);
+                AccessorView indexView(model, model.accessors.at(primitive.indices));
+                const uint8_t *packedIndices = indexView.GetTightlyPacked();
 
-                indices.resize(accessor.count);
-
-                const void *indexBuffer = (&buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-                for (size_t i = 0; i < accessor.count; i++)
+                // 16 bit indices are copied as they are, rather than widened and narrowed again by MeshBuilder
+                if (packedIndices != nullptr && indexView.GetComponentType() == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT && vertexCount <= MeshBuffer::MaxShortIndexVertexCount)
                 {
-                    MeshBuffer::IndexType index = 0;
-
-                    switch (accessor.componentType)
+                    shortIndices.resize(indexView.GetCount());
+                    std::memcpy(shortIndices.data(), packedIndices, shortIndices.size() * sizeof(MeshBuffer::ShortIndexType));
+                }
+                else
+                {
+                    indices.resize(indexView.GetCount());
+                    for (size_t i = 0; i < indices.size(); i++)
                     {
-                        case TINYGLTF_COMPONENT_TYPE_BYTE:
-                            index = static_cast<MeshBuffer::IndexType>(static_cast<uint8_t>(reinterpret_cast<const int8_t *>(indexBuffer)[i]));
-                            break;
-                        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                            index = static_cast<MeshBuffer::IndexType>(reinterpret_cast<const uint8_t *>(indexBuffer)[i]);
-                            break;
-                        case TINYGLTF_COMPONENT_TYPE_SHORT:
-                            index = static_cast<MeshBuffer::IndexType>(reinterpret_cast<const int16_t *>(indexBuffer)[i]);
-                            break;
-                        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                            index = static_cast<MeshBuffer::IndexType>(reinterpret_cast<const uint16_t *>(indexBuffer)[i]);
-                            break;
-                        case TINYGLTF_COMPONENT_TYPE_INT:
-                            index = static_cast<MeshBuffer::IndexType>(reinterpret_cast<const int32_t *>(indexBuffer)[i]);
-                            break;
-                        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-                            index = static_cast<MeshBuffer::IndexType>(reinterpret_cast<const uint32_t *>(indexBuffer)[i]);
-                            break;
+                        indices[i] = indexView.ReadUint(i);
                     }
-
-                    indices[i] = index;
                 }
             }
+            else
+            {
+                // Non-indexed primitive
+                indices.resize(vertexCount);
+                std::iota(indices.begin(), indices.end(), 0);
+            }
 
             // Normal
-            if (GetGLTFAttribute(model, primitive, "NORMAL", accessor, bufferView, buffer))
+            if (auto normals = GetGLTFAttribute(model, primitive, "NORMAL"))
             {
-                auto normalBuffer = reinterpret_cast<const float *>(&buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-                for (size_t i = 0; i < accessor.count; i++)
+                for (size_t i = 0; i < std::min(normals->GetCount(), vertexCount); i++)
                 {
-                    auto &vertex = vertices[i];
-
-                    glm::vec3 normal = {normalBuffer[i * 3 + 0], normalBuffer[i * 3 + 1], normalBuffer[i * 3 + 2]};
-                    vertex.Normal = normal;
+                    vertices[i].Normal = normals->ReadVec3(i);
                 }
             }
 
             // Tangent
-            if (GetGLTFAttribute(model, primitive, "TANGENT", accessor, bufferView, buffer))
+            if (auto tangents = GetGLTFAttribute(model, primitive, "TANGENT"))
             {
-                auto tangentBuffer = reinterpret_cast<const float *>(&buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-                for (size_t i = 0; i < accessor.count; i++)
+                for (size_t i = 0; i < std::min(tangents->GetCount(), vertexCount); i++)
                 {
-                    auto &vertex = vertices[i];
-
-                    glm::vec4 tangent = {tangentBuffer[i * 4 + 0], tangentBuffer[i * 4 + 1], tangentBuffer[i * 4 + 2], tangentBuffer[i * 4 + 3]};
-                    vertex.Tangent = tangent;
+                    vertices[i].Tangent = tangents->ReadVec4(i);
                 }
             }
 
             // UV
-            if (GetGLTFAttribute(model, primitive, "TEXCOORD_0", accessor, bufferView, buffer))
+            if (auto uvs = GetGLTFAttribute(model, primitive, "TEXCOORD_0"))
             {
-                auto uvBuffer = reinterpret_cast<const float *>(&buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-                for (size_t i = 0; i < accessor.count; i++)
+                for (size_t i = 0; i < std::min(uvs->GetCount(), vertexCount); i++)
                 {
-                    auto &vertex = vertices[i];
-
-                    glm::vec2 uv = {uvBuffer[i * 2 + 0], uvBuffer[i * 2 + 1]};
-                    vertex.UV = uv;
+                    vertices[i].UV = uvs->ReadVec2(i);
                 }
             }
 
-            // Color
-            if (GetGLTFAttribute(model, primitive, "COLOR_0", accessor, bufferView, buffer))
+            // Color, VEC3 or VEC4 (alpha is unused)
+            if (auto colors = GetGLTFAttribute(model, primitive, "COLOR_0"))
             {
-                auto colorBuffer = reinterpret_cast<const float *>(&buffer.data[bufferView.byteOffset + accessor.byteOffset]);
-                for (size_t i = 0; i < accessor.count; i++)
+                for (size_t i = 0; i < std::min(colors->GetCount(), vertexCount); i++)
                 {
-                    auto &vertex = vertices[i];
-
-                    if (accessor.type == TINYGLTF_TYPE_VEC3)
-                    {
-                        glm::vec4 color = {colorBuffer[i * 3 + 0], colorBuffer[i * 3 + 1], colorBuffer[i * 3 + 2], 1.0f};
-                        vertex.Color = color;
-                    }
-                    else if (accessor.type == TINYGLTF_TYPE_VEC4)
-                    {
-                        glm::vec4 color = {colorBuffer[i * 4 + 0], colorBuffer[i * 4 + 1], colorBuffer[i * 4 + 2], colorBuffer[i * 4 + 3]};
-                        vertex.Color = color;
-                    }
+                    vertices[i].Color = colors->ReadVec3(i);
                 }
             }
 
@@ -235,131 +481,389 @@ namespace Spinner
                 meshName = model.materials.at(primitive.material).name;
             }
 
-            meshes.emplace_back(MeshData::StaticMeshVertex::CreateMeshBuilder().SetIndices(indices).SetVertexData(vertices).Create(), meshName, primitive.material);
+            if (settings.OptimizeMeshes && (primitive.mode == TINYGLTF_MODE_TRIANGLES || primitive.mode == -1))
+            {
+                if (!shortIndices.empty())
+                {
+                    indices.assign(shortIndices.begin(), shortIndices.end());
+                    shortIndices.clear();
+                }
+
+                if (indices.size() % 3 == 0)
+                {
+                    MeshOptimizer::Statistics before, after;
+                    MeshOptimizer::OptimizeMesh(vertices, indices, &before, &after);
+                    optimizationBefore += before;
+                    optimizationAfter += after;
+                }
+            }
+
+            // Nothing to draw, an index accessor may be empty and optimizing drops every vertex of a primitive with only degenerate triangles
+            if (vertices.empty() || (indices.empty() && shortIndices.empty()))
+            {
+                continue;
+            }
+
+            // Bounds for LOD selection
+            glm::vec3 boundsMin = vertices[0].Position;
+            glm::vec3 boundsMax = vertices[0].Position;
+            for (const auto &vertex : vertices)
+            {
+                boundsMin = glm::min(boundsMin, vertex.Position);
+                boundsMax = glm::max(boundsMax, vertex.Position);
+            }
+            const glm::vec3 boundsCenter = (boundsMin + boundsMax) * 0.5f;
+            float boundsRadius = 0.0f;
+            for (const auto &vertex : vertices)
+            {
+                boundsRadius = std::max(boundsRadius, glm::length(vertex.Position - boundsCenter));
+            }
+
+            std::vector<MeshBuffer::Lod> lods;
+            if (settings.GenerateLods && (primitive.mode == TINYGLTF_MODE_TRIANGLES || primitive.mode == -1))
+            {
+                if (!shortIndices.empty())
+                {
+                    indices.assign(shortIndices.begin(), shortIndices.end());
+                    shortIndices.clear();
+                }
+
+                if (indices.size() % 3 == 0)
+                {
+                    std::vector<glm::vec3> vertexPositions(vertices.size());
+                    std::transform(vertices.begin(), vertices.end(), vertexPositions.begin(), [](const MeshData::StaticMeshVertex &vertex) { return vertex.Position; });
+
+                    const glm::vec3 boundsSize = boundsMax - boundsMin;
+                    lods = GenerateLods(indices, vertexPositions, std::max(boundsSize.x, std::max(boundsSize.y, boundsSize.z)));
+                }
+            }
+
+            auto builder = settings.QuantizeVertices ? MeshData::QuantizedStaticMeshVertex::CreateMeshBuilder(vertices, settings.QuantizePositions) : MeshData::StaticMeshVertex::CreateMeshBuilder();
+            if (!settings.QuantizeVertices)
+            {
+                builder.SetVertexData(vertices);
+            }
+            builder.SetLods(lods);
+            builder.SetBoundingSphere(boundsCenter, boundsRadius);
+
+            if (!shortIndices.empty())
+            {
+                builder.SetIndices(shortIndices);
+            }
+            else
+            {
+                builder.SetIndices(indices);
+            }
+
+            primitives.push_back(PrimitiveInformation{std::move(builder), meshName, primitive.material});
         }
 
-        return meshes;
+        return primitives;
     }
 
-    static std::vector<MeshInformation> CreateSkinnedMeshBuffersFromMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh)
+    static std::vector<PrimitiveInformation> ConvertSkinnedMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh)
     {
         throw std::runtime_error("Cannot currently create mesh buffer from a skinned mesh");
     }
 
-    static std::vector<MeshInformation> CreateMeshBuffersFromMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh)
+    static void ConvertMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh, const ModelImportSettings &settings, ConvertedMesh &convertedMesh)
     {
-        if (!DoesMeshHaveAttribute(mesh, "POSITION"))
+        try
         {
-            throw std::runtime_error("Cannot create mesh buffer from mesh without any POSITION element");
-        }
+            if (!DoesMeshHaveAttribute(mesh, "POSITION"))
+            {
+                throw std::runtime_error("Cannot create mesh buffer from mesh without any POSITION element");
+            }
 
-        // Skinned mesh
-        if (DoesMeshHaveAttribute(mesh, "WEIGHTS_0"))
+            // Skinned mesh
+            if (DoesMeshHaveAttribute(mesh, "WEIGHTS_0"))
+            {
+                convertedMesh.Primitives = ConvertSkinnedMesh(model, mesh);
+                return;
+            }
+            // else Static mesh
+            convertedMesh.Primitives = ConvertStaticMesh(model, mesh, settings, convertedMesh.OptimizationBefore, convertedMesh.OptimizationAfter);
+        }
+        catch (...)
         {
-            return CreateSkinnedMeshBuffersFromMesh(model, mesh);
+            // Rethrown on the main thread when a node uses this mesh
+            convertedMesh.Error = std::current_exception();
         }
-        // else Static mesh
-        return CreateStaticMeshBuffersFromMesh(model, mesh);
     }
 
-    static SceneObject::Pointer CreateSceneObjectFromMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh, std::string nodeName, SceneInformation &sceneInfo)
+    static vk::Format GetDecodedImageFormat(bool is16Bit, int components = 4)
     {
-        if (nodeName.empty())
+        if (components == 3)
         {
-            nodeName = mesh.name;
+            return is16Bit ? vk::Format::eR16G16B16Unorm : vk::Format::eR8G8B8Unorm;
         }
-        if (nodeName.empty())
+        return is16Bit ? vk::Format::eR16G16B16A16Unorm : vk::Format::eR8G8B8A8Unorm;
+    }
+
+    // Every format an encoded image may be imported as, a source only ever produces one of them
+    static std::vector<vk::Format> GetImportedImageFormats(const ModelImportSettings &settings)
+    {
+        if (settings.CompressTextures)
         {
-            nodeName = std::string("Mesh ") + std::to_string(sceneInfo.NodeIndex++);
+            return {vk::Format::eBc1RgbUnormBlock, vk::Format::eBc3UnormBlock, GetDecodedImageFormat(true)};
         }
+        return {GetDecodedImageFormat(false), GetDecodedImageFormat(true)};
+    }
 
-        auto sceneObject = std::make_shared<SceneObject>(nodeName);
+    static void DecodeImage(const std::vector<uint8_t> &encodedImage, const ModelImportSettings &settings, DecodedImage &decodedImage)
+    {
+        if (encodedImage.empty())
+        {
+            return;
+        }
 
-        auto meshes = CreateMeshBuffersFromMesh(model, mesh);
+        decodedImage.SourceHash = TextureCache::GetContentSource(encodedImage);
 
-        for (auto &meshInformation : meshes)
+        // An image another material or model already uploaded needs no decoding, unless the pixels are baked into the model cache
+        if (!settings.UseModelCache)
         {
-            auto meshBuffer = meshInformation.MeshBuffer;
-            auto meshName = meshInformation.Name;
-            auto meshComponent = sceneObject->AddComponent<Components::MeshComponent>();
-            meshComponent->SetMeshBuffer(meshBuffer);
-            meshComponent->SetShaderGroup(MeshData::StaticMeshVertex::ShaderGroup);
-            meshComponent->SetShadowShaderGroup(MeshData::StaticMeshVertex::ShadowShaderGroup);
-            meshComponent->SetComponentName(meshName);
-
-            if (meshInformation.MaterialIndex >= 0)
+            for (const auto format : GetImportedImageFormats(settings))
             {
-                meshComponent->SetMaterial(sceneInfo.Materials.at(meshInformation.MaterialIndex));
+                if (auto image = TextureCache::Find({decodedImage.SourceHash, format, Image::FullMipChain}))
+                {
+                    decodedImage.CachedImage = std::move(image);
+                    decodedImage.Format = format;
+                    return;
+                }
             }
-            else
+        }
+
+        // A previous import's block compressed mip chain replaces decoding
+        if (settings.CompressTextures)
+        {
+            if (auto cached = TextureEncoder::LoadCached(decodedImage.SourceHash))
             {
-                auto material = Material::CreateMaterial("Unnamed Material");
-                meshComponent->SetMaterial(material);
+                decodedImage.Pixels = cached->GetData();
+                decodedImage.Width = static_cast<int>(cached->GetExtent().width);
+                decodedImage.Height = static_cast<int>(cached->GetExtent().height);
+                decodedImage.Format = cached->GetFormat();
+                return;
             }
         }
 
-        return sceneObject;
+        int channels = 0;
+        bool is16Bit = false;
+        decodedImage.Pixels = Image::DecodeEmbeddedImageData(encodedImage, decodedImage.Width, decodedImage.Height, channels, is16Bit);
+        decodedImage.Format = GetDecodedImageFormat(is16Bit);
     }
 
-    static SceneObject::Pointer CreateEmptySceneObject(const std::string &nodeName)
+    /// CPU import stage, decodes images and converts meshes on the job system
+    static void DecodeImagesAndConvertMeshes(const tinygltf::Model &model, const std::vector<std::vector<uint8_t>> &encodedImages, SceneInformation &sceneInfo)
     {
-        return std::make_shared<SceneObject>(nodeName);
-    }
+        sceneInfo.Images.resize(encodedImages.size());
+        sceneInfo.ConvertedMeshes.resize(model.meshes.size());
 
-    static SceneObject::Pointer CreateSceneObjectFromLight(const tinygltf::Model &model, const tinygltf::Light &light, std::string nodeName, SceneInformation &sceneInfo)
-    {
-        if (nodeName.empty())
+        // One image or mesh per job, each is a large piece of work
+        JobSystem::ParallelForOrInline(encodedImages.size() + model.meshes.size(), 1, [&](size_t begin, size_t end)
         {
-            nodeName = light.name;
-        }
-        if (nodeName.empty())
+            for (size_t i = begin; i < end; i++)
+            {
+                if (i < encodedImages.size())
+                {
+                    try
+                    {
+                        DecodeImage(encodedImages[i], sceneInfo.Settings, sceneInfo.Images[i]);
+                    }
+                    catch (...)
+                    {
+                        // An empty image falls back to loading from the image's URI
+                        sceneInfo.Images[i] = {};
+                    }
+                    continue;
+                }
+
+                const size_t meshIndex = i - encodedImages.size();
+                ConvertMesh(model, model.meshes[meshIndex], sceneInfo.Settings, sceneInfo.ConvertedMeshes[meshIndex]);
+            }
+        });
+
+        for (auto &convertedMesh : sceneInfo.ConvertedMeshes)
         {
-            nodeName = std::string("Light ") + std::to_string(sceneInfo.NodeIndex++);
+            sceneInfo.OptimizationBefore += convertedMesh.OptimizationBefore;
+            sceneInfo.OptimizationAfter += convertedMesh.OptimizationAfter;
         }
+    }
 
-        auto sceneObject = std::make_shared<SceneObject>(nodeName);
-        auto lightComponent = sceneObject->AddComponent<Components::LightComponent>();
-
+    /// CPU import stage, block compresses the 8 bit images which were not in the texture cache and caches them.
+    /// Each image is encoded across threads, so the images themselves are encoded one at a time
+    static void EncodeImages(SceneInformation &sceneInfo)
+    {
+        if (!sceneInfo.Settings.CompressTextures)
+        {
+            return;
+        }
 
-        // https://github.com/KhronosGroup/glTF/blob/main/extensions/2.0/Khronos/KHR_lights_punctual/README.md
-        if (!light.type.empty())
+        for (auto &decodedImage : sceneInfo.Images)
         {
-            if (light.type == "point")
+            if (decodedImage.Pixels.empty() || decodedImage.Format != vk::Format::eR8G8B8A8Unorm)
             {
-                lightComponent->SetLightType(LightType::Point);
-            }
-            else if (light.type == "spot")
-            {
-                lightComponent->SetLightType(LightType::Spot);
+                continue;
             }
-            else if (light.type == "directional")
+
+            const vk::Extent2D extent{static_cast<uint32_t>(decodedImage.Width), static_cast<uint32_t>(decodedImage.Height)};
+            const uint32_t mipLevels = Image::GetMipLevelCount({extent.width, extent.height, 1});
+            const vk::Format format = TextureEncoder::ChooseFormat(decodedImage.Pixels.data(), static_cast<size_t>(extent.width) * extent.height);
+            const Ktx2File encoded(format, extent, mipLevels, TextureEncoder::EncodeMipChain(format, decodedImage.Pixels.data(), extent, mipLevels));
+
+            try
             {
-                lightComponent->SetLightType(LightType::Directional);
+                TextureEncoder::StoreCached(decodedImage.SourceHash, encoded);
             }
-            else
+            catch (const std::exception &e)
             {
-                lightComponent->SetLightType(LightType::None);
+                sceneInfo.Warnings += std::string("Could not cache a compressed texture: ") + e.what() + "\n";
             }
+
+            decodedImage.Pixels = encoded.GetData();
+            decodedImage.Format = format;
         }
+    }
 
-        if (light.color.size() >= 3)
+    /// Records the uploads of one mesh's primitives into the import's command buffer, expects sceneInfo.Meshes to be sized
+    static void CreateMeshBuffer(SceneInformation &sceneInfo, size_t meshIndex)
+    {
+        auto &convertedMesh = sceneInfo.ConvertedMeshes[meshIndex];
+        for (auto &primitive : convertedMesh.Primitives)
         {
-            lightComponent->SetLightColor(glm::vec3(glm::make_vec3(light.color.data())));
+            sceneInfo.Meshes[meshIndex].push_back(MeshInformation{primitive.Builder.Create(sceneInfo.UploadCommandBuffer), primitive.Name, primitive.MaterialIndex});
         }
-        else
+        // The CPU side copies are no longer needed, unless they are written to the model cache
+        if (!sceneInfo.Settings.UseModelCache)
         {
-            lightComponent->SetLightColor(glm::vec3(1.0f, 1.0f, 1.0f));
+            convertedMesh.Primitives.clear();
         }
+    }
 
-        auto intensity = static_cast<float>(light.intensity);
-        // Do some dirty conversions from the candela/lux units into Blender's intensity units (1.0)
-        if (lightComponent->GetLightType() == LightType::Directional)
+    /// GPU import stage, records the mesh buffer uploads into the import's command buffer
+    static void CreateMeshBuffers(SceneInformation &sceneInfo)
+    {
+        sceneInfo.Meshes.resize(sceneInfo.ConvertedMeshes.size());
+        for (size_t i = 0; i < sceneInfo.ConvertedMeshes.size(); i++)
         {
-            intensity /= 683.0f;
+            CreateMeshBuffer(sceneInfo, i);
         }
-        else
+    }
+
+    /// Used by both the importer and the model cache, a null material creates an unnamed one
+    static void AddMeshComponent(const SceneObject::Pointer &sceneObject, const MeshBuffer::Pointer &meshBuffer, const std::string &meshName, Material::Pointer material, bool quantized)
+    {
+        const auto &shaderGroup = quantized ? MeshData::QuantizedStaticMeshVertex::ShaderGroup : MeshData::StaticMeshVertex::ShaderGroup;
+        const auto &shadowShaderGroup = quantized ? MeshData::QuantizedStaticMeshVertex::ShadowShaderGroup : MeshData::StaticMeshVertex::ShadowShaderGroup;
+
+        auto meshComponent = sceneObject->AddComponent<Components::MeshComponent>();
+        meshComponent->SetMeshBuffer(meshBuffer);
+        meshComponent->SetShaderGroup(shaderGroup);
+        meshComponent->SetShadowShaderGroup(shadowShaderGroup);
+        meshComponent->SetComponentName(meshName);
+
+        if (material == nullptr)
         {
-            intensity /= 54.3514f * 1000.0f; // also convert Blender's 1000 intensity down to 1 intensity
+            material = Material::CreateMaterial("Unnamed Material");
+        }
+        meshComponent->SetMaterial(material);
+    }
+
+    static void AddMeshComponents(const SceneObject::Pointer &sceneObject, size_t meshIndex, const SceneInformation &sceneInfo)
+    {
+        for (const auto &meshInformation : sceneInfo.Meshes.at(meshIndex))
+        {
+            auto material = (meshInformation.MaterialIndex >= 0) ? sceneInfo.Materials.at(meshInformation.MaterialIndex) : nullptr;
+            AddMeshComponent(sceneObject, meshInformation.MeshBuffer, meshInformation.Name, material, sceneInfo.Settings.QuantizeVertices);
+        }
+    }
+
+    static SceneObject::Pointer CreateSceneObjectFromMesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh, size_t meshIndex, std::string nodeName, SceneInformation &sceneInfo)
+    {
+        if (const auto &error = sceneInfo.ConvertedMeshes.at(meshIndex).Error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        if (nodeName.empty())
+        {
+            nodeName = mesh.name;
+        }
+        if (nodeName.empty())
+        {
+            nodeName = std::string("Mesh ") + std::to_string(sceneInfo.NodeIndex++);
+        }
+
+        auto sceneObject = SceneObject::Create(nodeName);
+
+        if (sceneInfo.DeferUploads)
+        {
+            sceneInfo.MeshObjects.at(meshIndex).push_back(sceneObject);
+            return sceneObject;
+        }
+
+        AddMeshComponents(sceneObject, meshIndex, sceneInfo);
+        return sceneObject;
+    }
+
+    static SceneObject::Pointer CreateEmptySceneObject(const std::string &nodeName)
+    {
+        return SceneObject::Create(nodeName);
+    }
+
+    static SceneObject::Pointer CreateSceneObjectFromLight(const tinygltf::Model &model, const tinygltf::Light &light, std::string nodeName, SceneInformation &sceneInfo)
+    {
+        if (nodeName.empty())
+        {
+            nodeName = light.name;
+        }
+        if (nodeName.empty())
+        {
+            nodeName = std::string("Light ") + std::to_string(sceneInfo.NodeIndex++);
+        }
+
+        auto sceneObject = SceneObject::Create(nodeName);
+        auto lightComponent = sceneObject->AddComponent<Components::LightComponent>();
+
+
+        // https://github.com/KhronosGroup/glTF/blob/main/extensions/2.0/Khronos/KHR_lights_punctual/README.md
+        if (!light.type.empty())
+        {
+            if (light.type == "point")
+            {
+                lightComponent->SetLightType(LightType::Point);
+            }
+            else if (light.type == "spot")
+            {
+                lightComponent->SetLightType(LightType::Spot);
+            }
+            else if (light.type == "directional")
+            {
+                lightComponent->SetLightType(LightType::Directional);
+            }
+            else
+            {
+                lightComponent->SetLightType(LightType::None);
+            }
+        }
+
+        if (light.color.size() >= 3)
+        {
+            lightComponent->SetLightColor(glm::vec3(glm::make_vec3(light.color.data())));
+        }
+        else
+        {
+            lightComponent->SetLightColor(glm::vec3(1.0f, 1.0f, 1.0f));
+        }
+
+        auto intensity = static_cast<float>(light.intensity);
+        // Do some dirty conversions from the candela/lux units into Blender's intensity units (1.0)
+        if (lightComponent->GetLightType() == LightType::Directional)
+        {
+            intensity /= 683.0f;
+        }
+        else
+        {
+            intensity /= 54.3514f * 1000.0f; // also convert Blender's 1000 intensity down to 1 intensity
         }
         lightComponent->SetLightStrength(intensity);
 
@@ -384,7 +888,7 @@ namespace Spinner
             if (node.mesh >= 0)
             {
                 auto &mesh = model.meshes.at(node.mesh);
-                sceneObject = CreateSceneObjectFromMesh(model, mesh, node.name, sceneInfo);
+                sceneObject = CreateSceneObjectFromMesh(model, mesh, static_cast<size_t>(node.mesh), node.name, sceneInfo);
             }
             else if (node.light >= 0)
             {
@@ -424,14 +928,17 @@ namespace Spinner
             }
 
             // Child nodes
+            std::vector<SceneObject::Pointer> children;
+            children.reserve(node.children.size());
             for (auto childId : node.children)
             {
                 auto child = CreateSceneObjectFromNode(model, childId, sceneInfo);
                 if (child != nullptr)
                 {
-                    sceneObject->AddChild(child);
+                    children.push_back(std::move(child));
                 }
             }
+            sceneObject->AttachChildren(children);
         } catch (const std::exception &ex)
         {
             std::string modelName = model.scenes.at(model.defaultScene).name;
@@ -447,8 +954,10 @@ namespace Spinner
         {
             return nullptr;
         }
-        auto sceneObject = std::make_shared<SceneObject>(scene.name);
+        auto sceneObject = SceneObject::Create(scene.name);
 
+        std::vector<SceneObject::Pointer> nodeObjects;
+        nodeObjects.reserve(scene.nodes.size());
         for (auto node : scene.nodes)
         {
             auto nodeObject = CreateSceneObjectFromNode(model, node, sceneInfo);
@@ -457,49 +966,81 @@ namespace Spinner
                 continue;
             }
 
-            sceneObject->AddChild(nodeObject);
+            nodeObjects.push_back(std::move(nodeObject));
         }
+        sceneObject->AttachChildren(nodeObjects);
 
         return sceneObject;
     }
 
-    // Note: will not acknowledge magFilter's setting
-    // Note: will not acknowledge wrapT's setting
-    static Sampler::Pointer CreateSamplerFromTexture(const tinygltf::Model &model, const tinygltf::Texture &texture)
+    static vk::SamplerAddressMode GetAddressModeFromWrap(int wrap)
     {
-        // Sampler selecting
-        vk::Filter minMagFilter = vk::Filter::eLinear;
-        vk::SamplerMipmapMode mipFilter = vk::SamplerMipmapMode::eLinear;
-        vk::SamplerAddressMode repeat = vk::SamplerAddressMode::eRepeat;
-        if (texture.sampler >= 0)
-        {
-            auto &colorSampler = model.samplers.at(texture.sampler);
-            switch (colorSampler.minFilter)
-            {
-                case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST:
-                    mipFilter = vk::SamplerMipmapMode::eNearest;
-                case TINYGLTF_TEXTURE_FILTER_NEAREST:
-                case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST:
-                    minMagFilter = vk::Filter::eNearest;
-                    break;
-                default:
-                    break;
-            }
+        switch (wrap)
+        {
+            case TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE:
+                return vk::SamplerAddressMode::eClampToEdge;
+            case TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT:
+                return vk::SamplerAddressMode::eMirroredRepeat;
+            default:
+                return vk::SamplerAddressMode::eRepeat;
+        }
+    }
 
-            switch (colorSampler.wrapS)
-            {
-                case TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE:
-                    repeat = vk::SamplerAddressMode::eClampToEdge;
-                    break;
-                case TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT:
-                    repeat = vk::SamplerAddressMode::eMirroredRepeat;
-                    break;
-                default:
-                    break;
-            }
+    static Sampler::Settings GetSamplerSettingsFromTexture(const tinygltf::Model &model, const tinygltf::Texture &texture)
+    {
+        Sampler::Settings settings;
+        if (texture.sampler < 0)
+        {
+            return settings;
+        }
+
+        const auto &colorSampler = model.samplers.at(texture.sampler);
+        switch (colorSampler.minFilter)
+        {
+            case TINYGLTF_TEXTURE_FILTER_NEAREST:
+                settings.MinFilter = vk::Filter::eNearest;
+                settings.MaxLod = 0.25f; // Minification filters without a mipmap mode only sample the first level
+                break;
+            case TINYGLTF_TEXTURE_FILTER_LINEAR:
+                settings.MaxLod = 0.25f;
+                break;
+            case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST:
+                settings.MinFilter = vk::Filter::eNearest;
+                settings.MipFilter = vk::SamplerMipmapMode::eNearest;
+                break;
+            case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST:
+                settings.MipFilter = vk::SamplerMipmapMode::eNearest;
+                break;
+            case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_LINEAR:
+                settings.MinFilter = vk::Filter::eNearest;
+                break;
+            default:
+                break;
         }
 
-        return Sampler::CreateSampler(minMagFilter, mipFilter, repeat);
+        if (colorSampler.magFilter == TINYGLTF_TEXTURE_FILTER_NEAREST)
+        {
+            settings.MagFilter = vk::Filter::eNearest;
+        }
+
+        settings.AddressModeU = GetAddressModeFromWrap(colorSampler.wrapS);
+        settings.AddressModeV = GetAddressModeFromWrap(colorSampler.wrapT);
+        return settings;
+    }
+
+    static Sampler::Pointer CreateSamplerFromTexture(const tinygltf::Model &model, const tinygltf::Texture &texture)
+    {
+        return Sampler::CreateSampler(GetSamplerSettingsFromTexture(model, texture));
+    }
+
+    static std::string GetTextureFilenameFromUri(const std::string &uri)
+    {
+        // Strip non-filename data (like relative paths), 'data:' URIs are not supported
+        if (uri.empty() || uri.starts_with("data:"))
+        {
+            return {};
+        }
+        return std::filesystem::path(uri).filename().string();
     }
 
     // Note: loads an invalid texture (magenta) when failing to load the texture
@@ -511,7 +1052,25 @@ namespace Spinner
             return nullptr;
         }
 
-        auto image = model.images.at(texture.source);
+        // Already in the texture cache when decoding
+        if (static_cast<size_t>(texture.source) < sceneInfo.Images.size() && sceneInfo.Images[texture.source].CachedImage != nullptr)
+        {
+            return sceneInfo.Images[texture.source].CachedImage;
+        }
+
+        // Decoded on a worker thread. Textures sharing the image, in this model or any other, share one upload through the texture cache
+        if (static_cast<size_t>(texture.source) < sceneInfo.Images.size() && !sceneInfo.Images[texture.source].Pixels.empty())
+        {
+            const auto &decodedImage = sceneInfo.Images[texture.source];
+            return TextureCache::GetOrCreate({decodedImage.SourceHash, decodedImage.Format, Image::FullMipChain}, [&decodedImage, &sceneInfo]()
+            {
+                auto loadedImage = Image::CreateImage({static_cast<uint32_t>(decodedImage.Width), static_cast<uint32_t>(decodedImage.Height)}, decodedImage.Format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, Image::FullMipChain);
+                loadedImage->Write(decodedImage.Pixels, vk::ImageAspectFlagBits::eColor, sceneInfo.UploadCommandBuffer);
+                return loadedImage;
+            });
+        }
+
+        const auto &image = model.images.at(texture.source);
         if (!image.image.empty())
         {
             if (image.width == 0 || image.height == 0)
@@ -520,16 +1079,14 @@ namespace Spinner
                 return nullptr;
             }
 
-            vk::Format format = (image.bits == 16) ? vk::Format::eR16G16B16A16Unorm : vk::Format::eR8G8B8A8Unorm;
-            if (image.component == 3)
-            {
-                format = (image.bits == 16) ? vk::Format::eR16G16B16Unorm : vk::Format::eR8G8B8Unorm;
-            }
-
-            auto loadedImage = Image::CreateImage({static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height)}, format);
-            loadedImage->Write(image.image, vk::ImageAspectFlagBits::eColor, nullptr);
+            const vk::Format format = GetDecodedImageFormat(image.bits == 16, image.component);
 
-            return loadedImage;
+            return TextureCache::GetOrCreate({TextureCache::GetContentSource(image.image), format, Image::FullMipChain}, [&image, format, &sceneInfo]()
+            {
+                auto loadedImage = Image::CreateImage({static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height)}, format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, Image::FullMipChain);
+                loadedImage->Write(image.image, vk::ImageAspectFlagBits::eColor, sceneInfo.UploadCommandBuffer);
+                return loadedImage;
+            });
         }
         else if (!image.uri.empty())
         {
@@ -540,10 +1097,7 @@ namespace Spinner
             }
 
             // Load from texture filename
-            // Strip non-filename data (like relative paths)
-            std::string textureFilename = std::filesystem::path(image.uri).filename().string();;
-
-            return Image::LoadFromTextureFile(textureFilename);
+            return Image::LoadFromTextureFile(GetTextureFilenameFromUri(image.uri));
         }
 
         sceneInfo.Warnings += "Could not load texture as it contains no bufferView or URI\n";
@@ -591,7 +1145,11 @@ namespace Spinner
             // TODO emissive property (stored in gltf as a vec3 rather than just strength)
 
             auto colorTextureIndex = mat.pbrMetallicRoughness.baseColorTexture.index;
-            if (colorTextureIndex >= 0)
+            if (colorTextureIndex >= 0 && sceneInfo.DeferUploads)
+            {
+                sceneInfo.PendingTextures.push_back({material, 0, colorTextureIndex});
+            }
+            else if (colorTextureIndex >= 0)
             {
                 auto colorTexture = CreateTextureFromTexture(model, model.textures.at(colorTextureIndex), sceneInfo);
                 material->SetTexture(0, colorTexture);
@@ -601,38 +1159,499 @@ namespace Spinner
         }
     }
 
+    static void PrintMeshOptimizationStatistics(const std::string &modelFilename, const SceneInformation &sceneInfo)
+    {
+        const auto &before = sceneInfo.OptimizationBefore;
+        const auto &after = sceneInfo.OptimizationAfter;
+        if (before.TriangleCount == 0)
+        {
+            return;
+        }
+
+        const auto reduction = [](double before, double after) { return before > 0.0 ? (1.0 - after / before) * 100.0 : 0.0; };
+
+        std::clog << "Mesh optimization for " << modelFilename << ": " << before.TriangleCount << " triangles, " << before.VertexCount << " -> " << after.VertexCount << " vertices\n";
+        std::clog << "    ACMR " << before.GetACMR() << " -> " << after.GetACMR() << ", ATVR " << before.GetATVR() << " -> " << after.GetATVR() << ", vertex shading reduced by " << reduction(static_cast<double>(before.VertexShaderInvocations), static_cast<double>(after.VertexShaderInvocations)) << "%\n";
+        std::clog << "    Overdraw " << before.GetOverdraw() << " -> " << after.GetOverdraw() << ", fragment shading reduced by " << reduction(static_cast<double>(before.PixelsShaded), static_cast<double>(after.PixelsShaded)) << "%\n";
+    }
+
 
-    /* Call hierarchy:
-     * Scene::LoadModel - Loads a GLTF model
-     *      UpdateGlobalSceneInformationFromModel - creates materials and loads textures
-     *          CreateTextureFromTexture - creates a Spinner::Texture
-     *              CreateImageFromTexture - loads a Spinner::Image from a tinygltf texture
-     *              CreateSamplerFromTexture - creates a Spinner::Sampler from a tinygltf texture's sampler
-     *      CreateSceneObjectFromScene - Creates a scene object from a GLTF model
-     *          CreateSceneObjectFromNode - recursive, calls itself on its node's children
-     *              DoesMeshHaveAttribute - used to see which kind of mesh to make (static/skinned)
-     *              CreateStaticMeshBuffersFromMesh / CreateSkinnedMeshBuffersFromMesh - creates a static or skinned mesh based on available attributes
-     *                  GetGLTFAttribute - used to get vertex attributes from a vertex data buffer
-     *              CreateEmptySceneObject - creates an empty scene object for when there is no mesh
-     */
+    // tinygltf image loader which keeps the encoded bytes, so images are decoded in parallel rather than while parsing
+    static bool StoreEncodedImage(tinygltf::Image *image, const int imageIndex, std::string *err, std::string *warn, int requestedWidth, int requestedHeight, const unsigned char *bytes, int size, void *userData)
+    {
+        auto &encodedImages = *static_cast<std::vector<std::vector<uint8_t>> *>(userData);
+        if (imageIndex < 0)
+        {
+            return false;
+        }
+
+        if (encodedImages.size() <= static_cast<size_t>(imageIndex))
+        {
+            encodedImages.resize(imageIndex + 1);
+        }
+        encodedImages[imageIndex].assign(bytes, bytes + size);
+
+        return true;
+    }
+
+    // Model cache flags
+    static constexpr uint32_t ModelCacheQuantizedFlag = 1u << 0;
+
+    static uint64_t GetModelCacheSettingsKey(const ModelImportSettings &settings)
+    {
+        return (settings.QuantizeVertices ? 1u : 0u) | (settings.QuantizePositions ? 2u : 0u) | (settings.OptimizeMeshes ? 4u : 0u) | (settings.GenerateLods ? 8u : 0u) | (settings.CompressTextures ? 16u : 0u);
+    }
+
+    /// Adds a glTF image to the cache once, returns its record index or NoIndex if it cannot be baked
+    static int32_t BakeImage(const tinygltf::Model &model, int imageIndex, const SceneInformation &sceneInfo, std::unordered_map<int, int32_t> &bakedImages, ModelCache::Writer &writer)
+    {
+        if (imageIndex < 0 || static_cast<size_t>(imageIndex) >= model.images.size())
+        {
+            return ModelCache::NoIndex;
+        }
+        if (auto baked = bakedImages.find(imageIndex); baked != bakedImages.end())
+        {
+            return baked->second;
+        }
+
+        const auto &image = model.images[imageIndex];
+        ModelCache::ImageRecord record{};
+        if (static_cast<size_t>(imageIndex) < sceneInfo.Images.size() && !sceneInfo.Images[imageIndex].Pixels.empty())
+        {
+            const auto &decodedImage = sceneInfo.Images[imageIndex];
+            record.Pixels = writer.AddBlob(decodedImage.Pixels.data(), decodedImage.Pixels.size());
+            record.Width = static_cast<uint32_t>(decodedImage.Width);
+            record.Height = static_cast<uint32_t>(decodedImage.Height);
+            record.Format = decodedImage.Format;
+            record.SourceHash = decodedImage.SourceHash;
+        }
+        else if (!image.image.empty() && image.width > 0 && image.height > 0)
+        {
+            record.Pixels = writer.AddBlob(image.image.data(), image.image.size());
+            record.Width = static_cast<uint32_t>(image.width);
+            record.Height = static_cast<uint32_t>(image.height);
+            record.Format = GetDecodedImageFormat(image.bits == 16, image.component);
+            record.SourceHash = TextureCache::GetContentSource(image.image);
+        }
+        else
+        {
+            // Texture files are referenced rather than copied into the cache
+            record.TextureFilename = writer.AddString(GetTextureFilenameFromUri(image.uri));
+        }
 
-    SceneObject::Pointer Scene::LoadModel(const std::string &modelFilename)
+        const auto recordIndex = static_cast<int32_t>(writer.Images.size());
+        writer.Images.push_back(record);
+        bakedImages[imageIndex] = recordIndex;
+        return recordIndex;
+    }
+
+    static int32_t BakeTexture(const tinygltf::Model &model, int textureIndex, const SceneInformation &sceneInfo, std::unordered_map<int, int32_t> &bakedTextures, std::unordered_map<int, int32_t> &bakedImages, ModelCache::Writer &writer)
     {
-        std::string assetPath = GetAssetPath(AssetType::Model, modelFilename);
+        if (auto baked = bakedTextures.find(textureIndex); baked != bakedTextures.end())
+        {
+            return baked->second;
+        }
+
+        const auto &texture = model.textures.at(textureIndex);
+        const auto samplerSettings = GetSamplerSettingsFromTexture(model, texture);
+
+        ModelCache::TextureRecord record{};
+        record.Name = writer.AddString(texture.name);
+        record.ImageIndex = BakeImage(model, texture.source, sceneInfo, bakedImages, writer);
+        record.MinFilter = samplerSettings.MinFilter;
+        record.MagFilter = samplerSettings.MagFilter;
+        record.MipFilter = samplerSettings.MipFilter;
+        record.AddressModeU = samplerSettings.AddressModeU;
+        record.AddressModeV = samplerSettings.AddressModeV;
+        record.MaxLod = samplerSettings.MaxLod;
+
+        const auto recordIndex = static_cast<int32_t>(writer.Textures.size());
+        writer.Textures.push_back(record);
+        bakedTextures[textureIndex] = recordIndex;
+        return recordIndex;
+    }
+
+    // Recursively calls itself with the object's children, so nodes are stored depth first
+    static void BakeNode(const SceneObject::Pointer &sceneObject, int32_t parentIndex, const std::unordered_map<const MeshBuffer *, int32_t> &primitiveIndices, const std::unordered_map<const Material *, int32_t> &materialIndices, ModelCache::Writer &writer)
+    {
+        ModelCache::NodeRecord node{};
+        node.Name = writer.AddString(sceneObject->GetName());
+        node.ParentIndex = parentIndex;
+        node.Position = sceneObject->GetLocalPosition();
+        node.Rotation = sceneObject->GetLocalRotation();
+        node.Scale = sceneObject->GetLocalScale();
+
+        node.FirstMesh = static_cast<uint32_t>(writer.Meshes.size());
+        for (auto *meshComponent : sceneObject->GetComponentRawPointers<Components::MeshComponent>())
+        {
+            auto primitiveIndex = primitiveIndices.find(meshComponent->GetMeshBuffer().get());
+            if (primitiveIndex == primitiveIndices.end())
+            {
+                throw std::runtime_error("Cannot bake mesh component \"" + meshComponent->GetComponentName() + "\" as its mesh buffer was not imported");
+            }
+
+            ModelCache::MeshRecord mesh{};
+            mesh.Name = writer.AddString(meshComponent->GetComponentName());
+            mesh.PrimitiveIndex = primitiveIndex->second;
+            if (auto materialIndex = materialIndices.find(meshComponent->GetMaterial().get()); materialIndex != materialIndices.end())
+            {
+                mesh.MaterialIndex = materialIndex->second;
+            }
+            writer.Meshes.push_back(mesh);
+        }
+        node.MeshCount = static_cast<uint32_t>(writer.Meshes.size()) - node.FirstMesh;
+
+        if (auto *lightComponent = sceneObject->GetFirstComponentRawPointer<Components::LightComponent>())
+        {
+            ModelCache::LightRecord light{};
+            light.Type = lightComponent->GetLightType();
+            light.Color = lightComponent->GetLightColor();
+            light.Strength = lightComponent->GetLightStrength();
+            light.InnerSpotAngle = lightComponent->GetInnerSpotAngle();
+            light.OuterSpotAngle = lightComponent->GetOuterSpotAngle();
+
+            node.LightIndex = static_cast<int32_t>(writer.Lights.size());
+            writer.Lights.push_back(light);
+        }
+
+        const auto nodeIndex = static_cast<int32_t>(writer.Nodes.size());
+        writer.Nodes.push_back(node);
+
+        for (auto &child : sceneObject->GetChildren())
+        {
+            BakeNode(child, nodeIndex, primitiveIndices, materialIndices, writer);
+        }
+    }
+
+    /// Writes the imported model to the cache, must be called before sceneInfo's converted meshes and decoded images are released
+    static void BakeModelCache(const tinygltf::Model &model, const SceneInformation &sceneInfo, const SceneObject::Pointer &rootObject, const std::string &cachePath, uint64_t sourceKey)
+    {
+        ModelCache::Writer writer;
+
+        // Materials, with the textures and images they use
+        std::unordered_map<int, int32_t> bakedTextures;
+        std::unordered_map<int, int32_t> bakedImages;
+        std::unordered_map<const Material *, int32_t> materialIndices;
+        for (size_t i = 0; i < sceneInfo.Materials.size(); i++)
+        {
+            const auto &material = sceneInfo.Materials[i];
+
+            ModelCache::MaterialRecord record{};
+            record.Name = writer.AddString(material->GetName());
+            record.Color = material->GetColor();
+            record.Roughness = material->GetRoughness();
+            record.Metallic = material->GetMetallic();
+
+            const auto colorTextureIndex = model.materials.at(i).pbrMetallicRoughness.baseColorTexture.index;
+            if (colorTextureIndex >= 0)
+            {
+                record.ColorTextureIndex = BakeTexture(model, colorTextureIndex, sceneInfo, bakedTextures, bakedImages, writer);
+            }
+
+            materialIndices[material.get()] = static_cast<int32_t>(writer.Materials.size());
+            writer.Materials.push_back(record);
+        }
+
+        // Primitives, exactly as they were uploaded
+        std::unordered_map<const MeshBuffer *, int32_t> primitiveIndices;
+        for (size_t meshIndex = 0; meshIndex < sceneInfo.Meshes.size(); meshIndex++)
+        {
+            const auto &meshes = sceneInfo.Meshes[meshIndex];
+            const auto &primitives = sceneInfo.ConvertedMeshes.at(meshIndex).Primitives;
+            for (size_t i = 0; i < meshes.size(); i++)
+            {
+                const auto &meshBuffer = meshes[i].MeshBuffer;
+                const auto &builder = primitives.at(i).Builder;
+
+                ModelCache::PrimitiveRecord record{};
+                record.VertexData = writer.AddBlob(builder.GetVertexData().data(), builder.GetVertexData().size());
+                if (meshBuffer->IndexBufferType == vk::IndexType::eUint16)
+                {
+                    record.IndexData = writer.AddBlob(builder.GetShortIndices().data(), builder.GetShortIndices().size() * sizeof(MeshBuffer::ShortIndexType));
+                }
+                else
+                {
+                    record.IndexData = writer.AddBlob(builder.GetIndices().data(), builder.GetIndices().size() * sizeof(MeshBuffer::IndexType));
+                }
+                record.IndexCount = meshBuffer->IndexCount;
+                record.IndexType = meshBuffer->IndexBufferType;
+                record.Stride = meshBuffer->VertexBindingDescription.stride;
+                record.FirstAttribute = static_cast<uint32_t>(writer.Attributes.size());
+                record.AttributeCount = static_cast<uint32_t>(meshBuffer->VertexAttributeDescriptions.size());
+                record.PositionDequantizeOffset = meshBuffer->PositionDequantizeOffset;
+                record.PositionDequantizeScale = meshBuffer->PositionDequantizeScale;
+                record.FirstLod = static_cast<uint32_t>(writer.Lods.size());
+                record.LodCount = static_cast<uint32_t>(meshBuffer->Lods.size());
+                record.BoundingSphere = meshBuffer->BoundingSphere;
+
+                for (const auto &lod : meshBuffer->Lods)
+                {
+                    writer.Lods.push_back(ModelCache::LodRecord{lod.FirstIndex, lod.IndexCount, lod.Error});
+                }
+                for (const auto &attribute : meshBuffer->VertexAttributeDescriptions)
+                {
+                    writer.Attributes.push_back(ModelCache::AttributeRecord{attribute.format, attribute.location, attribute.offset});
+                }
+
+                primitiveIndices[meshBuffer.get()] = static_cast<int32_t>(writer.Primitives.size());
+                writer.Primitives.push_back(record);
+            }
+        }
+
+        BakeNode(rootObject, ModelCache::NoIndex, primitiveIndices, materialIndices, writer);
+
+        writer.Write(cachePath, sourceKey, sceneInfo.Settings.QuantizeVertices ? ModelCacheQuantizedFlag : 0u);
+    }
+
+    template<typename T>
+    static const T &GetCacheRecord(std::span<const T> records, int64_t index)
+    {
+        if (index < 0 || static_cast<size_t>(index) >= records.size())
+        {
+            throw std::runtime_error("Model cache record index " + std::to_string(index) + " is out of range");
+        }
+        return records[index];
+    }
+
+    /// Creates everything from the mapped cache, vertex, index and pixel data is copied straight from the mapping into staging buffers
+    static SceneObject::Pointer CreateSceneObjectFromCache(const ModelCache &cache, SceneInformation &sceneInfo)
+    {
+        const bool quantized = (cache.GetFlags() & ModelCacheQuantizedFlag) != 0;
+
+        // Images & textures
+        std::vector<Image::Pointer> images(cache.GetImages().size());
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            const auto &record = cache.GetImages()[i];
+            const auto pixels = cache.GetBlob(record.Pixels);
+            if (!pixels.empty())
+            {
+                // Keyed like the importer, so cached and imported models share images
+                images[i] = TextureCache::GetOrCreate({record.SourceHash, record.Format, Image::FullMipChain}, [&record, pixels, &sceneInfo]()
+                {
+                    auto image = Image::CreateImage({record.Width, record.Height}, record.Format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, Image::FullMipChain);
+                    image->Write(pixels.data(), pixels.size(), vk::ImageAspectFlagBits::eColor, sceneInfo.UploadCommandBuffer);
+                    return image;
+                });
+            }
+            else if (auto textureFilename = cache.GetString(record.TextureFilename); !textureFilename.empty())
+            {
+                images[i] = Image::LoadFromTextureFile(std::string(textureFilename));
+            }
+        }
+
+        std::vector<Texture::Pointer> textures(cache.GetTextures().size());
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            const auto &record = cache.GetTextures()[i];
+            Image::Pointer image = (record.ImageIndex != ModelCache::NoIndex) ? images.at(record.ImageIndex) : nullptr;
+            if (image == nullptr)
+            {
+                textures[i] = Texture::GetMagentaTexture();
+                continue;
+            }
+
+            Sampler::Settings samplerSettings;
+            samplerSettings.MinFilter = record.MinFilter;
+            samplerSettings.MagFilter = record.MagFilter;
+            samplerSettings.MipFilter = record.MipFilter;
+            samplerSettings.AddressModeU = record.AddressModeU;
+            samplerSettings.AddressModeV = record.AddressModeV;
+            samplerSettings.MaxLod = record.MaxLod;
+            auto sampler = Sampler::CreateSampler(samplerSettings);
+            textures[i] = std::make_shared<Texture>(std::string(cache.GetString(record.Name)), image, sampler);
+        }
+
+        // Materials
+        sceneInfo.Materials.resize(cache.GetMaterials().size());
+        for (size_t i = 0; i < sceneInfo.Materials.size(); i++)
+        {
+            const auto &record = cache.GetMaterials()[i];
+            auto material = Material::CreateMaterial(std::string(cache.GetString(record.Name)));
+            material->SetColor(record.Color);
+            material->SetRoughness(record.Roughness);
+            material->SetMetallic(record.Metallic);
+            if (record.ColorTextureIndex != ModelCache::NoIndex)
+            {
+                material->SetTexture(0, textures.at(record.ColorTextureIndex));
+            }
+            sceneInfo.Materials[i] = material;
+        }
+
+        // Mesh buffers
+        const auto attributes = cache.GetAttributes();
+        const auto lods = cache.GetLods();
+        std::vector<MeshBuffer::Pointer> meshBuffers(cache.GetPrimitives().size());
+        for (size_t i = 0; i < meshBuffers.size(); i++)
+        {
+            const auto &record = cache.GetPrimitives()[i];
+            if (record.FirstAttribute > attributes.size() || record.AttributeCount > attributes.size() - record.FirstAttribute)
+            {
+                throw std::runtime_error("Model cache primitive " + std::to_string(i) + " has out of range attributes");
+            }
+            if (record.FirstLod > lods.size() || record.LodCount > lods.size() - record.FirstLod)
+            {
+                throw std::runtime_error("Model cache primitive " + std::to_string(i) + " has out of range LODs");
+            }
+
+            vk::VertexInputBindingDescription2EXT bindingDescription;
+            bindingDescription.binding = 0;
+            bindingDescription.inputRate = vk::VertexInputRate::eVertex;
+            bindingDescription.stride = record.Stride;
+            bindingDescription.divisor = 1;
+
+            std::vector<vk::VertexInputAttributeDescription2EXT> attributeDescriptions(record.AttributeCount, vk::VertexInputAttributeDescription2EXT{});
+            for (uint32_t a = 0; a < record.AttributeCount; a++)
+            {
+                const auto &attribute = attributes[record.FirstAttribute + a];
+                attributeDescriptions[a].binding = 0;
+                attributeDescriptions[a].location = attribute.Location;
+                attributeDescriptions[a].format = attribute.Format;
+                attributeDescriptions[a].offset = attribute.Offset;
+            }
+
+            const auto vertexData = cache.GetBlob(record.VertexData);
+            const auto indexData = cache.GetBlob(record.IndexData);
+            if (indexData.size() < static_cast<size_t>(record.IndexCount) * VkIndexTypeByteWidth(record.IndexType))
+            {
+                throw std::runtime_error("Model cache primitive " + std::to_string(i) + " has too little index data");
+            }
+
+            auto meshBuffer = std::make_shared<MeshBuffer>(vertexData.data(), vertexData.size(), indexData.data(), record.IndexCount, record.IndexType, attributeDescriptions, bindingDescription, sceneInfo.UploadCommandBuffer);
+            meshBuffer->PositionDequantizeOffset = record.PositionDequantizeOffset;
+            meshBuffer->PositionDequantizeScale = record.PositionDequantizeScale;
+            meshBuffer->BoundingSphere = record.BoundingSphere;
+            if (record.LodCount > 0)
+            {
+                meshBuffer->Lods.clear();
+                for (const auto &lod : lods.subspan(record.FirstLod, record.LodCount))
+                {
+                    if (lod.IndexCount > record.IndexCount || lod.FirstIndex > record.IndexCount - lod.IndexCount)
+                    {
+                        throw std::runtime_error("Model cache primitive " + std::to_string(i) + " has a LOD outside of its indices");
+                    }
+                    meshBuffer->Lods.push_back(MeshBuffer::Lod{lod.FirstIndex, lod.IndexCount, lod.Error});
+                }
+            }
+            meshBuffers[i] = meshBuffer;
+        }
+
+        // Nodes, parents always come before their children
+        const auto nodes = cache.GetNodes();
+        const auto meshes = cache.GetMeshes();
+        std::vector<SceneObject::Pointer> sceneObjects(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const auto &node = nodes[i];
+            auto sceneObject = SceneObject::Create(std::string(cache.GetString(node.Name)));
+            sceneObject->SetLocalPosition(node.Position);
+            sceneObject->SetLocalRotation(node.Rotation);
+            sceneObject->SetLocalScale(node.Scale);
+
+            for (uint32_t m = 0; m < node.MeshCount; m++)
+            {
+                const auto &mesh = GetCacheRecord(meshes, static_cast<int64_t>(node.FirstMesh) + m);
+                auto material = (mesh.MaterialIndex != ModelCache::NoIndex) ? sceneInfo.Materials.at(mesh.MaterialIndex) : nullptr;
+                AddMeshComponent(sceneObject, meshBuffers.at(mesh.PrimitiveIndex), std::string(cache.GetString(mesh.Name)), material, quantized);
+            }
+
+            if (node.LightIndex != ModelCache::NoIndex)
+            {
+                const auto &light = GetCacheRecord(cache.GetLights(), node.LightIndex);
+                auto lightComponent = sceneObject->AddComponent<Components::LightComponent>();
+                lightComponent->SetLightType(light.Type);
+                lightComponent->SetLightColor(light.Color);
+                lightComponent->SetLightStrength(light.Strength);
+                lightComponent->SetInnerSpotAngle(light.InnerSpotAngle);
+                lightComponent->SetOuterSpotAngle(light.OuterSpotAngle);
+            }
+
+            if (node.ParentIndex != ModelCache::NoIndex)
+            {
+                if (node.ParentIndex < 0 || static_cast<size_t>(node.ParentIndex) >= i)
+                {
+                    throw std::runtime_error("Model cache node " + std::to_string(i) + " comes before its parent");
+                }
+                sceneObjects[node.ParentIndex]->AddChild(sceneObject);
+            }
+            sceneObjects[i] = sceneObject;
+        }
+
+        return sceneObjects.empty() ? nullptr : sceneObjects.front();
+    }
+
+    static SceneObject::Pointer LoadModelFromCache(const ModelCache &cache, const ModelImportSettings &settings)
+    {
+        SceneInformation sceneInfo{};
+        sceneInfo.Settings = settings;
+
+        sceneInfo.UploadCommandBuffer = Graphics::BeginSingleTimeCommands();
+        SceneObject::Pointer rootObject;
+        try
+        {
+            rootObject = CreateSceneObjectFromCache(cache, sceneInfo);
+        }
+        catch (...)
+        {
+            Graphics::EndSingleTimeCommands(sceneInfo.UploadCommandBuffer);
+            throw;
+        }
+        Graphics::EndSingleTimeCommands(sceneInfo.UploadCommandBuffer);
+
+        return rootObject;
+    }
+
+    /// Everything loading a model does before touching the GPU, so LoadModelAsync can run it on a worker thread
+    struct ParsedModel
+    {
+        std::string ModelFilename;
+        std::string AssetPath;
+        std::string CachePath;
+        uint64_t SourceKey = 0;
+        ModelCache::Pointer Cache; // Set when a baked cache matched, then nothing else is parsed
+        tinygltf::Model Model;
+        SceneInformation SceneInfo;
+    };
+
+    /// CPU stages, opens the model cache or parses the GLTF file, decodes images, converts meshes and compresses images
+    static std::unique_ptr<ParsedModel> ParseModel(const std::string &modelFilename, const ModelImportSettings &settings, bool useModelCache)
+    {
+        auto parsed = std::make_unique<ParsedModel>();
+        parsed->ModelFilename = modelFilename;
+        parsed->AssetPath = GetAssetPath(AssetType::Model, modelFilename);
+        parsed->SceneInfo.Settings = settings;
+        const auto &assetPath = parsed->AssetPath;
 
         if (!FileExists(assetPath))
         {
             throw std::runtime_error("Cannot load model from asset path " + assetPath + " as file does not exist");
         }
 
+        if (settings.UseModelCache)
+        {
+            parsed->CachePath = GetAssetPath(AssetType::Cache, std::filesystem::path(modelFilename).filename().string() + ".spinnermodel");
+            parsed->SourceKey = ModelCache::ComputeSourceKey(assetPath, GetModelCacheSettingsKey(settings));
+            if (useModelCache)
+            {
+                parsed->Cache = ModelCache::Open(parsed->CachePath, parsed->SourceKey);
+                if (parsed->Cache != nullptr)
+                {
+                    return parsed;
+                }
+            }
+        }
+
         auto extension = std::filesystem::path(assetPath).extension().string();
         std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) -> unsigned char { return std::tolower(c); });
 
         tinygltf::TinyGLTF loader;
-        tinygltf::Model model;
+        auto &model = parsed->Model;
         std::string err;
         std::string warn;
 
+        std::vector<std::vector<uint8_t>> encodedImages;
+        loader.SetImageLoader(StoreEncodedImage, &encodedImages);
+
         bool ret = false;
         if (extension == ".glb")
         {
@@ -658,15 +1677,36 @@ namespace Spinner
             throw std::runtime_error("Unable to parse binary GLTF " + modelFilename + " ");
         }
 
-        // Create materials
-        SceneInformation sceneInfo{};
-        UpdateGlobalSceneInformationFromModel(model, sceneInfo);
+        auto &sceneInfo = parsed->SceneInfo;
 
+        {
+            ScopedTimer timer("Decode images & convert meshes");
+            encodedImages.resize(model.images.size());
+            DecodeImagesAndConvertMeshes(model, encodedImages, sceneInfo);
+            encodedImages.clear();
+        }
+
+        if (settings.CompressTextures)
+        {
+            ScopedTimer timer("Compress images");
+            EncodeImages(sceneInfo);
+        }
+
+        return parsed;
+    }
+
+    /// Creates the model's hierarchy once its materials exist, nullptr when it has no scenes
+    static SceneObject::Pointer CreateRootObject(ParsedModel &parsed)
+    {
+        auto &model = parsed.Model;
+        auto &sceneInfo = parsed.SceneInfo;
+
+        SceneObject::Pointer outSceneObject = nullptr;
         // If multiple scenes
         if (model.scenes.size() > 1)
         {
-            std::string fileName = std::filesystem::path(assetPath).filename().replace_extension().string();
-            SceneObject::Pointer fileObject = std::make_shared<SceneObject>(fileName);
+            std::string fileName = std::filesystem::path(parsed.AssetPath).filename().replace_extension().string();
+            outSceneObject = SceneObject::Create(fileName);
             for (auto &scene : model.scenes)
             {
                 auto sceneObject = CreateSceneObjectFromScene(model, scene, sceneInfo);
@@ -675,34 +1715,443 @@ namespace Spinner
                     continue;
                 }
 
-                fileObject->AddChild(sceneObject);
+                outSceneObject->AddChild(sceneObject);
             }
+        }
+        // If only one scene then create it, if no default scene (somehow) then return nullptr
+        else if (model.defaultScene >= 0)
+        {
+            outSceneObject = CreateSceneObjectFromScene(model, model.scenes.at(model.defaultScene), sceneInfo);
+        }
+
+        return outSceneObject;
+    }
 
-            if (!sceneInfo.Warnings.empty())
+    /// Prints the import's warnings and statistics, then bakes the model cache once every upload has completed
+    static void FinishImport(ParsedModel &parsed, const SceneObject::Pointer &rootObject)
+    {
+        auto &sceneInfo = parsed.SceneInfo;
+        if (!sceneInfo.Warnings.empty())
+        {
+            std::cerr << sceneInfo.Warnings;
+        }
+        PrintMeshOptimizationStatistics(parsed.ModelFilename, sceneInfo);
+
+        if (sceneInfo.Settings.UseModelCache && rootObject != nullptr)
+        {
+            try
             {
-                std::cerr << sceneInfo.Warnings;
+                ScopedTimer timer("Write model cache");
+                BakeModelCache(parsed.Model, sceneInfo, rootObject, parsed.CachePath, parsed.SourceKey);
+            }
+            catch (const std::exception &ex)
+            {
+                std::cerr << "Could not write model cache for " << parsed.ModelFilename << ": " << ex.what() << '\n';
             }
-
-            return fileObject;
         }
+    }
 
-        // If no default scene (somehow) then return nullptr
-        if (model.defaultScene < 0)
+    /* Call hierarchy:
+     * Scene::LoadModel - Loads a GLTF model, keeping images encoded (StoreEncodedImage)
+     *      ParseModel - CPU stages, on a worker thread for Scene::LoadModelAsync
+     *          ModelCache::Open - when a baked cache matches the model file and settings nothing else is parsed
+     *          DecodeImagesAndConvertMeshes - runs on the job system
+     *              DecodeImage - decodes an image to RGBA8 or RGBA16, or loads its compressed mip chain from the encoded texture cache. Skipped when the TextureCache has the image
+     *              ConvertMesh - converts a mesh's primitives into MeshBuilders
+     *                  DoesMeshHaveAttribute - used to see which kind of mesh to make (static/skinned)
+     *                  ConvertStaticMesh / ConvertSkinnedMesh - converts a static or skinned mesh based on available attributes
+     *                      MeshOptimizer::OptimizeMesh - optionally removes duplicate vertices and reorders for the vertex cache, overdraw and vertex fetch
+     *                      GetGLTFAttribute - returns an AccessorView which reads a vertex attribute in place from the model's buffers
+     *          EncodeImages - optionally block compresses the decoded RGBA8 images into the texture cache
+     *      LoadModelFromCache - used instead of everything below when the cache opened
+     *          CreateSceneObjectFromCache - creates images, materials, mesh buffers and scene objects from the mapped cache
+     *      GPU stage, every upload is recorded into one command buffer which is submitted once
+     *          UpdateGlobalSceneInformationFromModel - creates materials and textures
+     *              CreateTextureFromTexture - creates a Spinner::Texture
+     *                  CreateImageFromTexture - creates a Spinner::Image from a decoded image, shared through the TextureCache
+     *                  CreateSamplerFromTexture - gets the shared Spinner::Sampler for a tinygltf texture's sampler
+     *          CreateMeshBuffers - creates the MeshBuffers of every converted mesh
+     *      CreateRootObject - Creates a scene object from each GLTF scene
+     *          CreateSceneObjectFromScene
+     *              CreateSceneObjectFromNode - recursive, calls itself on its node's children
+     *                  CreateSceneObjectFromMesh - creates mesh components from the already created MeshBuffers
+     *                  CreateEmptySceneObject - creates an empty scene object for when there is no mesh
+     *      FinishImport - prints warnings and statistics
+     *          BakeModelCache - writes the uploaded data, materials and created scene objects to the cache
+     *
+     * Scene::LoadModelAsync - runs ParseModel on a worker thread, then Scene::Update calls AdvanceModelLoad each frame which:
+     *      creates the materials (deferring their textures) and CreateRootObject (deferring mesh components), and adds the root to the scene
+     *      records CreateMeshBuffer then CreateTextureFromTexture calls within the frame budget, submitting them without waiting
+     *      adds mesh components and sets textures once a submission's fence signals, then FinishImport
+     *      a matching model cache is instead recorded in a single submission and added to the scene once it completes
+     */
+
+    SceneObject::Pointer Scene::LoadModel(const std::string &modelFilename, const ModelImportSettings &settings)
+    {
+        ScopedTimer loadTimer("Load model " + modelFilename);
+
+        auto parsed = ParseModel(modelFilename, settings, true);
+        if (parsed->Cache != nullptr)
         {
-            return nullptr;
+            try
+            {
+                ScopedTimer timer("Load model cache");
+                return LoadModelFromCache(*parsed->Cache, settings);
+            }
+            catch (const std::exception &ex)
+            {
+                std::cerr << "Model cache for " << modelFilename << " could not be loaded, importing instead: " << ex.what() << '\n';
+            }
+            parsed = ParseModel(modelFilename, settings, false);
         }
 
-        // If only one scene then create it
-        auto outSceneObject = CreateSceneObjectFromScene(model, model.scenes.at(model.defaultScene), sceneInfo);
+        auto &sceneInfo = parsed->SceneInfo;
 
-        if (!sceneInfo.Warnings.empty())
+        // Create materials, textures and mesh buffers
         {
-            std::cerr << sceneInfo.Warnings;
+            ScopedTimer timer("Upload images & meshes");
+            sceneInfo.UploadCommandBuffer = Graphics::BeginSingleTimeCommands();
+            try
+            {
+                UpdateGlobalSceneInformationFromModel(parsed->Model, sceneInfo);
+                CreateMeshBuffers(sceneInfo);
+            }
+            catch (...)
+            {
+                Graphics::EndSingleTimeCommands(sceneInfo.UploadCommandBuffer);
+                throw;
+            }
+            Graphics::EndSingleTimeCommands(sceneInfo.UploadCommandBuffer);
+            sceneInfo.UploadCommandBuffer = nullptr;
+            if (!settings.UseModelCache)
+            {
+                sceneInfo.Images.clear();
+            }
         }
 
+        auto outSceneObject = CreateRootObject(*parsed);
+        FinishImport(*parsed, outSceneObject);
+
         return outSceneObject;
     }
 
+    /// One submission of an async load's uploads, applied to the model once its fence signals
+    struct AsyncUploadBatch
+    {
+        CommandBuffer::Pointer UploadCommandBuffer;
+        vk::Fence Fence;
+        std::vector<size_t> Meshes; // Indices of glTF meshes whose buffers were recorded
+        std::vector<std::pair<PendingTexture, Texture::Pointer>> Textures;
+        SceneObject::Pointer CachedRootObject; // The whole model when loading from the model cache
+    };
+
+    struct AsyncModelLoad::Work
+    {
+        ModelImportSettings Settings;
+        std::future<std::unique_ptr<ParsedModel>> Parsing;
+        std::unique_ptr<ParsedModel> Parsed;
+        size_t NextMesh = 0;
+        size_t NextTexture = 0;
+        std::deque<AsyncUploadBatch> Batches;
+
+        ~Work()
+        {
+            // std::future from std::async waits for the worker, submitted uploads are waited on before their command buffers are freed
+            for (auto &batch : Batches)
+            {
+                try
+                {
+                    Graphics::FinishSingleTimeCommands(batch.UploadCommandBuffer, batch.Fence, true);
+                }
+                catch (const std::exception &ex)
+                {
+                    std::cerr << "Failed to finish an async model upload: " << ex.what() << '\n';
+                }
+            }
+        }
+    };
+
+    AsyncModelLoad::AsyncModelLoad(std::string modelFilename, const ModelImportSettings &settings, SceneObject::WeakPointer parent) : ModelFilename(std::move(modelFilename)), Parent(std::move(parent)), LoadWork(std::make_unique<Work>())
+    {
+        LoadWork->Settings = settings;
+        LoadWork->Parsing = std::async(std::launch::async, ParseModel, ModelFilename, settings, true);
+    }
+
+    AsyncModelLoad::~AsyncModelLoad() = default;
+
+    AsyncModelLoad::Status AsyncModelLoad::GetStatus() const noexcept
+    {
+        return LoadStatus;
+    }
+
+    bool AsyncModelLoad::IsDone() const noexcept
+    {
+        return LoadStatus == Status::Complete || LoadStatus == Status::Failed;
+    }
+
+    SceneObject::Pointer AsyncModelLoad::GetRootObject() const noexcept
+    {
+        return RootObject;
+    }
+
+    const std::string &AsyncModelLoad::GetModelFilename() const noexcept
+    {
+        return ModelFilename;
+    }
+
+    const std::string &AsyncModelLoad::GetError() const noexcept
+    {
+        return Error;
+    }
+
+    AsyncModelLoad::Pointer Scene::LoadModelAsync(const std::string &modelFilename, const ModelImportSettings &settings, const SceneObject::Pointer &parent)
+    {
+        auto load = std::make_shared<AsyncModelLoad>(modelFilename, settings, parent);
+        PendingModelLoads.push_back(load);
+        return load;
+    }
+
+    void Scene::Update()
+    {
+        const auto deadline = std::chrono::steady_clock::now() + AsyncLoadFrameBudget;
+        for (auto &load : PendingModelLoads)
+        {
+            try
+            {
+                AdvanceModelLoad(*load, deadline);
+            }
+            catch (const std::exception &ex)
+            {
+                std::cerr << "Could not load model " << load->ModelFilename << ": " << ex.what() << '\n';
+                load->Error = ex.what();
+                load->LoadStatus = AsyncModelLoad::Status::Failed;
+            }
+
+            if (load->IsDone())
+            {
+                load->LoadWork.reset();
+            }
+        }
+
+        std::erase_if(PendingModelLoads, [](const auto &load) { return load->IsDone(); });
+
+        // One linear pass over the scene's transforms, so systems reading world matrices this frame find them built
+        GetObjectTree()->Transforms->UpdateWorldMatrices();
+        UpdateMeshBounds();
+    }
+
+    void Scene::UpdateMeshBounds()
+    {
+        MeshBoundsSyncIndex++;
+        auto &transforms = *GetObjectTree()->Transforms;
+        size_t seenCount = 0;
+        size_t insertedCount = 0;
+        ForEachComponent<Components::MeshComponent>([&](Components::MeshComponent &meshComponent, SceneObject &sceneObject)
+        {
+            const auto handle = meshComponent.GetHandle();
+            if (handle.Index >= MeshBounds.size())
+            {
+                MeshBounds.resize(handle.Index + 1);
+            }
+
+            auto &entry = MeshBounds[handle.Index];
+            entry.LastSeen = MeshBoundsSyncIndex;
+            seenCount++;
+
+            const auto generation = transforms.GetGeneration(sceneObject.TransformId);
+            const auto *meshBuffer = meshComponent.GetMeshBuffer().get();
+            const bool isSameComponent = (entry.Proxy != BoundingVolumeHierarchy::NullNode) && (entry.Handle == handle);
+            if (isSameComponent && entry.TransformId == sceneObject.TransformId && entry.TransformGeneration == generation && entry.Mesh == meshBuffer)
+            {
+                return;
+            }
+
+            const auto boundingSphere = (meshBuffer != nullptr) ? meshBuffer->BoundingSphere : glm::vec4(0.0f);
+            const auto bounds = Aabb::FromTransformedSphere(boundingSphere, transforms.GetWorldMatrix(sceneObject.TransformId));
+            if (isSameComponent)
+            {
+                MeshBvh.Move(entry.Proxy, bounds);
+            }
+            else
+            {
+                // The slot belonged to a component which was destroyed since the last update
+                if (entry.Proxy != BoundingVolumeHierarchy::NullNode)
+                {
+                    MeshBvh.Remove(entry.Proxy);
+                }
+                entry.Proxy = MeshBvh.Insert(bounds, handle.Index);
+                entry.Handle = handle;
+                insertedCount++;
+            }
+
+            entry.Owner = &sceneObject;
+            entry.TransformId = sceneObject.TransformId;
+            entry.TransformGeneration = generation;
+            entry.Mesh = meshBuffer;
+        });
+
+        // Only sweep when something left the scene
+        if (MeshBvh.GetProxyCount() > seenCount)
+        {
+            for (auto &entry : MeshBounds)
+            {
+                if (entry.Proxy != BoundingVolumeHierarchy::NullNode && entry.LastSeen != MeshBoundsSyncIndex)
+                {
+                    MeshBvh.Remove(entry.Proxy);
+                    entry = {};
+                }
+            }
+        }
+
+        if (insertedCount >= MeshBoundsRebuildMinimum && insertedCount * 4 > MeshBvh.GetProxyCount())
+        {
+            MeshBvh.Rebuild();
+        }
+    }
+
+    size_t Scene::GetPendingModelLoadCount() const noexcept
+    {
+        return PendingModelLoads.size();
+    }
+
+    void Scene::AdvanceModelLoad(AsyncModelLoad &load, std::chrono::steady_clock::time_point deadline)
+    {
+        auto &work = *load.LoadWork;
+
+        // A destroyed parent drops the load rather than attaching the model to the scene root. While parsing, the check waits
+        // for the parse to finish so dropping the load never blocks on it
+        if (load.LoadStatus != AsyncModelLoad::Status::Loading && IsExpiredReference(load.Parent))
+        {
+            throw std::runtime_error("The parent object was destroyed during the load");
+        }
+
+        // Apply completed submissions, a fence only signals after everything submitted before it
+        while (!work.Batches.empty() && Graphics::FinishSingleTimeCommands(work.Batches.front().UploadCommandBuffer, work.Batches.front().Fence, false))
+        {
+            auto batch = std::move(work.Batches.front());
+            work.Batches.pop_front();
+
+            if (batch.CachedRootObject != nullptr)
+            {
+                load.RootObject = batch.CachedRootObject;
+                AddObjectToScene(load.RootObject, load.Parent.lock());
+            }
+
+            auto &sceneInfo = work.Parsed->SceneInfo;
+            for (const auto meshIndex : batch.Meshes)
+            {
+                for (const auto &sceneObject : sceneInfo.MeshObjects[meshIndex])
+                {
+                    AddMeshComponents(sceneObject, meshIndex, sceneInfo);
+                }
+                sceneInfo.MeshObjects[meshIndex].clear();
+            }
+            for (auto &[pending, texture] : batch.Textures)
+            {
+                pending.Material->SetTexture(pending.Slot, std::move(texture));
+            }
+        }
+
+        if (load.LoadStatus == AsyncModelLoad::Status::Loading)
+        {
+            if (work.Parsing.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                return;
+            }
+            work.Parsed = work.Parsing.get();
+            if (IsExpiredReference(load.Parent))
+            {
+                throw std::runtime_error("The parent object was destroyed during the load");
+            }
+
+            auto &parsed = *work.Parsed;
+            auto &sceneInfo = parsed.SceneInfo;
+            if (parsed.Cache != nullptr)
+            {
+                // The cache only needs copying into staging buffers, so it is recorded in one go
+                AsyncUploadBatch batch;
+                batch.UploadCommandBuffer = Graphics::BeginSingleTimeCommands();
+                sceneInfo.UploadCommandBuffer = batch.UploadCommandBuffer;
+                try
+                {
+                    batch.CachedRootObject = CreateSceneObjectFromCache(*parsed.Cache, sceneInfo);
+                }
+                catch (const std::exception &ex)
+                {
+                    Graphics::EndSingleTimeCommands(batch.UploadCommandBuffer);
+                    std::cerr << "Model cache for " << load.ModelFilename << " could not be loaded, importing instead: " << ex.what() << '\n';
+                    work.Parsed.reset();
+                    work.Parsing = std::async(std::launch::async, ParseModel, load.ModelFilename, work.Settings, false);
+                    return;
+                }
+                batch.Fence = Graphics::SubmitSingleTimeCommands(batch.UploadCommandBuffer);
+                sceneInfo.UploadCommandBuffer = nullptr;
+                work.Batches.push_back(std::move(batch));
+                load.LoadStatus = AsyncModelLoad::Status::Uploading;
+                return;
+            }
+
+            // The hierarchy is in the scene straight away, materials show their default textures until the real ones are uploaded
+            sceneInfo.DeferUploads = true;
+            sceneInfo.Meshes.resize(sceneInfo.ConvertedMeshes.size());
+            sceneInfo.MeshObjects.resize(sceneInfo.ConvertedMeshes.size());
+            UpdateGlobalSceneInformationFromModel(parsed.Model, sceneInfo);
+            load.RootObject = CreateRootObject(parsed);
+            AddObjectToScene(load.RootObject, load.Parent.lock());
+            load.LoadStatus = AsyncModelLoad::Status::Uploading;
+        }
+
+        auto &parsed = *work.Parsed;
+        auto &sceneInfo = parsed.SceneInfo;
+        const size_t meshCount = sceneInfo.ConvertedMeshes.size();
+        const size_t textureCount = sceneInfo.PendingTextures.size();
+
+        // Meshes first so the model takes shape before it is textured, each frame's uploads share one submission
+        if (work.NextMesh < meshCount || work.NextTexture < textureCount)
+        {
+            AsyncUploadBatch batch;
+            batch.UploadCommandBuffer = Graphics::BeginSingleTimeCommands();
+            sceneInfo.UploadCommandBuffer = batch.UploadCommandBuffer;
+            try
+            {
+                do
+                {
+                    if (work.NextMesh < meshCount)
+                    {
+                        CreateMeshBuffer(sceneInfo, work.NextMesh);
+                        batch.Meshes.push_back(work.NextMesh++);
+                    }
+                    else
+                    {
+                        const auto &pending = sceneInfo.PendingTextures[work.NextTexture++];
+                        batch.Textures.emplace_back(pending, CreateTextureFromTexture(parsed.Model, parsed.Model.textures.at(pending.TextureIndex), sceneInfo));
+                    }
+                } while ((work.NextMesh < meshCount || work.NextTexture < textureCount) && std::chrono::steady_clock::now() < deadline);
+            }
+            catch (...)
+            {
+                Graphics::EndSingleTimeCommands(batch.UploadCommandBuffer);
+                sceneInfo.UploadCommandBuffer = nullptr;
+                throw;
+            }
+            batch.Fence = Graphics::SubmitSingleTimeCommands(batch.UploadCommandBuffer);
+            sceneInfo.UploadCommandBuffer = nullptr;
+            work.Batches.push_back(std::move(batch));
+        }
+
+        if (work.NextMesh < meshCount || work.NextTexture < textureCount || !work.Batches.empty())
+        {
+            return;
+        }
+
+        // Loads from the model cache have nothing to report or bake
+        if (parsed.Cache == nullptr)
+        {
+            FinishImport(parsed, load.RootObject);
+        }
+        load.LoadStatus = AsyncModelLoad::Status::Complete;
+    }
+
     bool Scene::IsActive() const noexcept
     {
         return Active;
@@ -788,7 +2237,7 @@ namespace Spinner
 
                 return true;
             },
-            [&](const SceneObject::Pointer &object) -> void
+            [&](SceneObject &) -> void
             {
                 ImGui::Unindent(8);
             });
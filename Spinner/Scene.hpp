@@ -1,9 +1,11 @@
 #ifndef SPINNER_SCENE_HPP
 #define SPINNER_SCENE_HPP
 
+#include <chrono>
 #include "Object.hpp"
 #include "SceneObject.hpp"
 #include "DescriptorPool.hpp"
+#include "BoundingVolumeHierarchy.hpp"
 
 namespace Spinner
 {
@@ -11,26 +13,136 @@ namespace Spinner
 
     class Lighting;
 
+    struct ModelImportSettings
+    {
+        /// Use the compact QuantizedStaticMeshVertex layout instead of StaticMeshVertex
+        bool QuantizeVertices = false;
+        /// When quantizing vertices also store positions as 16 bit values relative to each mesh's bounds
+        bool QuantizePositions = true;
+        /// Remove duplicate vertices and reorder triangles and vertices for the vertex cache, overdraw and vertex fetch. Prints before & after statistics
+        bool OptimizeMeshes = false;
+        /// Simplify triangle meshes into a chain of coarser levels of detail sharing the vertex buffer, selected at draw time by their projected error
+        bool GenerateLods = false;
+        /// Block compress embedded 8 bit images to BC1 (opaque) or BC3 with their mip chains. The first import encodes them and caches the results as KTX2 files
+        bool CompressTextures = false;
+        /// Load from a baked cache of the import when one matches the model file and these settings, otherwise bake one after importing
+        bool UseModelCache = true;
+    };
+
+    /// A model being loaded by Scene::LoadModelAsync. Parsing, decoding and compression run on a worker thread,
+    /// then Scene::Update records the uploads on the main thread a few at a time and fills in the model as they complete
+    class AsyncModelLoad
+    {
+        friend class Scene;
+
+    public:
+        using Pointer = std::shared_ptr<AsyncModelLoad>;
+
+        enum class Status
+        {
+            Loading, // Parsing and decoding on the worker thread
+            Uploading, // The hierarchy is in the scene, meshes and textures are added as their uploads complete
+            Complete,
+            Failed
+        };
+
+        struct Work; // The import's state, only known to Scene.cpp
+
+        AsyncModelLoad(std::string modelFilename, const ModelImportSettings &settings, SceneObject::WeakPointer parent);
+        ~AsyncModelLoad();
+
+        [[nodiscard]] Status GetStatus() const noexcept;
+        [[nodiscard]] bool IsDone() const noexcept;
+        /// The model's root object once it is in the scene, nullptr before then or when the load failed
+        [[nodiscard]] SceneObject::Pointer GetRootObject() const noexcept;
+        [[nodiscard]] const std::string &GetModelFilename() const noexcept;
+        /// Empty unless the load failed, objects already added to the scene remain
+        [[nodiscard]] const std::string &GetError() const noexcept;
+
+    protected:
+        std::string ModelFilename;
+        SceneObject::WeakPointer Parent;
+        Status LoadStatus = Status::Loading;
+        SceneObject::Pointer RootObject;
+        std::string Error;
+        std::unique_ptr<Work> LoadWork;
+    };
+
     class Scene : public Object, public std::enable_shared_from_this<Scene>
     {
         friend class Graphics;
+        friend class SceneObject;
 
     public:
         using Pointer = std::shared_ptr<Scene>;
 
         static constexpr uint32_t SceneUniformBufferBindingIndex = 0;
+        /// Main thread time Update may spend recording uploads for async model loads each frame, at least one upload is recorded per load
+        static constexpr std::chrono::microseconds AsyncLoadFrameBudget{4000};
 
         explicit Scene(std::string name);
-        ~Scene() override = default;
+        /// Releases the object tree, then trims the shared object pools
+        ~Scene() override;
 
     public:
         bool AddObjectToScene(const SceneObject::Pointer &object, SceneObject::Pointer parent = nullptr);
+        /// Loads the model without blocking, it is added under parent (or the scene root) progressively by Update.
+        /// The load fails instead if parent is destroyed before it completes
+        AsyncModelLoad::Pointer LoadModelAsync(const std::string &modelFilename, const ModelImportSettings &settings = {}, const SceneObject::Pointer &parent = nullptr);
+        /// Advances async model loads, rebuilds the scene's dirty world matrices and refits the mesh bounds to them, call once per frame from the main thread
+        void Update();
+        [[nodiscard]] size_t GetPendingModelLoadCount() const noexcept;
         [[nodiscard]] bool IsActive() const noexcept;
         void SetActive(bool active);
         [[nodiscard]] std::shared_ptr<Spinner::Lighting> GetLighting() const noexcept;
 
         [[nodiscard]] SceneObject::Pointer GetObjectTree();
 
+        /// Visits every component of type T in the scene, including those on inactive objects, see ComponentPools::ForEach
+        template<Components::IsComponent T, typename Function>
+        void ForEachComponent(Function &&function)
+        {
+            ObjectTree->Pools->ForEach<T>(function);
+        }
+
+        template<Components::IsComponent T>
+        [[nodiscard]] size_t GetComponentCount() const
+        {
+            return ObjectTree->Pools->GetCount<T>();
+        }
+
+        /// Spatial queries over the world bounds of the scene's mesh components (including those on inactive objects) as of the last Update.
+        /// Bounds come from each mesh's bounding sphere and are padded, so the results are conservative. function is called with
+        /// (MeshComponent &, SceneObject &) and may return false to stop the query
+        template<typename Function>
+        void QueryMeshes(const Aabb &bounds, Function &&function) const
+        {
+            MeshBvh.QueryAabb(bounds, [&](uint64_t index) { return VisitMeshBounds(index, function); });
+        }
+
+        template<typename Function>
+        void QueryMeshes(const Sphere &sphere, Function &&function) const
+        {
+            MeshBvh.QuerySphere(sphere, [&](uint64_t index) { return VisitMeshBounds(index, function); });
+        }
+
+        template<typename Function>
+        void QueryMeshes(const Frustum &frustum, Function &&function) const
+        {
+            MeshBvh.QueryFrustum(frustum, [&](uint64_t index) { return VisitMeshBounds(index, function); });
+        }
+
+        /// function is called with (MeshComponent &, SceneObject &, float distance) for every mesh whose bounds the ray enters within maxDistance, in no particular order
+        template<typename Function>
+        void RaycastMeshes(const Ray &ray, float maxDistance, Function &&function) const
+        {
+            MeshBvh.Raycast(ray, maxDistance, [&](uint64_t index, float distance)
+            {
+                auto visit = [&](Components::MeshComponent &meshComponent, SceneObject &sceneObject) { return function(meshComponent, sceneObject, distance); };
+                return VisitMeshBounds(index, visit);
+            });
+        }
+
         void RenderHierarchy();
         void RenderSelectedProperties();
 
@@ -42,14 +154,62 @@ namespace Spinner
         bool Active = true;
         bool HasSetObjectTreeScene = false;
 
+        std::vector<AsyncModelLoad::Pointer> PendingModelLoads;
+
+        struct MeshBoundsEntry
+        {
+            Components::ComponentHandle Handle;
+            SceneObject *Owner = nullptr;
+            BoundingVolumeHierarchy::ProxyId Proxy = BoundingVolumeHierarchy::NullNode;
+            // What the bounds were built from, they are only recomputed when one of these changes
+            TransformStore::Id TransformId = TransformStore::InvalidId;
+            uint32_t TransformGeneration = 0;
+            const MeshBuffer *Mesh = nullptr;
+            uint64_t LastSeen = 0;
+        };
+
+        std::vector<MeshBoundsEntry> MeshBounds; // Indexed by the mesh component's handle index, which is the proxies' user data
+        BoundingVolumeHierarchy MeshBvh;
+        uint64_t MeshBoundsSyncIndex = 0;
+
         // Debug ImGui
         SceneObject::WeakPointer SelectedInHierarchy;
 
+    protected:
+        void AdvanceModelLoad(AsyncModelLoad &load, std::chrono::steady_clock::time_point deadline);
+        /// Inserts, moves and removes the mesh components' bounds in MeshBvh to match the scene
+        void UpdateMeshBounds();
+
+        /// Skips meshes removed since the last Update, returns false when function asked to stop
+        template<typename Function>
+        bool VisitMeshBounds(uint64_t index, Function &function) const
+        {
+            const auto &entry = MeshBounds[index];
+            auto *component = Components::Component::Resolve(Components::GetComponentId<Components::MeshComponent>(), entry.Handle);
+            if (component == nullptr)
+            {
+                return true;
+            }
+
+            auto &meshComponent = *static_cast<Components::MeshComponent *>(component);
+            if constexpr (std::is_same_v<std::invoke_result_t<Function &, Components::MeshComponent &, SceneObject &>, bool>)
+            {
+                return function(meshComponent, *entry.Owner);
+            }
+            else
+            {
+                function(meshComponent, *entry.Owner);
+                return true;
+            }
+        }
+
     protected:
         static std::weak_ptr<Spinner::Lighting> GlobalLighting;
+        /// Bulk inserts of at least this many meshes, and over a quarter of the tree, rebuild it top down instead of keeping the incremental inserts
+        static constexpr size_t MeshBoundsRebuildMinimum = 64;
 
     public:
-        static SceneObject::Pointer LoadModel(const std::string &modelFilename);
+        static SceneObject::Pointer LoadModel(const std::string &modelFilename, const ModelImportSettings &settings = {});
         [[nodiscard]] static std::shared_ptr<Spinner::Lighting> GetGlobalLighting();
 
         static std::vector<vk::DescriptorSetLayoutBinding> GetDescriptorSetLayoutBindings();
@@ -1,6 +1,8 @@
 #include "SceneObject.hpp"
 
+#include <algorithm>
 #include <utility>
+#include "Scene.hpp"
 #include "Utilities.hpp"
 #include "Components/Components.hpp"
 #include <imgui.h>
@@ -10,6 +12,19 @@ namespace Spinner
 {
     SceneObject::SceneObject(std::string name, bool isScene) : Name(std::move(name)), IsScene(isScene)
     {
+        // A scene's root owns the scene's store and pools, every other object starts detached
+        Transforms = IsScene ? std::make_shared<TransformStore>() : TransformStore::GetDetachedStore();
+        TransformId = Transforms->Add();
+        Pools = IsScene ? std::make_shared<ComponentPools>() : ComponentPools::GetDetachedPools();
+    }
+
+    SceneObject::~SceneObject()
+    {
+        Transforms->Remove(TransformId);
+        for (auto &component : Components)
+        {
+            Pools->Remove(component.get());
+        }
     }
 
     std::string SceneObject::GetName() const
@@ -39,23 +54,46 @@ namespace Spinner
         {
             throw std::runtime_error("Cannot set a SceneObject as it's own parent");
         }
-        if (GetParent() != nullptr)
+
+        LinkParent(newParent);
+        NotifyParentChanged();
+
+        return true;
+    }
+
+    void SceneObject::LinkParent(const SceneObject::Pointer &newParent)
+    {
+        auto sharedThis = shared_from_this();
+        if (auto oldParent = GetParent())
         {
-            GetParent()->RemoveChild(sharedThis);
+            oldParent->RemoveChild(sharedThis);
         }
         Parent = newParent;
 
         if (newParent != nullptr)
         {
-            newParent->AddChild(sharedThis);
+            ChildIndex = newParent->Children.size();
+            newParent->Children.push_back(sharedThis);
         }
 
+        const auto &store = (newParent != nullptr) ? newParent->Transforms : TransformStore::GetDetachedStore();
+        const auto parentId = (newParent != nullptr) ? newParent->TransformId : TransformStore::InvalidId;
+        if (store == Transforms)
+        {
+            Transforms->SetParent(TransformId, parentId);
+        }
+        else
+        {
+            MoveToScene(store, parentId, (newParent != nullptr) ? newParent->Pools : ComponentPools::GetDetachedPools());
+        }
+    }
+
+    void SceneObject::NotifyParentChanged()
+    {
         SetWorldMatrixDirty();
         SetSceneParentDirty();
 
-        ParentChanged.Run(sharedThis, GetSceneParent());
-
-        return true;
+        ParentChanged.Run(shared_from_this(), GetSceneParent());
     }
 
     void SceneObject::AddChild(const SceneObject::Pointer &newChild)
@@ -70,21 +108,73 @@ namespace Spinner
             throw std::runtime_error("Cannot add a SceneObject to it's own children");
         }
 
-        if (!Contains(Children, newChild))
+        // SetParent removes the child from its old parent, whose index it still holds, before linking it here
+        if (newChild->GetParent() != sharedThis)
+        {
+            newChild->SetParent(sharedThis);
+            return;
+        }
+
+        if (!HasChild(newChild))
         {
+            newChild->ChildIndex = Children.size();
             Children.push_back(newChild);
         }
+    }
 
-        if (newChild->GetParent() != sharedThis)
+    void SceneObject::AttachChildren(std::span<const SceneObject::Pointer> newChildren)
+    {
+        auto sharedThis = shared_from_this();
+        Children.reserve(Children.size() + newChildren.size());
+
+        // Every child is linked before any of them is marked or notified, linked children are appended so they end up after firstAttached
+        const auto firstAttached = Children.size();
+        for (const auto &newChild : newChildren)
         {
-            newChild->SetParent(sharedThis);
+            if (newChild == sharedThis)
+            {
+                throw std::runtime_error("Cannot add a SceneObject to it's own children");
+            }
+            if (newChild == nullptr || newChild->IsScene || HasChild(newChild))
+            {
+                continue;
+            }
+            newChild->LinkParent(sharedThis);
+        }
+
+        if (Children.size() == firstAttached)
+        {
+            return;
+        }
+
+        // Copied, a ParentChanged callback may change the children
+        const std::vector<SceneObject::Pointer> attached(Children.begin() + static_cast<std::ptrdiff_t>(firstAttached), Children.end());
+        for (const auto &child : attached)
+        {
+            child->NotifyParentChanged();
         }
     }
 
     bool SceneObject::RemoveChild(const SceneObject::Pointer &child)
     {
-        size_t erased = std::erase(Children, child);
-        return erased > 0;
+        if (!HasChild(child))
+        {
+            return false;
+        }
+
+        const auto index = child->ChildIndex;
+        if (index != Children.size() - 1)
+        {
+            Children[index] = std::move(Children.back());
+            Children[index]->ChildIndex = index;
+        }
+        Children.pop_back();
+        return true;
+    }
+
+    bool SceneObject::HasChild(const SceneObject::Pointer &child) const
+    {
+        return child != nullptr && child->ChildIndex < Children.size() && Children[child->ChildIndex] == child;
     }
 
     bool SceneObject::IsActive() const
@@ -99,15 +189,8 @@ namespace Spinner
 
     void SceneObject::SetWorldMatrixDirty()
     {
-        DirtyWorldMatrix = true;
-
-        for (auto &child : Children)
-        {
-            if (child != nullptr)
-            {
-                child->SetWorldMatrixDirty();
-            }
-        }
+        // Descendants find out lazily through the store's generations
+        Transforms->SetWorldDirty(TransformId);
     }
 
     void SceneObject::SetSceneParentDirty()
@@ -123,68 +206,60 @@ namespace Spinner
         }
     }
 
-    void SceneObject::ConstructMatrix()
+    void SceneObject::MoveToScene(const TransformStore::Pointer &store, TransformStore::Id parentId, const ComponentPools::Pointer &pools)
     {
-        Matrix = glm::translate(glm::mat4{1.0f}, Position) * glm::mat4_cast(Rotation) * glm::eulerAngleYXZ(glm::radians(EulerRotation.y), glm::radians(EulerRotation.x), glm::radians(EulerRotation.z)) * glm::scale(glm::mat4{1.0f}, Scale);
-        DirtyMatrix = false;
-    }
+        const auto id = store->Add(parentId);
+        store->CopyLocal(id, *Transforms, TransformId);
+        Transforms->Remove(TransformId);
+        Transforms = store;
+        TransformId = id;
 
-    void SceneObject::ConstructWorldMatrix()
-    {
-        if (IsScene)
+        for (auto &component : Components)
         {
-            WorldMatrix = glm::mat4{1.0f};
+            Pools->Remove(component.get());
+            pools->Add(component.get(), this);
         }
-        else if (GetParent() != nullptr)
-        {
-            WorldMatrix = GetLocalMatrix() * GetParent()->GetWorldMatrix();
-        }
-        else
+        Pools = pools;
+
+        for (auto &child : Children)
         {
-            WorldMatrix = GetLocalMatrix();
+            if (child != nullptr)
+            {
+                child->MoveToScene(store, TransformId, pools);
+            }
         }
-
-        InverseWorldMatrix = glm::inverse(WorldMatrix);
-
-        DirtyWorldMatrix = false;
     }
 
     glm::mat4 SceneObject::GetLocalMatrix()
     {
-        if (DirtyMatrix)
-        {
-            ConstructMatrix();
-        }
-
-        return Matrix;
+        return Transforms->GetLocalMatrix(TransformId);
     }
 
     glm::vec3 SceneObject::GetLocalPosition()
     {
-        return Position;
+        return Transforms->GetPosition(TransformId);
     }
 
     glm::quat SceneObject::GetLocalRotation()
     {
-        return Rotation;
+        return Transforms->GetRotation(TransformId);
     }
 
     glm::vec3 SceneObject::GetLocalEulerRotation()
     {
-        return EulerRotation;
+        return Transforms->GetEulerRotation(TransformId);
     }
 
     glm::vec3 SceneObject::GetLocalScale()
     {
-        return Scale;
+        return Transforms->GetScale(TransformId);
     }
 
     void SceneObject::SetLocalPosition(glm::vec3 position)
     {
         if (IsScene)
             return;
-        Position = position;
-        DirtyMatrix = true;
+        Transforms->SetPosition(TransformId, position);
         SetWorldMatrixDirty();
     }
 
@@ -192,8 +267,7 @@ namespace Spinner
     {
         if (IsScene)
             return;
-        Rotation = rotation;
-        DirtyMatrix = true;
+        Transforms->SetRotation(TransformId, rotation);
         SetWorldMatrixDirty();
     }
 
@@ -204,8 +278,7 @@ namespace Spinner
             return;
         }
 
-        EulerRotation = eulerRotation;
-        DirtyMatrix = true;
+        Transforms->SetEulerRotation(TransformId, eulerRotation);
         SetWorldMatrixDirty();
     }
 
@@ -213,8 +286,7 @@ namespace Spinner
     {
         if (IsScene)
             return;
-        Scale = scale;
-        DirtyMatrix = true;
+        Transforms->SetScale(TransformId, scale);
         SetWorldMatrixDirty();
     }
 
@@ -227,60 +299,34 @@ namespace Spinner
         glm::quat rotation;
         glm::vec4 perspective;
         glm::decompose(matrix, scale, rotation, position, skew, perspective);
-        Position = position;
-        Rotation = rotation;
-        Scale = scale;
-        EulerRotation = {0, 0, 0};
+        Transforms->SetLocal(TransformId, position, rotation, {0, 0, 0}, scale);
 
-        DirtyMatrix = true;
         SetWorldMatrixDirty();
     }
 
     glm::mat4 SceneObject::GetWorldMatrix()
     {
-        if (DirtyWorldMatrix)
-        {
-            ConstructWorldMatrix();
-        }
-
-        return WorldMatrix;
+        return Transforms->GetWorldMatrix(TransformId);
     }
 
     glm::mat4 SceneObject::GetInverseWorldMatrix()
     {
-        if (DirtyWorldMatrix)
-        {
-            ConstructWorldMatrix();
-        }
-
-        return InverseWorldMatrix;
+        return Transforms->GetInverseWorldMatrix(TransformId);
     }
 
     glm::vec3 SceneObject::GetWorldPosition()
     {
-        glm::vec3 position, scale, skew;
-        glm::quat rotation;
-        glm::vec4 perspective;
-        glm::decompose(GetWorldMatrix(), scale, rotation, position, skew, perspective);
-        return position;
+        return Transforms->GetWorldPosition(TransformId);
     }
 
     glm::quat SceneObject::GetWorldRotation()
     {
-        glm::vec3 position, scale, skew;
-        glm::quat rotation;
-        glm::vec4 perspective;
-        glm::decompose(GetWorldMatrix(), scale, rotation, position, skew, perspective);
-        return rotation;
+        return Transforms->GetWorldRotation(TransformId);
     }
 
     glm::vec3 SceneObject::GetWorldScale()
     {
-        glm::vec3 position, scale, skew;
-        glm::quat rotation;
-        glm::vec4 perspective;
-        glm::decompose(GetWorldMatrix(), scale, rotation, position, skew, perspective);
-        return scale;
+        return Transforms->GetWorldScale(TransformId);
     }
 
     void SceneObject::SetWorldMatrix(const glm::mat4 &matrix)
@@ -332,82 +378,34 @@ namespace Spinner
         SetLocalScale(scale / parent->GetWorldScale());
     }
 
-    bool SceneObject::HasComponent(Components::ComponentId componentId) const
+    void SceneObject::RemoveComponent(Components::Component *component)
     {
-        for (const auto &component : Components)
+        const auto ownedComponent = std::find_if(Components.begin(), Components.end(), [&](const Components::Component::Pointer &ownedComponent)
         {
-            if (component->GetComponentId() == componentId)
-            {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    size_t SceneObject::ComponentCount(Components::ComponentId componentId) const
-    {
-        size_t count = 0;
-        for (const auto &component : Components)
+            return ownedComponent.get() == component;
+        });
+        if (component == nullptr || ownedComponent == Components.end())
         {
-            if (component->GetComponentId() == componentId)
-            {
-                count++;
-            }
+            return;
         }
 
-        return count;
+        Pools->Remove(component);
+        ComponentTypeCounts[component->GetComponentId()]--;
+        Components.erase(ownedComponent);
     }
 
-    void SceneObject::Traverse(const std::function<bool(const SceneObject::Pointer &)> &traverseFunction, const std::function<void(const SceneObject::Pointer &)> &traverseUpFunction, int maxDepth, int currentDepth)
+    bool SceneObject::HasComponent(Components::ComponentId componentId) const
     {
-        if (traverseFunction == nullptr)
-            return;
-
-        if (!IsScene)
-        {
-            bool result = traverseFunction(shared_from_this());
-            if (!result)
-                return;
-        }
-
-        if (currentDepth >= maxDepth && maxDepth > 0)
-            return;
-
-        for (auto &child : Children)
-        {
-            child->Traverse(traverseFunction, traverseUpFunction, maxDepth, currentDepth + 1);
-        }
-
-        if (!IsScene && traverseUpFunction)
-        {
-            traverseUpFunction(shared_from_this());
-        }
+        return ComponentCount(componentId) > 0;
     }
 
-    void SceneObject::TraverseActive(const std::function<bool(const SceneObject::Pointer &)> &traverseFunction, const std::function<void(const SceneObject::Pointer &)> &traverseUpFunction, int maxDepth, int currentDepth)
+    size_t SceneObject::ComponentCount(Components::ComponentId componentId) const
     {
-        if (traverseFunction == nullptr)
-            return;
-
-        if (!IsScene && IsActive())
-        {
-            bool result = traverseFunction(shared_from_this());
-            if (!result)
-                return;
-        }
-
-        if (currentDepth >= maxDepth && maxDepth > 0)
-            return;
-
-        for (auto &child : Children)
-        {
-            child->TraverseActive(traverseFunction, traverseUpFunction, maxDepth, currentDepth + 1);
-        }
-
-        if (!IsScene && traverseUpFunction)
+        if (componentId < 0 || static_cast<size_t>(componentId) >= ComponentTypeCounts.size())
         {
-            traverseUpFunction(shared_from_this());
+            return 0;
         }
+        return ComponentTypeCounts[componentId];
     }
 
     std::shared_ptr<Scene> SceneObject::GetSceneParent()
@@ -435,10 +433,10 @@ namespace Spinner
 
     SceneObject::Pointer SceneObject::Create(const std::string& name)
     {
-        return std::make_shared<Spinner::SceneObject>(name);
+        return std::allocate_shared<Spinner::SceneObject>(PoolAllocator<Spinner::SceneObject>(), name);
     }
 
-    std::vector<SceneObject::Pointer> SceneObject::GetChildren() const
+    std::span<const SceneObject::Pointer> SceneObject::GetChildren() const
     {
         return Children;
     }
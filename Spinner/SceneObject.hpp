@@ -2,10 +2,14 @@
 #define SPINNER_SCENEOBJECT_HPP
 
 #include <memory>
+#include <span>
 #include <string>
+#include <type_traits>
 
 #include "Object.hpp"
 #include "GLM.hpp"
+#include "TransformStore.hpp"
+#include "ComponentPools.hpp"
 #include "Components/MeshComponent.hpp"
 
 namespace Spinner
@@ -17,45 +21,51 @@ namespace Spinner
     // I don't like declaring this here but there are circular dependencies
     namespace Components
     {
+        /// Resolves in O(1) through the component's generational handle, a destroyed component's handle stays invalid even once its slot is reused
         template<IsComponent T>
         class ComponentPtr
         {
-            friend class SceneObject;
-
         public:
-            ComponentPtr() : ComponentIndex(0)
-            {
-            }
+            ComponentPtr() = default;
 
-            inline explicit ComponentPtr(const std::weak_ptr<SceneObject> &sceneObject, int64_t componentIndex)
+            inline explicit ComponentPtr(ComponentHandle handle) : Handle(handle)
             {
-                SceneObject = sceneObject;
-                ComponentIndex = componentIndex;
             }
 
             [[nodiscard]] inline std::shared_ptr<SceneObject> GetOwnerSceneObject() const
             {
-                return SceneObject.lock();
+                const auto *component = Get();
+                return (component != nullptr) ? component->GetSceneObject() : nullptr;
             }
 
             [[nodiscard]] inline bool IsValid() const noexcept
             {
-                return !SceneObject.expired();
+                return Get() != nullptr;
             }
 
-            // Declared further down as it requires access to SceneObject's templated functions
-            T *operator->() const;
+            /// nullptr once the component has been removed
+            [[nodiscard]] inline T *Get() const noexcept
+            {
+                return static_cast<T *>(Component::Resolve(GetComponentId<T>(), Handle));
+            }
 
-        protected:
-            /// Used internally by SceneObject
-            [[nodiscard]] inline int64_t GetComponentIndex() const noexcept
+            [[nodiscard]] inline ComponentHandle GetHandle() const noexcept
             {
-                return ComponentIndex;
+                return Handle;
+            }
+
+            inline T *operator->() const
+            {
+                auto *component = Get();
+                if (component == nullptr)
+                {
+                    throw ComponentError("Component no longer exists");
+                }
+                return component;
             }
 
         protected:
-            std::weak_ptr<SceneObject> SceneObject;
-            int64_t ComponentIndex;
+            ComponentHandle Handle;
         };
     }
 
@@ -70,7 +80,7 @@ namespace Spinner
     public:
         constexpr inline static std::string DefaultName = "Unnamed Object";
         explicit SceneObject(std::string name = DefaultName, bool isScene = false);
-        ~SceneObject() override = default;
+        ~SceneObject() override;
 
     public:
         [[nodiscard]] std::string GetName() const;
@@ -80,13 +90,28 @@ namespace Spinner
         bool SetParent(const Pointer &newParent);
 
         void AddChild(const Pointer &newChild);
+        /// As AddChild for each child, but links them all before marking them dirty and running their ParentChanged callbacks in one pass
+        void AttachChildren(std::span<const Pointer> newChildren);
+        /// O(1), the last child takes the removed child's place so sibling order is not kept
         bool RemoveChild(const Pointer &child);
 
         bool IsActive() const;
         void SetActive(bool active);
 
-        void Traverse(const std::function<bool(const SceneObject::Pointer &)> &traverseFunction, const std::function<void(const SceneObject::Pointer &)> &traverseUpFunction = nullptr, int maxDepth = -1, int currentDepth = 0);
-        void TraverseActive(const std::function<bool(const SceneObject::Pointer &)> &traverseFunction, const std::function<void(const SceneObject::Pointer &)> &traverseUpFunction = nullptr, int maxDepth = -1, int currentDepth = 0);
+        /// Depth first, the scene root itself is skipped. traverseFunction returns false to skip the object's children.
+        /// Both functions take either a SceneObject & or a const SceneObject::Pointer &, the former avoids a shared_from_this per object
+        template<typename TraverseFunction, typename TraverseUpFunction = std::nullptr_t>
+        void Traverse(TraverseFunction &&traverseFunction, TraverseUpFunction &&traverseUpFunction = nullptr, int maxDepth = -1, int currentDepth = 0)
+        {
+            TraverseObjects<false>(traverseFunction, traverseUpFunction, maxDepth, currentDepth);
+        }
+
+        /// As Traverse, but traverseFunction is only called for active objects. Children of inactive objects are still visited
+        template<typename TraverseFunction, typename TraverseUpFunction = std::nullptr_t>
+        void TraverseActive(TraverseFunction &&traverseFunction, TraverseUpFunction &&traverseUpFunction = nullptr, int maxDepth = -1, int currentDepth = 0)
+        {
+            TraverseObjects<true>(traverseFunction, traverseUpFunction, maxDepth, currentDepth);
+        }
 
         glm::mat4 GetLocalMatrix();
         glm::vec3 GetLocalPosition();
@@ -113,16 +138,61 @@ namespace Spinner
 
         std::shared_ptr<Scene> GetSceneParent();
 
-        [[nodiscard]] std::vector<Pointer> GetChildren() const;
+        /// Valid until the children next change
+        [[nodiscard]] std::span<const Pointer> GetChildren() const;
         size_t GetChildrenCount() const;
         Pointer GetChildByIndex(size_t index) const;
         Pointer GetFirstChildWithName(const std::string &name) const;
 
     protected:
+        [[nodiscard]] bool HasChild(const Pointer &child) const;
         void SetWorldMatrixDirty();
         void SetSceneParentDirty();
-        void ConstructMatrix();
-        void ConstructWorldMatrix();
+        /// Swaps this object from its old parent's children to newParent's and moves its transform, without marking or notifying anything
+        void LinkParent(const Pointer &newParent);
+        /// The rest of a parent change once the links are in place: marks the transform and scene parent dirty, then runs ParentChanged
+        void NotifyParentChanged();
+        /// Moves this object's and its descendants' transforms and components into another scene's store and pools
+        void MoveToScene(const TransformStore::Pointer &store, TransformStore::Id parentId, const ComponentPools::Pointer &pools);
+
+        template<typename Function>
+        decltype(auto) VisitObject(Function &function)
+        {
+            if constexpr (std::is_invocable_v<Function &, SceneObject &>)
+            {
+                return function(*this);
+            }
+            else
+            {
+                return function(shared_from_this());
+            }
+        }
+
+        template<bool ActiveOnly, typename TraverseFunction, typename TraverseUpFunction>
+        void TraverseObjects(TraverseFunction &traverseFunction, TraverseUpFunction &traverseUpFunction, int maxDepth, int currentDepth)
+        {
+            if (!IsScene && (!ActiveOnly || IsActive()))
+            {
+                if (!VisitObject(traverseFunction))
+                    return;
+            }
+
+            if (currentDepth >= maxDepth && maxDepth > 0)
+                return;
+
+            for (auto &child : Children)
+            {
+                child->TraverseObjects<ActiveOnly>(traverseFunction, traverseUpFunction, maxDepth, currentDepth + 1);
+            }
+
+            if constexpr (!std::is_null_pointer_v<std::remove_cvref_t<TraverseUpFunction>>)
+            {
+                if (!IsScene)
+                {
+                    VisitObject(traverseUpFunction);
+                }
+            }
+        }
 
     public:
         // Components
@@ -152,7 +222,14 @@ namespace Spinner
         inline Components::ComponentPtr<T> AddComponent()
         {
             Components.push_back(std::make_unique<T>(weak_from_this(), ComponentIndexCounter));
-            auto componentPtr = Components::ComponentPtr<T>(weak_from_this(), ComponentIndexCounter);
+            Pools->Add(Components.back().get(), this);
+            const auto componentId = Components.back()->GetComponentId();
+            if (static_cast<size_t>(componentId) >= ComponentTypeCounts.size())
+            {
+                ComponentTypeCounts.resize(componentId + 1);
+            }
+            ComponentTypeCounts[componentId]++;
+            auto componentPtr = Components::ComponentPtr<T>(Components.back()->GetHandle());
 
             ComponentIndexCounter++;
 
@@ -224,7 +301,7 @@ namespace Spinner
             {
                 return {};
             }
-            return {Components::ComponentPtr<T>(shared_from_this(), ptr->GetComponentIndex())};
+            return {Components::ComponentPtr<T>(ptr->GetHandle())};
         }
 
         template<Components::IsComponent T>
@@ -236,7 +313,7 @@ namespace Spinner
             {
                 if (component->GetComponentId() == id)
                 {
-                    components.emplace_back(shared_from_this(), component->GetComponentIndex());
+                    components.emplace_back(component->GetHandle());
                 }
             }
 
@@ -251,7 +328,7 @@ namespace Spinner
             {
                 if (component->GetComponentId() == id)
                 {
-                    components.emplace_back(shared_from_this(), component->GetComponentIndex());
+                    components.emplace_back(component->GetHandle());
                 }
             }
         }
@@ -299,24 +376,11 @@ namespace Spinner
         template<Components::IsComponent T>
         inline void RemoveComponent(Components::ComponentPtr<T> componentPtr)
         {
-            Components::ComponentId id = Components::GetComponentId<T>();
-            int64_t componentIndex = componentPtr->GetComponentIndex();
-            std::remove_if(Components.begin(), Components.end(), [&id, &componentIndex](const Components::Component::Pointer &component)
-            {
-                return component->GetComponentId() == id && component->GetComponentIndex() == componentIndex;
-            });
+            RemoveComponent(componentPtr.Get());
         }
 
-        template<Components::IsComponent T>
-        inline void RemoveComponent(T *componentRawPtr)
-        {
-            Components::ComponentId id = Components::GetComponentId<T>();
-            int64_t componentIndex = componentRawPtr->GetComponentIndex();
-            std::remove_if(Components.begin(), Components.end(), [&id, &componentIndex](const Components::Component::Pointer &component)
-            {
-                return component->GetComponentId() == id && component->GetComponentIndex() == componentIndex;
-            });
-        }
+        /// Does nothing when the component is not one of this object's
+        void RemoveComponent(Components::Component *component);
 
         void RenderDebugUI();
 
@@ -329,39 +393,24 @@ namespace Spinner
         WeakPointer Parent{};
         std::weak_ptr<Spinner::Scene> SceneParent{};
         std::vector<Pointer> Children{};
+        size_t ChildIndex = 0; // Index in the parent's Children
 
         std::vector<Components::Component::Pointer> Components;
+        std::vector<uint32_t> ComponentTypeCounts; // Indexed by ComponentId, so HasComponent and ComponentCount do not scan Components
         std::atomic<int64_t> ComponentIndexCounter = 0;
 
-        glm::vec3 Position{0, 0, 0};
-        glm::quat Rotation{1, 0, 0, 0};
-        glm::vec3 EulerRotation{0, 0, 0}; // Operates in degrees
-        glm::vec3 Scale{1, 1, 1};
-        glm::mat4 Matrix{1.0f};
-        glm::mat4 WorldMatrix{1.0f};
-        glm::mat4 InverseWorldMatrix{1.0f};
+        // Position, rotation, euler rotation (in degrees), scale and the matrices live in the scene's store
+        TransformStore::Pointer Transforms;
+        TransformStore::Id TransformId = TransformStore::InvalidId;
+        ComponentPools::Pointer Pools;
 
         bool Active = true;
         const bool IsScene = false;
         bool DirtySceneParent = true;
-        bool DirtyMatrix = true;
-        bool DirtyWorldMatrix = true;
 
     public:
         static Pointer Create(const std::string &name);
     };
-
-    // Implementation that was mentioned further up
-    template<Components::IsComponent T>
-    T *Components::ComponentPtr<T>::operator->() const
-    {
-        if (SceneObject.expired())
-        {
-            throw ComponentError("Owner SceneObject of Component no longer exists");
-        }
-
-        return SceneObject.lock()->GetComponentRawPointer<T>(ComponentIndex);
-    }
 } // Spinner
 
 #endif //SPINNER_SCENEOBJECT_HPP
@@ -244,7 +244,6 @@ namespace Spinner
 
         for (auto &shader : Shaders)
         {
-            commandBuffer->TrackObject(shader);
             commandBuffer->BindShader(shader);
         }
     }
@@ -19,14 +19,14 @@ namespace Spinner
 
     Texture::Texture(std::string name, const std::vector<uint8_t> &textureData, vk::Extent2D size, vk::Format format, int mipLevels) : Name(std::move(name))
     {
-        Image = Image::CreateImage(size, format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
+        Image = Image::CreateImage(size, format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
         Image->Write(textureData, vk::ImageAspectFlagBits::eColor, nullptr);
         CreateMainImageView();
     }
 
     Texture::Texture(std::string name, const uint8_t *textureData, size_t textureDataSize, vk::Extent2D size, vk::Format format, int mipLevels) : Name(std::move(name))
     {
-        Image = Image::CreateImage(size, format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
+        Image = Image::CreateImage(size, format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageType::e2D, vk::ImageTiling::eOptimal, mipLevels, vma::MemoryUsage::eGpuOnly);
         Image->Write(textureData, textureDataSize, vk::ImageAspectFlagBits::eColor, nullptr);
         CreateMainImageView();
     }
@@ -41,8 +41,7 @@ namespace Spinner
 
     void Texture::LoadTexture(const std::string &textureFilename)
     {
-        uint32_t mipLevels = 1;
-        Image = Image::LoadFromTextureFile(textureFilename, mipLevels);
+        Image = Image::LoadFromTextureFile(textureFilename, Image::FullMipChain);
     }
 
     Spinner::Image::Pointer Texture::GetImage() const
@@ -147,6 +146,12 @@ namespace Spinner
             throw std::runtime_error("Cannot create main image view for an invalid image");
         }
 
+        // Images shared through the TextureCache already have their main view
+        if (Image->GetMainImageView())
+        {
+            return;
+        }
+
         Image->CreateMainImageView(vk::ImageAspectFlagBits::eColor);
     }
 } // Spinner
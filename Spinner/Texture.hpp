@@ -15,8 +15,9 @@ namespace Spinner
 
         Texture() = default;
         explicit Texture(const std::string &textureFilename);
-        Texture(std::string name, const std::vector<uint8_t> &textureData, vk::Extent2D size, vk::Format format = vk::Format::eR8G8B8A8Unorm, int mipLevels = 1);
-        Texture(std::string name, const uint8_t *textureData, size_t textureDataSize, vk::Extent2D size, vk::Format format = vk::Format::eR8G8B8A8Unorm, int mipLevels = 1);
+        /// textureData is the first mip level or the whole mip chain, block compressed formats need the whole chain unless mipLevels is 1
+        Texture(std::string name, const std::vector<uint8_t> &textureData, vk::Extent2D size, vk::Format format = vk::Format::eR8G8B8A8Unorm, int mipLevels = Image::FullMipChain);
+        Texture(std::string name, const uint8_t *textureData, size_t textureDataSize, vk::Extent2D size, vk::Format format = vk::Format::eR8G8B8A8Unorm, int mipLevels = Image::FullMipChain);
         Texture(std::string name, Spinner::Image::Pointer image,  Spinner::Sampler::Pointer sampler);
         virtual ~Texture() = default;
 
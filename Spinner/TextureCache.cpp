@@ -0,0 +1,100 @@
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+#include "ModelCache.hpp"
+
+namespace Spinner
+{
+    static constexpr size_t MinPruneSize = 64;
+
+    static std::mutex CacheMutex;
+    static std::unordered_map<TextureCache::Key, std::weak_ptr<Image>, TextureCache::KeyHash> CachedImages;
+    static size_t NextPruneSize = MinPruneSize;
+
+    // Expects CacheMutex to be locked
+    static void PruneExpired()
+    {
+        std::erase_if(CachedImages, [](const auto &entry) { return entry.second.expired(); });
+        NextPruneSize = std::max(MinPruneSize, CachedImages.size() * 2);
+    }
+
+    size_t TextureCache::KeyHash::operator()(const Key &key) const noexcept
+    {
+        const std::array<uint64_t, 2> words = {key.Source, (static_cast<uint64_t>(key.Format) << 32) | key.MipLevels};
+        return static_cast<size_t>(ModelCache::HashBytes({reinterpret_cast<const uint8_t *>(words.data()), sizeof(words)}));
+    }
+
+    uint64_t TextureCache::GetContentSource(std::span<const uint8_t> bytes)
+    {
+        return ModelCache::HashBytes(bytes);
+    }
+
+    uint64_t TextureCache::GetFileSource(const std::string &filePath)
+    {
+        std::error_code error;
+        const auto path = std::filesystem::absolute(filePath, error).string();
+        const auto writeTime = std::filesystem::last_write_time(filePath, error).time_since_epoch().count();
+        return ModelCache::HashBytes({reinterpret_cast<const uint8_t *>(path.data()), path.size()}, static_cast<uint64_t>(writeTime));
+    }
+
+    Image::Pointer TextureCache::Find(const Key &key)
+    {
+        std::scoped_lock lock(CacheMutex);
+        const auto entry = CachedImages.find(key);
+        if (entry == CachedImages.end())
+        {
+            return nullptr;
+        }
+
+        auto image = entry->second.lock();
+        if (image == nullptr)
+        {
+            CachedImages.erase(entry);
+        }
+        return image;
+    }
+
+    void TextureCache::Add(const Key &key, const Image::Pointer &image)
+    {
+        if (image == nullptr)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(CacheMutex);
+        CachedImages[key] = image;
+        if (CachedImages.size() >= NextPruneSize)
+        {
+            PruneExpired();
+        }
+    }
+
+    Image::Pointer TextureCache::GetOrCreate(const Key &key, const std::function<Image::Pointer()> &create)
+    {
+        if (auto image = Find(key))
+        {
+            return image;
+        }
+
+        auto image = create();
+        Add(key, image);
+        return image;
+    }
+
+    void TextureCache::Prune()
+    {
+        std::scoped_lock lock(CacheMutex);
+        PruneExpired();
+    }
+
+    size_t TextureCache::GetSize()
+    {
+        std::scoped_lock lock(CacheMutex);
+        return CachedImages.size();
+    }
+} // Spinner
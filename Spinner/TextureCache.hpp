@@ -0,0 +1,49 @@
+#ifndef SPINNER_TEXTURECACHE_HPP
+#define SPINNER_TEXTURECACHE_HPP
+
+#include <vulkan/vulkan.hpp>
+#include <functional>
+#include <span>
+#include <string>
+#include "Image.hpp"
+
+namespace Spinner
+{
+    /// Process wide cache of loaded images, so materials and models using the same source image share one Image.
+    /// Only weak references are held, so an image is evicted once nothing else uses it. Safe to use from any thread
+    class TextureCache
+    {
+    public:
+        struct Key
+        {
+            uint64_t Source = 0; // GetContentSource of the encoded image, or GetFileSource of a texture file
+            vk::Format Format = vk::Format::eUndefined; // Undefined when the source decides the format
+            uint32_t MipLevels = Image::FullMipChain;
+
+            bool operator==(const Key &other) const = default;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const noexcept;
+        };
+
+    public:
+        static uint64_t GetContentSource(std::span<const uint8_t> bytes);
+        /// From the file's path and last write time, so an edited file is loaded again
+        static uint64_t GetFileSource(const std::string &filePath);
+
+        /// Returns nullptr if the image was never added or has since been released
+        static Image::Pointer Find(const Key &key);
+        static void Add(const Key &key, const Image::Pointer &image);
+        /// Finds the image, otherwise creates and adds it. The cache is not locked while creating, so concurrent misses of one key may both create the image
+        static Image::Pointer GetOrCreate(const Key &key, const std::function<Image::Pointer()> &create);
+
+        /// Removes the entries of released images, which Add also does as the cache grows
+        static void Prune();
+        /// Number of entries, including released images which have not been pruned
+        static size_t GetSize();
+    };
+} // Spinner
+
+#endif //SPINNER_TEXTURECACHE_HPP
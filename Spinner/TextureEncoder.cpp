@@ -0,0 +1,332 @@
+#include "TextureEncoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "Image.hpp"
+#include "JobSystem.hpp"
+#include "ModelCache.hpp"
+#include "Utilities.hpp"
+#include "VulkanUtilities.hpp"
+
+namespace Spinner
+{
+    using BlockTexels = std::array<std::array<uint8_t, 4>, 16>;
+
+    static void WriteBlockBits(uint8_t *block, uint32_t offset, uint32_t count, uint32_t bits)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint32_t bit = offset + i;
+            block[bit / 8] |= static_cast<uint8_t>(((bits >> i) & 1u) << (bit % 8));
+        }
+    }
+
+    static uint16_t PackColor565(const std::array<float, 3> &color)
+    {
+        const auto quantize = [](float value, float maximum)
+        {
+            return static_cast<uint32_t>(std::clamp(std::round(value * maximum / 255.0f), 0.0f, maximum));
+        };
+        return static_cast<uint16_t>((quantize(color[0], 31.0f) << 11) | (quantize(color[1], 63.0f) << 5) | quantize(color[2], 31.0f));
+    }
+
+    static std::array<int32_t, 3> UnpackColor565(uint16_t color)
+    {
+        const int32_t r = (color >> 11) & 0x1F;
+        const int32_t g = (color >> 5) & 0x3F;
+        const int32_t b = color & 0x1F;
+        return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+    }
+
+    // 8 byte BC1 color block in the 4 color mode, endpoints are fit to the principal axis of the texels' colors
+    static void EncodeColorBlock(const BlockTexels &texels, uint8_t *block)
+    {
+        std::array<float, 3> mean{};
+        for (const auto &texel : texels)
+        {
+            for (size_t c = 0; c < 3; c++)
+            {
+                mean[c] += texel[c] / 16.0f;
+            }
+        }
+
+        // Covariance, then a few power iterations for the axis of greatest variance
+        std::array<float, 6> covariance{}; // rr, rg, rb, gg, gb, bb
+        for (const auto &texel : texels)
+        {
+            const float r = texel[0] - mean[0];
+            const float g = texel[1] - mean[1];
+            const float b = texel[2] - mean[2];
+            covariance[0] += r * r;
+            covariance[1] += r * g;
+            covariance[2] += r * b;
+            covariance[3] += g * g;
+            covariance[4] += g * b;
+            covariance[5] += b * b;
+        }
+
+        std::array<float, 3> axis{1.0f, 1.0f, 1.0f};
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            const std::array<float, 3> next{
+                covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+            };
+            const float length = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+            if (length < 1e-6f)
+            {
+                break;
+            }
+            axis = {next[0] / length, next[1] / length, next[2] / length};
+        }
+        const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        axis = {axis[0] / axisLength, axis[1] / axisLength, axis[2] / axisLength};
+
+        float minProjection = std::numeric_limits<float>::max();
+        float maxProjection = std::numeric_limits<float>::lowest();
+        for (const auto &texel : texels)
+        {
+            const float projection = (texel[0] - mean[0]) * axis[0] + (texel[1] - mean[1]) * axis[1] + (texel[2] - mean[2]) * axis[2];
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        // Inset the endpoints slightly, the interpolated colors then cover the texels more evenly
+        const float inset = (maxProjection - minProjection) / 16.0f;
+        minProjection += inset;
+        maxProjection -= inset;
+
+        uint16_t color0 = PackColor565({mean[0] + axis[0] * maxProjection, mean[1] + axis[1] * maxProjection, mean[2] + axis[2] * maxProjection});
+        uint16_t color1 = PackColor565({mean[0] + axis[0] * minProjection, mean[1] + axis[1] * minProjection, mean[2] + axis[2] * minProjection});
+        // The 4 color mode needs color0 > color1, equal endpoints only use index 0
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+        }
+
+        std::fill_n(block, 8, uint8_t{0});
+        block[0] = static_cast<uint8_t>(color0);
+        block[1] = static_cast<uint8_t>(color0 >> 8);
+        block[2] = static_cast<uint8_t>(color1);
+        block[3] = static_cast<uint8_t>(color1 >> 8);
+        if (color0 == color1)
+        {
+            return;
+        }
+
+        const auto endpoint0 = UnpackColor565(color0);
+        const auto endpoint1 = UnpackColor565(color1);
+        std::array<std::array<int32_t, 3>, 4> palette{endpoint0, endpoint1};
+        for (size_t c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * endpoint0[c] + endpoint1[c]) / 3;
+            palette[3][c] = (endpoint0[c] + 2 * endpoint1[c]) / 3;
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t bestIndex = 0;
+            int32_t bestDistance = std::numeric_limits<int32_t>::max();
+            for (uint32_t index = 0; index < 4; index++)
+            {
+                int32_t distance = 0;
+                for (size_t c = 0; c < 3; c++)
+                {
+                    const int32_t difference = texels[i][c] - palette[index][c];
+                    distance += difference * difference;
+                }
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+            WriteBlockBits(block + 4, i * 2, 2, bestIndex);
+        }
+    }
+
+    // 8 byte BC3 alpha / BC4 block of one channel, in the 8 value mode between the channel's extremes
+    static void EncodeChannelBlock(const BlockTexels &texels, size_t channel, uint8_t *block)
+    {
+        uint32_t minimum = 255;
+        uint32_t maximum = 0;
+        for (const auto &texel : texels)
+        {
+            minimum = std::min<uint32_t>(minimum, texel[channel]);
+            maximum = std::max<uint32_t>(maximum, texel[channel]);
+        }
+
+        std::fill_n(block, 8, uint8_t{0});
+        block[0] = static_cast<uint8_t>(maximum);
+        block[1] = static_cast<uint8_t>(minimum);
+        if (minimum == maximum)
+        {
+            return;
+        }
+
+        std::array<int32_t, 8> palette{static_cast<int32_t>(maximum), static_cast<int32_t>(minimum)};
+        for (uint32_t i = 1; i < 7; i++)
+        {
+            palette[i + 1] = static_cast<int32_t>(((7 - i) * maximum + i * minimum) / 7);
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t bestIndex = 0;
+            int32_t bestDistance = std::numeric_limits<int32_t>::max();
+            for (uint32_t index = 0; index < 8; index++)
+            {
+                const int32_t distance = std::abs(texels[i][channel] - palette[index]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+            WriteBlockBits(block + 2, i * 3, 3, bestIndex);
+        }
+    }
+
+    vk::Format TextureEncoder::ChooseFormat(const uint8_t *rgba, size_t pixelCount)
+    {
+        for (size_t i = 0; i < pixelCount; i++)
+        {
+            if (rgba[i * 4 + 3] < 255)
+            {
+                return vk::Format::eBc3UnormBlock;
+            }
+        }
+        return vk::Format::eBc1RgbUnormBlock;
+    }
+
+    bool TextureEncoder::CanEncode(vk::Format format)
+    {
+        switch (format)
+        {
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+            case vk::Format::eBc5UnormBlock:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::vector<uint8_t> TextureEncoder::Encode(vk::Format format, const uint8_t *rgba, vk::Extent2D extent)
+    {
+        if (!CanEncode(format))
+        {
+            throw std::runtime_error("Cannot encode textures to format " + vk::to_string(format));
+        }
+
+        const size_t blockSize = VkFormatBlockSize(format);
+        const uint32_t blocksWide = (extent.width + 3) / 4;
+        const uint32_t blocksHigh = (extent.height + 3) / 4;
+        std::vector<uint8_t> encoded(VkFormatImageSize(format, {extent.width, extent.height, 1}));
+
+        JobSystem::ParallelForOrInline(blocksHigh, EncodeRowGrainSize, [&](size_t firstRow, size_t endRow)
+        {
+            BlockTexels texels;
+            for (size_t blockY = firstRow; blockY < endRow; blockY++)
+            {
+                for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+                {
+                    for (uint32_t y = 0; y < 4; y++)
+                    {
+                        const uint32_t sourceY = std::min(static_cast<uint32_t>(blockY) * 4 + y, extent.height - 1);
+                        for (uint32_t x = 0; x < 4; x++)
+                        {
+                            const uint32_t sourceX = std::min(blockX * 4 + x, extent.width - 1);
+                            const uint8_t *texel = rgba + (static_cast<size_t>(sourceY) * extent.width + sourceX) * 4;
+                            std::copy_n(texel, 4, texels[y * 4 + x].begin());
+                        }
+                    }
+
+                    uint8_t *block = encoded.data() + (blockY * blocksWide + blockX) * blockSize;
+                    switch (format)
+                    {
+                        case vk::Format::eBc3UnormBlock:
+                        case vk::Format::eBc3SrgbBlock:
+                            EncodeChannelBlock(texels, 3, block);
+                            EncodeColorBlock(texels, block + 8);
+                            break;
+                        case vk::Format::eBc5UnormBlock:
+                            EncodeChannelBlock(texels, 0, block);
+                            EncodeChannelBlock(texels, 1, block + 8);
+                            break;
+                        default:
+                            EncodeColorBlock(texels, block);
+                            break;
+                    }
+                }
+            }
+        });
+
+        return encoded;
+    }
+
+    std::vector<uint8_t> TextureEncoder::EncodeMipChain(vk::Format format, const uint8_t *rgba, vk::Extent2D extent, uint32_t mipLevels)
+    {
+        const vk::Extent3D extent3D{extent.width, extent.height, 1};
+        const auto mipChain = Image::GenerateMipChain(vk::Format::eR8G8B8A8Unorm, rgba, static_cast<size_t>(extent.width) * extent.height * 4, extent3D, mipLevels);
+
+        std::vector<uint8_t> encoded;
+        encoded.reserve(mipChain.size() / 4);
+        size_t offset = 0;
+        for (uint32_t mip = 0; mip < mipLevels; mip++)
+        {
+            const auto mipExtent = Image::GetMipExtent(extent3D, mip);
+            const auto level = Encode(format, mipChain.data() + offset, {mipExtent.width, mipExtent.height});
+            encoded.insert(encoded.end(), level.begin(), level.end());
+            offset += static_cast<size_t>(mipExtent.width) * mipExtent.height * 4;
+        }
+
+        return encoded;
+    }
+
+    std::string TextureEncoder::GetCachePath(uint64_t sourceHash)
+    {
+        const uint64_t key = ModelCache::HashBytes({reinterpret_cast<const uint8_t *>(&sourceHash), sizeof(sourceHash)}, EncoderVersion);
+
+        std::ostringstream name;
+        name << "Textures/" << std::hex << std::setw(16) << std::setfill('0') << key << Ktx2File::Extension;
+        return GetAssetPath(AssetType::Cache, name.str());
+    }
+
+    Ktx2File::Pointer TextureEncoder::LoadCached(uint64_t sourceHash)
+    {
+        const auto cachePath = GetCachePath(sourceHash);
+        if (!FileExists(cachePath))
+        {
+            return nullptr;
+        }
+
+        try
+        {
+            auto file = Ktx2File::Open(cachePath);
+            // Only complete encodes are stored
+            if (!CanEncode(file->GetFormat()) || file->GetMipLevels() != Image::GetMipLevelCount({file->GetExtent().width, file->GetExtent().height, 1}))
+            {
+                return nullptr;
+            }
+            return file;
+        }
+        catch (const std::exception &)
+        {
+            return nullptr;
+        }
+    }
+
+    void TextureEncoder::StoreCached(uint64_t sourceHash, const Ktx2File &file)
+    {
+        file.Write(GetCachePath(sourceHash));
+    }
+} // Spinner
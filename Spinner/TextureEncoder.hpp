@@ -0,0 +1,39 @@
+#ifndef SPINNER_TEXTUREENCODER_HPP
+#define SPINNER_TEXTUREENCODER_HPP
+
+#include <vulkan/vulkan.hpp>
+#include <string>
+#include <vector>
+#include "Ktx2File.hpp"
+
+namespace Spinner
+{
+    /// CPU block compression of RGBA8 images, for textures imported from PNG, JPEG etc.
+    /// Encoding is slow next to loading, so results are cached on disk as KTX2 files keyed by the source image's content hash (TextureCache::GetContentSource)
+    class TextureEncoder
+    {
+    public:
+        /// Part of every cache key, bump when the encoded output changes
+        static constexpr uint32_t EncoderVersion = 1;
+        /// Rows of 4x4 blocks per job when encoding on the job system
+        static constexpr size_t EncodeRowGrainSize = 4;
+
+    public:
+        /// BC1 for opaque images, BC3 when any texel has alpha
+        static vk::Format ChooseFormat(const uint8_t *rgba, size_t pixelCount);
+        /// BC1 (opaque), BC3 and BC5 (from red and green)
+        static bool CanEncode(vk::Format format);
+
+        /// Encodes a single level, rows of blocks are encoded on the job system. Partial blocks at the edges repeat the edge texels
+        static std::vector<uint8_t> Encode(vk::Format format, const uint8_t *rgba, vk::Extent2D extent);
+        /// Box filters the mip chain then encodes every level, tightly packed from the first
+        static std::vector<uint8_t> EncodeMipChain(vk::Format format, const uint8_t *rgba, vk::Extent2D extent, uint32_t mipLevels);
+
+        static std::string GetCachePath(uint64_t sourceHash);
+        /// Returns nullptr when there is no valid cached encode of the source
+        static Ktx2File::Pointer LoadCached(uint64_t sourceHash);
+        static void StoreCached(uint64_t sourceHash, const Ktx2File &file);
+    };
+} // Spinner
+
+#endif //SPINNER_TEXTUREENCODER_HPP
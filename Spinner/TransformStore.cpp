@@ -0,0 +1,441 @@
+#include "TransformStore.hpp"
+
+namespace Spinner
+{
+    // Applies a slot permutation to one of the per slot arrays
+    template<typename T>
+    static void Permute(std::vector<T> &values, const std::vector<uint32_t> &order)
+    {
+        std::vector<T> permuted;
+        permuted.reserve(order.size());
+        for (const auto slot : order)
+        {
+            permuted.push_back(values[slot]);
+        }
+        values = std::move(permuted);
+    }
+
+    TransformStore::Id TransformStore::Add(Id parent)
+    {
+        Id id;
+        if (!FreeIds.empty())
+        {
+            id = FreeIds.back();
+            FreeIds.pop_back();
+        }
+        else
+        {
+            id = static_cast<Id>(Slots.size());
+            Slots.push_back(0);
+        }
+
+        const auto slot = static_cast<uint32_t>(SlotIds.size());
+        Slots[id] = slot;
+
+        Positions.emplace_back(0, 0, 0);
+        Rotations.emplace_back(1, 0, 0, 0);
+        EulerRotations.emplace_back(0, 0, 0);
+        Scales.emplace_back(1, 1, 1);
+        LocalMatrices.emplace_back(1.0f);
+        WorldMatrices.emplace_back(1.0f);
+        InverseWorldMatrices.emplace_back(1.0f);
+        WorldRotations.emplace_back(1, 0, 0, 0);
+        WorldScales.emplace_back(1, 1, 1);
+        ParentSlots.push_back(parent != InvalidId ? Slots[parent] : NoParent);
+        Generations.push_back(0);
+        ParentGenerations.push_back(0);
+        Flags.push_back(LocalDirtyFlag | WorldDirtyFlag | InverseDirtyFlag | DecomposedDirtyFlag);
+        SlotIds.push_back(id);
+
+        return id;
+    }
+
+    void TransformStore::Remove(Id id)
+    {
+        const auto slot = Slots[id];
+        SlotIds[slot] = InvalidId;
+        ParentSlots[slot] = NoParent;
+        Slots[id] = NoParent;
+        FreeIds.push_back(id);
+        RemovedSlotCount++;
+
+        // Compacted here rather than only by the next pass, so stores which are never updated (like the detached store) still shrink
+        if (RemovedSlotCount * 4 > SlotIds.size())
+        {
+            Reorder();
+        }
+    }
+
+    void TransformStore::SetParent(Id id, Id parent)
+    {
+        const auto slot = Slots[id];
+        const auto parentSlot = (parent != InvalidId) ? Slots[parent] : NoParent;
+        ParentSlots[slot] = parentSlot;
+        Flags[slot] |= WorldDirtyFlag | InverseDirtyFlag;
+
+        if (parentSlot != NoParent && parentSlot > slot)
+        {
+            OrderBroken = true;
+        }
+    }
+
+    void TransformStore::CopyLocal(Id id, const TransformStore &source, Id sourceId)
+    {
+        const auto sourceSlot = source.Slots[sourceId];
+        SetLocal(id, source.Positions[sourceSlot], source.Rotations[sourceSlot], source.EulerRotations[sourceSlot], source.Scales[sourceSlot]);
+    }
+
+    glm::vec3 TransformStore::GetPosition(Id id) const
+    {
+        return Positions[Slots[id]];
+    }
+
+    glm::quat TransformStore::GetRotation(Id id) const
+    {
+        return Rotations[Slots[id]];
+    }
+
+    glm::vec3 TransformStore::GetEulerRotation(Id id) const
+    {
+        return EulerRotations[Slots[id]];
+    }
+
+    glm::vec3 TransformStore::GetScale(Id id) const
+    {
+        return Scales[Slots[id]];
+    }
+
+    void TransformStore::SetPosition(Id id, glm::vec3 position)
+    {
+        const auto slot = Slots[id];
+        Positions[slot] = position;
+        Flags[slot] |= LocalDirtyFlag | WorldDirtyFlag | InverseDirtyFlag;
+    }
+
+    void TransformStore::SetRotation(Id id, glm::quat rotation)
+    {
+        const auto slot = Slots[id];
+        Rotations[slot] = rotation;
+        Flags[slot] |= LocalDirtyFlag | WorldDirtyFlag | InverseDirtyFlag;
+    }
+
+    void TransformStore::SetEulerRotation(Id id, glm::vec3 eulerRotation)
+    {
+        const auto slot = Slots[id];
+        EulerRotations[slot] = eulerRotation;
+        Flags[slot] |= LocalDirtyFlag | WorldDirtyFlag | InverseDirtyFlag;
+    }
+
+    void TransformStore::SetScale(Id id, glm::vec3 scale)
+    {
+        const auto slot = Slots[id];
+        Scales[slot] = scale;
+        Flags[slot] |= LocalDirtyFlag | WorldDirtyFlag | InverseDirtyFlag;
+    }
+
+    void TransformStore::SetLocal(Id id, glm::vec3 position, glm::quat rotation, glm::vec3 eulerRotation, glm::vec3 scale)
+    {
+        const auto slot = Slots[id];
+        Positions[slot] = position;
+        Rotations[slot] = rotation;
+        EulerRotations[slot] = eulerRotation;
+        Scales[slot] = scale;
+        Flags[slot] |= LocalDirtyFlag | WorldDirtyFlag | InverseDirtyFlag;
+    }
+
+    void TransformStore::SetWorldDirty(Id id)
+    {
+        Flags[Slots[id]] |= WorldDirtyFlag | InverseDirtyFlag;
+    }
+
+    const glm::mat4 &TransformStore::GetLocalMatrix(Id id)
+    {
+        const auto slot = Slots[id];
+        if (Flags[slot] & LocalDirtyFlag)
+        {
+            UpdateLocalMatrix(slot);
+        }
+        return LocalMatrices[slot];
+    }
+
+    const glm::mat4 &TransformStore::GetWorldMatrix(Id id)
+    {
+        const auto slot = Slots[id];
+
+        // Any ancestor may have been marked, so the chain is checked from the root down
+        DirtyChain.clear();
+        for (auto chainSlot = slot; chainSlot != NoParent; chainSlot = GetLiveParentSlot(chainSlot))
+        {
+            DirtyChain.push_back(chainSlot);
+        }
+        for (auto chainSlot = DirtyChain.rbegin(); chainSlot != DirtyChain.rend(); ++chainSlot)
+        {
+            if (IsWorldStale(*chainSlot))
+            {
+                UpdateWorldMatrix(*chainSlot);
+            }
+        }
+
+        return WorldMatrices[slot];
+    }
+
+    const glm::mat4 &TransformStore::GetInverseWorldMatrix(Id id)
+    {
+        const auto &worldMatrix = GetWorldMatrix(id);
+        const auto slot = Slots[id];
+        if (Flags[slot] & InverseDirtyFlag)
+        {
+            InverseWorldMatrices[slot] = glm::inverse(worldMatrix);
+            Flags[slot] &= ~InverseDirtyFlag;
+        }
+        return InverseWorldMatrices[slot];
+    }
+
+    glm::vec3 TransformStore::GetWorldPosition(Id id)
+    {
+        return GetWorldMatrix(id)[3];
+    }
+
+    const glm::quat &TransformStore::GetWorldRotation(Id id)
+    {
+        GetWorldMatrix(id);
+        const auto slot = Slots[id];
+        if (Flags[slot] & DecomposedDirtyFlag)
+        {
+            UpdateDecomposed(slot);
+        }
+        return WorldRotations[slot];
+    }
+
+    const glm::vec3 &TransformStore::GetWorldScale(Id id)
+    {
+        GetWorldMatrix(id);
+        const auto slot = Slots[id];
+        if (Flags[slot] & DecomposedDirtyFlag)
+        {
+            UpdateDecomposed(slot);
+        }
+        return WorldScales[slot];
+    }
+
+    void TransformStore::UpdateWorldMatrices()
+    {
+        if (OrderBroken)
+        {
+            Reorder();
+        }
+
+        // Parents come first, so a dirty parent has always been rebuilt before its children read it
+        const auto slotCount = static_cast<uint32_t>(SlotIds.size());
+        for (uint32_t slot = 0; slot < slotCount; slot++)
+        {
+            if (SlotIds[slot] != InvalidId && IsWorldStale(slot))
+            {
+                UpdateWorldMatrix(slot);
+            }
+        }
+    }
+
+    uint32_t TransformStore::GetGeneration(Id id) const
+    {
+        return Generations[Slots[id]];
+    }
+
+    size_t TransformStore::GetSize() const noexcept
+    {
+        return SlotIds.size() - RemovedSlotCount;
+    }
+
+    size_t TransformStore::GetSlotCount() const noexcept
+    {
+        return SlotIds.size();
+    }
+
+    uint32_t TransformStore::GetLiveParentSlot(uint32_t slot) const
+    {
+        const auto parentSlot = ParentSlots[slot];
+        // A removed parent leaves its children as roots until they are reparented
+        if (parentSlot == NoParent || SlotIds[parentSlot] == InvalidId)
+        {
+            return NoParent;
+        }
+        return parentSlot;
+    }
+
+    bool TransformStore::IsWorldStale(uint32_t slot) const
+    {
+        if (Flags[slot] & WorldDirtyFlag)
+        {
+            return true;
+        }
+
+        // Orphaned children compare against 0 too, so they drop their removed parent's transform
+        const auto parentSlot = GetLiveParentSlot(slot);
+        return ParentGenerations[slot] != ((parentSlot != NoParent) ? Generations[parentSlot] : 0);
+    }
+
+    void TransformStore::UpdateLocalMatrix(uint32_t slot)
+    {
+        const auto &eulerRotation = EulerRotations[slot];
+        LocalMatrices[slot] = glm::translate(glm::mat4{1.0f}, Positions[slot]) * glm::mat4_cast(Rotations[slot]) * glm::eulerAngleYXZ(glm::radians(eulerRotation.y), glm::radians(eulerRotation.x), glm::radians(eulerRotation.z)) * glm::scale(glm::mat4{1.0f}, Scales[slot]);
+        Flags[slot] &= ~LocalDirtyFlag;
+    }
+
+    void TransformStore::UpdateWorldMatrix(uint32_t slot)
+    {
+        if (Flags[slot] & LocalDirtyFlag)
+        {
+            UpdateLocalMatrix(slot);
+        }
+
+        const auto parentSlot = GetLiveParentSlot(slot);
+        WorldMatrices[slot] = (parentSlot != NoParent) ? LocalMatrices[slot] * WorldMatrices[parentSlot] : LocalMatrices[slot];
+        ParentGenerations[slot] = (parentSlot != NoParent) ? Generations[parentSlot] : 0;
+        if (++Generations[slot] == 0)
+        {
+            Generations[slot] = 1;
+        }
+
+        const auto &scale = Scales[slot];
+        const bool uniformScale = scale.x > 0.0f && scale.x == scale.y && scale.x == scale.z && (parentSlot == NoParent || (Flags[parentSlot] & UniformScaleFlag));
+        Flags[slot] = (Flags[slot] & ~(WorldDirtyFlag | UniformScaleFlag)) | InverseDirtyFlag | DecomposedDirtyFlag | (uniformScale ? UniformScaleFlag : 0);
+    }
+
+    void TransformStore::UpdateDecomposed(uint32_t slot)
+    {
+        const auto &worldMatrix = WorldMatrices[slot];
+        if (Flags[slot] & UniformScaleFlag)
+        {
+            // Every axis has the same length, dividing it out leaves the rotation
+            const float scale = glm::length(glm::vec3(worldMatrix[0]));
+            WorldScales[slot] = glm::vec3(scale);
+            WorldRotations[slot] = glm::quat_cast(glm::mat3(worldMatrix) * (1.0f / scale));
+        }
+        else
+        {
+            glm::vec3 position, skew;
+            glm::vec4 perspective;
+            glm::decompose(worldMatrix, WorldScales[slot], WorldRotations[slot], position, skew, perspective);
+        }
+        Flags[slot] &= ~DecomposedDirtyFlag;
+    }
+
+    void TransformStore::Reorder()
+    {
+        const auto slotCount = static_cast<uint32_t>(SlotIds.size());
+
+        // Children of each slot, counted then filled in their current order
+        std::vector<uint32_t> childStarts(slotCount + 1, 0);
+        for (uint32_t slot = 0; slot < slotCount; slot++)
+        {
+            if (SlotIds[slot] == InvalidId)
+            {
+                continue;
+            }
+            if (const auto parentSlot = GetLiveParentSlot(slot); parentSlot != NoParent)
+            {
+                childStarts[parentSlot + 1]++;
+            }
+        }
+        for (uint32_t slot = 0; slot < slotCount; slot++)
+        {
+            childStarts[slot + 1] += childStarts[slot];
+        }
+        std::vector<uint32_t> children(childStarts.back());
+        std::vector<uint32_t> childCounts(slotCount, 0);
+        for (uint32_t slot = 0; slot < slotCount; slot++)
+        {
+            if (SlotIds[slot] == InvalidId)
+            {
+                continue;
+            }
+            if (const auto parentSlot = GetLiveParentSlot(slot); parentSlot != NoParent)
+            {
+                children[childStarts[parentSlot] + childCounts[parentSlot]++] = slot;
+            }
+        }
+
+        // Depth first from every root, so each subtree also ends up contiguous
+        std::vector<uint32_t> order;
+        order.reserve(slotCount - RemovedSlotCount);
+        std::vector<uint8_t> visited(slotCount, 0);
+        std::vector<uint32_t> stack;
+        const auto visitFrom = [&](uint32_t root)
+        {
+            stack.push_back(root);
+            while (!stack.empty())
+            {
+                const auto slot = stack.back();
+                stack.pop_back();
+                if (visited[slot])
+                {
+                    continue;
+                }
+                visited[slot] = 1;
+                order.push_back(slot);
+                for (auto child = childStarts[slot + 1]; child-- > childStarts[slot];)
+                {
+                    stack.push_back(children[child]);
+                }
+            }
+        };
+        for (uint32_t slot = 0; slot < slotCount; slot++)
+        {
+            if (SlotIds[slot] != InvalidId && GetLiveParentSlot(slot) == NoParent)
+            {
+                visitFrom(slot);
+            }
+        }
+        // Parenting cycles have no root, they keep their slots' relative order rather than being lost
+        for (uint32_t slot = 0; slot < slotCount; slot++)
+        {
+            if (SlotIds[slot] != InvalidId && !visited[slot])
+            {
+                visitFrom(slot);
+            }
+        }
+
+        std::vector<uint32_t> newSlots(slotCount, NoParent);
+        for (uint32_t newSlot = 0; newSlot < order.size(); newSlot++)
+        {
+            newSlots[order[newSlot]] = newSlot;
+        }
+
+        std::vector<uint32_t> parentSlots;
+        parentSlots.reserve(order.size());
+        for (const auto slot : order)
+        {
+            const auto parentSlot = GetLiveParentSlot(slot);
+            parentSlots.push_back((parentSlot != NoParent) ? newSlots[parentSlot] : NoParent);
+        }
+        ParentSlots = std::move(parentSlots);
+
+        Permute(Positions, order);
+        Permute(Rotations, order);
+        Permute(EulerRotations, order);
+        Permute(Scales, order);
+        Permute(LocalMatrices, order);
+        Permute(WorldMatrices, order);
+        Permute(InverseWorldMatrices, order);
+        Permute(WorldRotations, order);
+        Permute(WorldScales, order);
+        Permute(Generations, order);
+        Permute(ParentGenerations, order);
+        Permute(Flags, order);
+        Permute(SlotIds, order);
+
+        for (uint32_t slot = 0; slot < SlotIds.size(); slot++)
+        {
+            Slots[SlotIds[slot]] = slot;
+        }
+
+        RemovedSlotCount = 0;
+        OrderBroken = false;
+    }
+
+    const TransformStore::Pointer &TransformStore::GetDetachedStore()
+    {
+        static const Pointer detachedStore = std::make_shared<TransformStore>();
+        return detachedStore;
+    }
+} // Spinner
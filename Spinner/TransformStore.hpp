@@ -0,0 +1,118 @@
+#ifndef SPINNER_TRANSFORMSTORE_HPP
+#define SPINNER_TRANSFORMSTORE_HPP
+
+#include <memory>
+#include <vector>
+#include "GLM.hpp"
+
+namespace Spinner
+{
+    /// Structure of arrays storage of SceneObject transforms. Each scene owns one, objects outside of a scene share the detached store.
+    /// Slots are kept in topological order (parents before children) so UpdateWorldMatrices rebuilds every world matrix in one linear pass.
+    /// Objects keep a stable Id, their slot changes whenever the store reorders.
+    /// Setters only mark their own transform. Each world matrix counts its rebuilds and remembers its parent's count when it was built,
+    /// so a world matrix is stale when it was marked or its parent has been rebuilt since, and only matrices which are read get rebuilt
+    class TransformStore
+    {
+    public:
+        using Pointer = std::shared_ptr<TransformStore>;
+        using Id = uint32_t;
+
+        static constexpr Id InvalidId = ~0u;
+        static constexpr uint32_t NoParent = ~0u;
+
+    public:
+        TransformStore() = default;
+
+        /// The new transform is the identity, appended after its parent so the order is kept
+        Id Add(Id parent = InvalidId);
+        /// Compacts the store once more than a quarter of its slots are removed ones
+        void Remove(Id id);
+        /// Marks the transform's world matrix dirty, the store is reordered before the next pass when the parent comes after it
+        void SetParent(Id id, Id parent);
+        /// Copies the local transform of another store's transform, used when objects move between scenes
+        void CopyLocal(Id id, const TransformStore &source, Id sourceId);
+
+        [[nodiscard]] glm::vec3 GetPosition(Id id) const;
+        [[nodiscard]] glm::quat GetRotation(Id id) const;
+        [[nodiscard]] glm::vec3 GetEulerRotation(Id id) const;
+        [[nodiscard]] glm::vec3 GetScale(Id id) const;
+        void SetPosition(Id id, glm::vec3 position);
+        void SetRotation(Id id, glm::quat rotation);
+        void SetEulerRotation(Id id, glm::vec3 eulerRotation);
+        void SetScale(Id id, glm::vec3 scale);
+        void SetLocal(Id id, glm::vec3 position, glm::quat rotation, glm::vec3 eulerRotation, glm::vec3 scale);
+
+        /// Only marks the transform itself, descendants see that it was rebuilt through its generation
+        void SetWorldDirty(Id id);
+
+        const glm::mat4 &GetLocalMatrix(Id id);
+        /// Rebuilds the world matrix and any stale ancestors' when it is stale, so it is correct between passes
+        const glm::mat4 &GetWorldMatrix(Id id);
+        /// Inverted on demand, most transforms never need it
+        const glm::mat4 &GetInverseWorldMatrix(Id id);
+        /// The world matrix's translation column
+        glm::vec3 GetWorldPosition(Id id);
+        /// Decomposed on demand and cached until the world matrix changes, without a decompose when the hierarchy's scale is uniform
+        const glm::quat &GetWorldRotation(Id id);
+        const glm::vec3 &GetWorldScale(Id id);
+        /// Changes each time the world matrix is rebuilt, so a cached copy of something derived from it can tell when it is out of date
+        [[nodiscard]] uint32_t GetGeneration(Id id) const;
+
+        /// Rebuilds every stale world matrix, parents before children
+        void UpdateWorldMatrices();
+
+        /// Live transforms
+        [[nodiscard]] size_t GetSize() const noexcept;
+        /// Live transforms plus removed ones not compacted yet
+        [[nodiscard]] size_t GetSlotCount() const noexcept;
+
+    protected:
+        static constexpr uint8_t LocalDirtyFlag = 1u << 0;
+        static constexpr uint8_t WorldDirtyFlag = 1u << 1;
+        static constexpr uint8_t InverseDirtyFlag = 1u << 2;
+        static constexpr uint8_t DecomposedDirtyFlag = 1u << 3;
+        static constexpr uint8_t UniformScaleFlag = 1u << 4; // Positive uniform scale all the way up, so the world matrix is rotation * scale + translation
+
+        // Indexed by slot
+        std::vector<glm::vec3> Positions;
+        std::vector<glm::quat> Rotations;
+        std::vector<glm::vec3> EulerRotations; // Operates in degrees
+        std::vector<glm::vec3> Scales;
+        std::vector<glm::mat4> LocalMatrices;
+        std::vector<glm::mat4> WorldMatrices;
+        std::vector<glm::mat4> InverseWorldMatrices;
+        std::vector<glm::quat> WorldRotations;
+        std::vector<glm::vec3> WorldScales;
+        std::vector<uint32_t> ParentSlots;
+        std::vector<uint32_t> Generations; // Incremented whenever the world matrix is rebuilt, never 0 once built
+        std::vector<uint32_t> ParentGenerations; // The parent's generation when the world matrix was built, 0 when built without a parent
+        std::vector<uint8_t> Flags;
+        std::vector<Id> SlotIds; // InvalidId for removed slots, which are compacted when reordering
+
+        // Indexed by Id
+        std::vector<uint32_t> Slots;
+        std::vector<Id> FreeIds;
+
+        size_t RemovedSlotCount = 0;
+        bool OrderBroken = false;
+
+        std::vector<uint32_t> DirtyChain; // Scratch for GetWorldMatrix
+
+    protected:
+        [[nodiscard]] uint32_t GetLiveParentSlot(uint32_t slot) const;
+        /// Expects the parent to be up to date
+        [[nodiscard]] bool IsWorldStale(uint32_t slot) const;
+        void UpdateLocalMatrix(uint32_t slot);
+        void UpdateWorldMatrix(uint32_t slot);
+        void UpdateDecomposed(uint32_t slot);
+        /// Restores topological order with subtrees depth first, and compacts removed slots
+        void Reorder();
+
+    public:
+        /// Shared by every object which is not in a scene
+        static const Pointer &GetDetachedStore();
+    };
+} // Spinner
+
+#endif //SPINNER_TRANSFORMSTORE_HPP
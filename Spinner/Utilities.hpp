@@ -6,6 +6,7 @@
 #include <string>
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
 
 #include "Extra/AlignedAllocator.hpp"
 
@@ -32,6 +33,16 @@ namespace Spinner
         return (std::find(haystack.begin(), haystack.end(), needle) != haystack.end());
     }
 
+    /// True when reference was given an object which has since been destroyed, false while it is alive or when it never had one
+    template<typename T>
+    inline bool IsExpiredReference(const std::weak_ptr<T> &reference)
+    {
+        // Owner comparison tells an empty weak_ptr apart from one whose object is gone, expired() is true for both
+        const std::weak_ptr<T> empty;
+        const bool neverSet = !reference.owner_before(empty) && !empty.owner_before(reference);
+        return !neverSet && reference.expired();
+    }
+
     template<typename T>
     inline bool IsPow2(T x)
     {
@@ -56,7 +67,8 @@ namespace Spinner
     {
         Shader,
         Model,
-        Texture
+        Texture,
+        Cache
     };
 
     inline std::string GetAssetPath(AssetType assetType, std::string assetName)
@@ -72,6 +84,9 @@ namespace Spinner
             case AssetType::Texture:
                 assetName = "Assets/" + assetName;
                 break;
+            case AssetType::Cache:
+                assetName = "Cache/" + assetName;
+                break;
         }
 
         return currentDirectory.string() + "/" + assetName;
@@ -83,8 +83,84 @@ namespace Spinner
         }
     }
 
+#define CASES_VK_FORMAT_BLOCK_SRGB(family)\
+    case vk::Format::e##family##UnormBlock:\
+    case vk::Format::e##family##SrgbBlock:
+
+#define CASES_VK_FORMAT_BLOCK_SNORM(family)\
+    case vk::Format::e##family##UnormBlock:\
+    case vk::Format::e##family##SnormBlock:
+
+    bool VkFormatIsBlockCompressed(vk::Format format)
+    {
+        switch (format)
+        {
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc1Rgb)
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc1Rgba)
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc2)
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc3)
+            CASES_VK_FORMAT_BLOCK_SNORM(Bc4)
+            CASES_VK_FORMAT_BLOCK_SNORM(Bc5)
+            case vk::Format::eBc6HUfloatBlock:
+            case vk::Format::eBc6HSfloatBlock:
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc7)
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    vk::Extent2D VkFormatBlockExtent(vk::Format format)
+    {
+        // Every BC format uses 4x4 blocks
+        return VkFormatIsBlockCompressed(format) ? vk::Extent2D{4, 4} : vk::Extent2D{1, 1};
+    }
+
+    size_t VkFormatBlockSize(vk::Format format)
+    {
+        switch (format)
+        {
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc1Rgb)
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc1Rgba)
+            CASES_VK_FORMAT_BLOCK_SNORM(Bc4)
+                return 8;
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc2)
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc3)
+            CASES_VK_FORMAT_BLOCK_SNORM(Bc5)
+            case vk::Format::eBc6HUfloatBlock:
+            case vk::Format::eBc6HSfloatBlock:
+            CASES_VK_FORMAT_BLOCK_SRGB(Bc7)
+                return 16;
+            default:
+                return VkFormatByteWidth(format);
+        }
+    }
+
+    size_t VkFormatImageSize(vk::Format format, vk::Extent3D extent)
+    {
+        const auto blockExtent = VkFormatBlockExtent(format);
+        const size_t blocksWide = (extent.width + blockExtent.width - 1) / blockExtent.width;
+        const size_t blocksHigh = (extent.height + blockExtent.height - 1) / blockExtent.height;
+        return blocksWide * blocksHigh * extent.depth * VkFormatBlockSize(format);
+    }
+
     bool VkFormatHasStencilComponent(vk::Format format)
     {
         return format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint || format == vk::Format::eD16UnormS8Uint || format == vk::Format::eS8Uint;
     }
+
+    size_t VkIndexTypeByteWidth(vk::IndexType indexType)
+    {
+        switch (indexType)
+        {
+            default:
+                throw std::runtime_error("Unhandled index type byte width size");
+            case vk::IndexType::eUint8EXT:
+                return 1;
+            case vk::IndexType::eUint16:
+                return 2;
+            case vk::IndexType::eUint32:
+                return 4;
+        }
+    }
 } // Spinner
\ No newline at end of file
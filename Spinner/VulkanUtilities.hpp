@@ -5,8 +5,17 @@
 
 namespace Spinner
 {
+    /// Bytes per texel, block compressed formats have no per texel size and throw
     size_t VkFormatByteWidth(vk::Format format);
+    bool VkFormatIsBlockCompressed(vk::Format format);
+    /// Texels covered by one block, 1x1 for uncompressed formats
+    vk::Extent2D VkFormatBlockExtent(vk::Format format);
+    /// Bytes per block, which is the texel size for uncompressed formats
+    size_t VkFormatBlockSize(vk::Format format);
+    /// Bytes of a tightly packed image, partial blocks at the edges are whole blocks
+    size_t VkFormatImageSize(vk::Format format, vk::Extent3D extent);
     bool VkFormatHasStencilComponent(vk::Format format);
+    size_t VkIndexTypeByteWidth(vk::IndexType indexType);
 
     template<typename T>
     inline vk::IndexType GetVkIndexType()
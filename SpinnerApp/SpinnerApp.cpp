@@ -1,5 +1,6 @@
 #include "SpinnerApp.hpp"
 #include "Spinner/MeshData/StaticMeshVertex.hpp"
+#include "Spinner/MeshData/QuantizedStaticMeshVertex.hpp"
 #include "Spinner/Components/Components.hpp"
 
 using namespace Spinner;
@@ -33,13 +34,14 @@ void SpinnerApp::AppInit()
     }
 
     MeshData::StaticMeshVertex::CreateShaders();
+    MeshData::QuantizedStaticMeshVertex::CreateShaders();
 
-    auto testObject = Scene::LoadModel("sponza lit.glb");
-
-    if (!Scene->AddObjectToScene(testObject))
-    {
-        throw std::runtime_error("Model was unable to be loaded");
-    }
+    ModelImportSettings importSettings;
+    importSettings.OptimizeMeshes = true;
+    importSettings.GenerateLods = true;
+    importSettings.CompressTextures = true;
+    // Streams into the scene over the following frames
+    Scene->LoadModelAsync("sponza lit.glb", importSettings);
 
     auto cameraObject = SceneObject::Create("Main Camera");
     Camera = cameraObject->AddComponent<Components::CameraComponent>();
@@ -83,9 +85,6 @@ void SpinnerApp::AppRender(Spinner::CommandBuffer::Pointer &commandBuffer, uint3
     commandBuffer->InsertImageMemoryBarrier(swapchainImage, vk::AccessFlagBits2::eNone, vk::AccessFlagBits2::eColorAttachmentWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eAttachmentOptimal, vk::PipelineStageFlagBits2::eTopOfPipe, vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
     commandBuffer->TransitionImageLayout(DepthImage, depthImageLayout, depthBarrierAspect, vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests, vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests, vk::ImageSubresourceRange(depthBarrierAspect, 0, 1, 0, 1));
 
-    // Track depth image
-    commandBuffer->TrackObject(DepthImage);
-
     vk::ClearValue colorClearValue;
     colorClearValue.color = {0.4f, 0.58f, 0.93f, 1.0f}; // Cornflower Blue
 
@@ -161,10 +160,13 @@ void SpinnerApp::AppCleanup()
     Texture::ReleaseDefaultTextures();
 
     MeshData::StaticMeshVertex::DestroyShaders();
+    MeshData::QuantizedStaticMeshVertex::DestroyShaders();
 }
 
 void SpinnerApp::AppUpdate()
 {
+    Scene->Update();
+
     ImGuiInstance::StartFrame();
     AppImGui();
 
@@ -204,12 +206,22 @@ void SpinnerApp::AppImGui()
         }
 
         ImGui::End();
+
+        if (ImGui::Begin("Memory", &ViewDebugUI, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize))
+        {
+            ImGui::SetWindowPos(ImVec2(350.0f, extentImGui.y - 200.0f), ImGuiCond_Always);
+            ImGui::SetWindowSize(ImVec2(extentImGui.x - 700.0f, 200.0f));
+
+            Graphics::GetMemoryDefragmenter()->RenderDebugUI();
+        }
+
+        ImGui::End();
     }
 }
 
 void SpinnerApp::RecreateDepthImage()
 {
-    DepthImage.reset();
+    Graphics::DeferRelease(std::move(DepthImage));
 
     DepthImage = Image::CreateImage(Graphics::GetSwapchainExtent(), Graphics->FindDepthFormat(), vk::ImageUsageFlagBits::eDepthStencilAttachment);
     DepthImage->CreateMainImageView(vk::ImageAspectFlagBits::eDepth);
@@ -0,0 +1,171 @@
+#include "Check.hpp"
+#include "Spinner/BoundingVolumeHierarchy.hpp"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace Spinner;
+
+static Aabb RandomBox(std::mt19937 &random, float worldSize)
+{
+    std::uniform_real_distribution<float> position(0.0f, worldSize);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+    const glm::vec3 min = {position(random), position(random), position(random)};
+    return {min, min + glm::vec3(size(random), size(random), size(random))};
+}
+
+// Every leaf whose fattened bounds overlap, found by checking them all
+static std::vector<uint64_t> QueryLinear(const BoundingVolumeHierarchy &tree, const std::vector<BoundingVolumeHierarchy::ProxyId> &proxies, const Aabb &bounds)
+{
+    std::vector<uint64_t> found;
+    for (const auto proxy : proxies)
+    {
+        if (proxy != BoundingVolumeHierarchy::NullNode && bounds.Overlaps(tree.GetFatBounds(proxy)))
+        {
+            found.push_back(tree.GetUserData(proxy));
+        }
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+static std::vector<uint64_t> QueryTree(const BoundingVolumeHierarchy &tree, const Aabb &bounds)
+{
+    std::vector<uint64_t> found;
+    tree.QueryAabb(bounds, [&found](uint64_t userData) { found.push_back(userData); });
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+// Queries match a linear scan after inserts, moves, removals and a rebuild, and the tree stays balanced
+static void QueriesMatchLinearScan()
+{
+    BoundingVolumeHierarchy tree;
+    std::mt19937 random(1);
+    std::vector<BoundingVolumeHierarchy::ProxyId> proxies;
+    for (uint64_t i = 0; i < 5000; i++)
+    {
+        proxies.push_back(tree.Insert(RandomBox(random, 200.0f), i));
+    }
+
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = 0; i < 250; i++)
+        {
+            const auto index = random() % proxies.size();
+            if (proxies[index] != BoundingVolumeHierarchy::NullNode)
+            {
+                tree.Move(proxies[index], RandomBox(random, 200.0f));
+            }
+        }
+        for (int i = 0; i < 50; i++)
+        {
+            const auto index = random() % proxies.size();
+            if (proxies[index] != BoundingVolumeHierarchy::NullNode)
+            {
+                tree.Remove(proxies[index]);
+                proxies[index] = BoundingVolumeHierarchy::NullNode;
+            }
+        }
+        if (round == 10)
+        {
+            tree.Rebuild();
+        }
+
+        for (int i = 0; i < 20; i++)
+        {
+            const auto query = RandomBox(random, 200.0f);
+            const Aabb bounds = {query.Min, query.Max + glm::vec3(20.0f)};
+            SPINNER_CHECK(QueryTree(tree, bounds) == QueryLinear(tree, proxies, bounds));
+        }
+    }
+
+    SPINNER_CHECK(tree.GetProxyCount() == static_cast<size_t>(std::count_if(proxies.begin(), proxies.end(), [](auto proxy) { return proxy != BoundingVolumeHierarchy::NullNode; })));
+    SPINNER_CHECK(tree.GetHeight() < 40);
+}
+
+// Queries nested inside another query's callback, and stopping early, leave the outer traversal intact
+static void NestedAndStoppedQueries()
+{
+    BoundingVolumeHierarchy tree;
+    std::mt19937 random(2);
+    std::vector<BoundingVolumeHierarchy::ProxyId> proxies;
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+        proxies.push_back(tree.Insert(RandomBox(random, 50.0f), i));
+    }
+    const Aabb everything = {glm::vec3(-100.0f), glm::vec3(100.0f)};
+
+    size_t outerCount = 0;
+    bool nestedMatches = true;
+    tree.QueryAabb(everything, [&](uint64_t userData)
+    {
+        outerCount++;
+        if (userData % 100 == 0)
+        {
+            const auto &bounds = tree.GetFatBounds(proxies[userData]);
+            nestedMatches = nestedMatches && QueryTree(tree, bounds) == QueryLinear(tree, proxies, bounds);
+
+            size_t stoppedCount = 0;
+            tree.QueryAabb(everything, [&stoppedCount](uint64_t) { return ++stoppedCount < 3; });
+            nestedMatches = nestedMatches && stoppedCount == 3;
+        }
+    });
+    SPINNER_CHECK(outerCount == proxies.size());
+    SPINNER_CHECK(nestedMatches);
+}
+
+// Const queries from several threads at once each see the whole tree
+static void ConcurrentQueries()
+{
+    BoundingVolumeHierarchy tree;
+    std::mt19937 random(3);
+    std::vector<BoundingVolumeHierarchy::ProxyId> proxies;
+    for (uint64_t i = 0; i < 20000; i++)
+    {
+        proxies.push_back(tree.Insert(RandomBox(random, 500.0f), i));
+    }
+
+    std::vector<Aabb> queries;
+    std::vector<std::vector<uint64_t>> expected;
+    for (int i = 0; i < 64; i++)
+    {
+        const auto query = RandomBox(random, 500.0f);
+        queries.push_back({query.Min, query.Max + glm::vec3(40.0f)});
+        expected.push_back(QueryLinear(tree, proxies, queries.back()));
+    }
+
+    std::vector<int> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < mismatches.size(); thread++)
+    {
+        threads.emplace_back([&, thread]()
+        {
+            for (int repeat = 0; repeat < 20; repeat++)
+            {
+                for (size_t i = 0; i < queries.size(); i++)
+                {
+                    mismatches[thread] += (QueryTree(tree, queries[i]) != expected[i]) ? 1 : 0;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto count : mismatches)
+    {
+        SPINNER_CHECK(count == 0);
+    }
+}
+
+int main()
+{
+    Tests::Run("QueriesMatchLinearScan", QueriesMatchLinearScan);
+    Tests::Run("NestedAndStoppedQueries", NestedAndStoppedQueries);
+    Tests::Run("ConcurrentQueries", ConcurrentQueries);
+    return Tests::Result();
+}
@@ -0,0 +1,37 @@
+#ifndef SPINNER_TESTS_CHECK_HPP
+#define SPINNER_TESTS_CHECK_HPP
+
+#include <iostream>
+
+namespace Spinner::Tests
+{
+    inline int FailureCount = 0;
+
+    /// Runs one test function, reporting its name and whether any of its checks failed
+    template<typename Function>
+    inline void Run(const char *name, Function &&function)
+    {
+        const auto failuresBefore = FailureCount;
+        function();
+        std::cout << ((FailureCount == failuresBefore) ? "[ PASS ] " : "[ FAIL ] ") << name << '\n';
+    }
+
+    /// Exit code for main, non zero when any check failed
+    [[nodiscard]] inline int Result()
+    {
+        return (FailureCount == 0) ? 0 : 1;
+    }
+} // Spinner::Tests
+
+/// Reports a failed condition and carries on, so one run lists every failure
+#define SPINNER_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            Spinner::Tests::FailureCount++; \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": check failed: " << #condition << '\n'; \
+        } \
+    } while (false)
+
+#endif //SPINNER_TESTS_CHECK_HPP
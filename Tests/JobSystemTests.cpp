@@ -0,0 +1,339 @@
+#include "Check.hpp"
+#include "Spinner/JobSystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+using namespace Spinner;
+
+// Not derived from std::exception, so only a catch (...) sees it
+struct CustomError
+{
+    int Value;
+};
+
+// Every index is visited exactly once, in chunks of at most grainSize which start on a multiple of it, whatever the count and grain
+static void ParallelForCoversRange()
+{
+    JobSystem jobs(3);
+    for (const size_t count : {0, 1, 2, 7, 100, 1000, 10007})
+    {
+        for (const size_t grainSize : {0, 1, 3, 64, 5000})
+        {
+            const auto grain = std::max<size_t>(grainSize, 1);
+            std::vector<std::atomic<int>> visits(count);
+            std::atomic<int> calls = 0;
+            std::atomic<bool> chunksValid = true;
+            jobs.ParallelFor(count, grainSize, [&](size_t begin, size_t end)
+            {
+                calls++;
+                if (begin >= end || end > count || end - begin > grain || begin % grain != 0)
+                {
+                    chunksValid = false;
+                }
+                for (auto i = begin; i < end; i++)
+                {
+                    visits[i]++;
+                }
+            });
+
+            SPINNER_CHECK(chunksValid);
+            SPINNER_CHECK(std::all_of(visits.begin(), visits.end(), [](const auto &visit) { return visit == 1; }));
+            SPINNER_CHECK(calls == static_cast<int>((count + grain - 1) / grain));
+        }
+    }
+}
+
+// A range no larger than one chunk runs inline on the calling thread, without touching the queues
+static void SmallRangesRunInline()
+{
+    JobSystem jobs(2);
+    const auto caller = std::this_thread::get_id();
+    bool ranInline = false;
+    jobs.ParallelFor(10, 64, [&](size_t begin, size_t end)
+    {
+        ranInline = begin == 0 && end == 10 && std::this_thread::get_id() == caller;
+    });
+    SPINNER_CHECK(ranInline);
+
+    bool called = false;
+    jobs.ParallelFor(0, 0, [&](size_t, size_t) { called = true; });
+    SPINNER_CHECK(!called);
+}
+
+// A job queued after a counter only starts once every job of that counter has finished, through a chain of dependencies
+static void RunAfterWaitsForDependencies()
+{
+    JobSystem jobs(3);
+    constexpr int jobCount = 200;
+
+    JobCounter first;
+    std::atomic<int> firstDone = 0;
+    for (int i = 0; i < jobCount; i++)
+    {
+        jobs.Run([&firstDone]()
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            firstDone++;
+        }, &first);
+    }
+
+    JobCounter second;
+    std::atomic<int> firstDoneSeenBySecond = -1;
+    jobs.RunAfter(first, [&]() { firstDoneSeenBySecond = firstDone.load(); }, &second);
+
+    JobCounter third;
+    std::atomic<int> seenByThird = -1;
+    jobs.RunAfter(second, [&]() { seenByThird = firstDoneSeenBySecond.load(); }, &third);
+
+    jobs.Wait(third);
+    SPINNER_CHECK(first.IsDone());
+    SPINNER_CHECK(second.IsDone());
+    SPINNER_CHECK(firstDoneSeenBySecond == jobCount);
+    SPINNER_CHECK(seenByThird == jobCount);
+
+    // A dependency which is already done runs the job straight away
+    JobCounter fourth;
+    std::atomic<bool> ran = false;
+    jobs.RunAfter(first, [&ran]() { ran = true; }, &fourth);
+    jobs.Wait(fourth);
+    SPINNER_CHECK(ran);
+}
+
+// Main thread jobs run only on the thread which created the job system, from RunMainThreadJobs or while it waits
+static void MainThreadJobs()
+{
+    JobSystem jobs(2);
+    const auto mainThread = std::this_thread::get_id();
+    SPINNER_CHECK(jobs.IsMainThread());
+    SPINNER_CHECK(jobs.GetWorkerCount() == 2);
+
+    // Only run when asked
+    bool ranDirectly = false;
+    jobs.RunOnMainThread([&ranDirectly]() { ranDirectly = true; });
+    SPINNER_CHECK(!ranDirectly);
+    jobs.RunMainThreadJobs();
+    SPINNER_CHECK(ranDirectly);
+
+    // Queued from workers, the main thread runs them while it waits or from RunMainThreadJobs
+    JobCounter queued;
+    JobCounter mainThreadJobs;
+    std::atomic<int> onMainThread = 0;
+    for (int i = 0; i < 20; i++)
+    {
+        jobs.Run([&]()
+        {
+            jobs.RunOnMainThread([&]() { onMainThread += (std::this_thread::get_id() == mainThread) ? 1 : 0; }, &mainThreadJobs);
+        }, &queued);
+    }
+    jobs.Wait(queued);
+    jobs.RunMainThreadJobs();
+    SPINNER_CHECK(onMainThread == 20);
+    SPINNER_CHECK(mainThreadJobs.IsDone());
+
+    // A worker job waiting on a main thread job, which the main thread runs while it waits in turn
+    JobCounter waitingWorker;
+    std::atomic<bool> workerSawMainThreadJob = false;
+    jobs.Run([&]()
+    {
+        JobCounter mainThreadJob;
+        std::atomic<bool> ran = false;
+        jobs.RunOnMainThread([&ran]() { ran = true; }, &mainThreadJob);
+        jobs.Wait(mainThreadJob);
+        workerSawMainThreadJob = ran.load();
+    }, &waitingWorker);
+    jobs.Wait(waitingWorker);
+    SPINNER_CHECK(workerSawMainThreadJob);
+
+    // Any other thread is refused
+    bool refused = false;
+    std::thread([&]()
+    {
+        try
+        {
+            jobs.RunMainThreadJobs();
+        }
+        catch (const std::runtime_error &)
+        {
+            refused = true;
+        }
+    }).join();
+    SPINNER_CHECK(refused);
+}
+
+// While another thread floods the job system, the main thread's ParallelFor only runs its own chunks and never one of the flood's
+static void MainThreadDoesNotRunForeignJobs()
+{
+    JobSystem jobs(2);
+    const auto mainThread = std::this_thread::get_id();
+    std::atomic<int> floodRequests = 0;
+    std::atomic<int> floodsQueued = 0;
+    std::atomic<bool> stopping = false;
+    std::atomic<int> foreignOnMainThread = 0;
+
+    // Queues a batch of slow jobs each time the main thread asks, so they are queued while its own chunks are still waiting
+    std::thread loader([&]()
+    {
+        JobCounter counter;
+        while (!stopping)
+        {
+            if (floodsQueued == floodRequests)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            for (int i = 0; i < 100; i++)
+            {
+                jobs.Run([&]()
+                {
+                    foreignOnMainThread += (std::this_thread::get_id() == mainThread) ? 1 : 0;
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }, &counter);
+            }
+            floodsQueued++;
+        }
+        jobs.Wait(counter);
+    });
+
+    for (int frame = 0; frame < 20; frame++)
+    {
+        std::atomic<int> visited = 0;
+        jobs.ParallelFor(1000, 10, [&](size_t begin, size_t end)
+        {
+            // The calling thread runs the first chunk, the flood is queued before it goes on to wait for the rest
+            if (begin == 0)
+            {
+                floodRequests++;
+                while (floodsQueued != floodRequests)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            visited += static_cast<int>(end - begin);
+        });
+        SPINNER_CHECK(visited == 1000);
+    }
+    stopping = true;
+    loader.join();
+
+    SPINNER_CHECK(floodsQueued == 20);
+    SPINNER_CHECK(foreignOnMainThread == 0);
+}
+
+// Exceptions of any type reach whoever waits, counters are always released, and the workers carry on
+static void ExceptionsPropagate()
+{
+    JobSystem jobs(3);
+
+    JobCounter counter;
+    std::atomic<int> finished = 0;
+    jobs.Run([]() { throw CustomError{7}; }, &counter);
+    for (int i = 0; i < 50; i++)
+    {
+        jobs.Run([&finished]() { finished++; }, &counter);
+    }
+    int caught = 0;
+    try
+    {
+        jobs.Wait(counter);
+    }
+    catch (const CustomError &error)
+    {
+        caught = error.Value;
+    }
+    SPINNER_CHECK(caught == 7);
+    SPINNER_CHECK(counter.IsDone());
+    SPINNER_CHECK(finished == 50);
+
+    // Skipped after a failed dependency, which passes the exception on
+    JobCounter dependent;
+    bool dependentRan = false;
+    jobs.RunAfter(counter, [&dependentRan]() { dependentRan = true; }, &dependent);
+    bool dependentThrew = false;
+    try
+    {
+        jobs.Wait(dependent);
+    }
+    catch (const CustomError &)
+    {
+        dependentThrew = true;
+    }
+    SPINNER_CHECK(dependentThrew);
+    SPINNER_CHECK(!dependentRan);
+
+    // From a worker's chunk and from the calling thread's chunk
+    for (const size_t throwingChunk : {0, 37})
+    {
+        bool rethrown = false;
+        try
+        {
+            jobs.ParallelFor(100, 1, [throwingChunk](size_t begin, size_t)
+            {
+                if (begin == throwingChunk)
+                {
+                    throw std::runtime_error("chunk failed");
+                }
+            });
+        }
+        catch (const std::runtime_error &)
+        {
+            rethrown = true;
+        }
+        SPINNER_CHECK(rethrown);
+    }
+
+    // Without a counter it is only reported, and later jobs still run
+    jobs.Run([]() { throw 1.5; });
+    JobCounter after;
+    std::atomic<bool> ran = false;
+    jobs.Run([&ran]() { ran = true; }, &after);
+    jobs.Wait(after);
+    SPINNER_CHECK(ran);
+}
+
+// Destroying the job system with work still queued returns promptly: jobs already running finish, the rest are discarded
+static void ShutdownWithQueuedWork()
+{
+    constexpr int jobCount = 2000;
+    std::atomic<int> started = 0;
+    std::atomic<int> finished = 0;
+    bool mainThreadJobRan = false;
+    JobCounter counter;
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        JobSystem jobs(2);
+        for (int i = 0; i < jobCount; i++)
+        {
+            jobs.Run([&]()
+            {
+                started++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                finished++;
+            }, &counter);
+        }
+        jobs.RunOnMainThread([&mainThreadJobRan]() { mainThreadJobRan = true; });
+        SPINNER_CHECK(JobSystem::Get() == &jobs);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    SPINNER_CHECK(JobSystem::Get() == nullptr);
+    SPINNER_CHECK(started == finished);
+    SPINNER_CHECK(finished < jobCount);
+    SPINNER_CHECK(!mainThreadJobRan);
+    // Running every job on two workers would take about a second
+    SPINNER_CHECK(elapsed < std::chrono::milliseconds(500));
+}
+
+int main()
+{
+    Tests::Run("ParallelForCoversRange", ParallelForCoversRange);
+    Tests::Run("SmallRangesRunInline", SmallRangesRunInline);
+    Tests::Run("RunAfterWaitsForDependencies", RunAfterWaitsForDependencies);
+    Tests::Run("MainThreadJobs", MainThreadJobs);
+    Tests::Run("MainThreadDoesNotRunForeignJobs", MainThreadDoesNotRunForeignJobs);
+    Tests::Run("ExceptionsPropagate", ExceptionsPropagate);
+    Tests::Run("ShutdownWithQueuedWork", ShutdownWithQueuedWork);
+    return Tests::Result();
+}
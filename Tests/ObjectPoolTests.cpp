@@ -0,0 +1,176 @@
+#include "Check.hpp"
+#include "Spinner/ObjectPool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+using namespace Spinner;
+
+// Blocks are aligned, distinct, counted, and freed blocks are reused before the pool grows
+static void AllocateAndReuse()
+{
+    ObjectPool pool(40, 16);
+    SPINNER_CHECK(pool.GetBlockSize() % ObjectPool::BlockAlignment == 0);
+    SPINNER_CHECK(pool.GetBlockSize() >= 40);
+
+    std::vector<void *> blocks;
+    for (int i = 0; i < 100; i++)
+    {
+        blocks.push_back(pool.Allocate());
+        SPINNER_CHECK(reinterpret_cast<uintptr_t>(blocks.back()) % ObjectPool::BlockAlignment == 0);
+    }
+    auto sorted = blocks;
+    std::sort(sorted.begin(), sorted.end());
+    SPINNER_CHECK(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    SPINNER_CHECK(pool.GetAllocatedCount() == 100);
+    SPINNER_CHECK(pool.GetSlabCount() == 7);
+
+    for (const auto block : blocks)
+    {
+        pool.Free(block);
+    }
+    SPINNER_CHECK(pool.GetAllocatedCount() == 0);
+
+    for (int i = 0; i < 100; i++)
+    {
+        blocks[i] = pool.Allocate();
+    }
+    SPINNER_CHECK(pool.GetSlabCount() == 7);
+    for (const auto block : blocks)
+    {
+        pool.Free(block);
+    }
+}
+
+// Trim releases exactly the slabs with no block in use, and the pool keeps working afterwards
+static void TrimReleasesEmptySlabs()
+{
+    ObjectPool pool(64, 8);
+    std::vector<void *> blocks;
+    for (int i = 0; i < 64; i++)
+    {
+        blocks.push_back(pool.Allocate());
+        *static_cast<int *>(blocks.back()) = i;
+    }
+    SPINNER_CHECK(pool.GetSlabCount() == 8);
+
+    // Keep one block in the first slab and one in the last, free everything else
+    for (int i = 1; i < 63; i++)
+    {
+        pool.Free(blocks[i]);
+    }
+    SPINNER_CHECK(pool.Trim() == 6 * 8 * pool.GetBlockSize());
+    SPINNER_CHECK(pool.GetSlabCount() == 2);
+    SPINNER_CHECK(pool.Trim() == 0);
+    SPINNER_CHECK(*static_cast<int *>(blocks[0]) == 0);
+    SPINNER_CHECK(*static_cast<int *>(blocks[63]) == 63);
+
+    // The two kept slabs have 14 free blocks left, the next allocation after them needs a new slab
+    std::vector<void *> reused;
+    for (int i = 0; i < 15; i++)
+    {
+        reused.push_back(pool.Allocate());
+    }
+    SPINNER_CHECK(pool.GetSlabCount() == 3);
+
+    for (const auto block : reused)
+    {
+        pool.Free(block);
+    }
+    pool.Free(blocks[0]);
+    pool.Free(blocks[63]);
+    pool.Trim();
+    SPINNER_CHECK(pool.GetSlabCount() == 0);
+    SPINNER_CHECK(pool.GetAllocatedCount() == 0);
+
+    pool.Free(pool.Allocate());
+    SPINNER_CHECK(pool.GetSlabCount() == 1);
+}
+
+// The allocator the scene objects use, objects and control blocks come out of the shared pools and go back on release
+static void SharedPoolsBackAllocateShared()
+{
+    struct Node
+    {
+        uint64_t Values[12] = {};
+    };
+
+    const auto countBefore = ObjectPool::GetSharedAllocatedCount();
+    {
+        std::vector<std::shared_ptr<Node>> nodes;
+        for (int i = 0; i < 10000; i++)
+        {
+            nodes.push_back(std::allocate_shared<Node>(PoolAllocator<Node>()));
+            nodes.back()->Values[0] = i;
+        }
+        SPINNER_CHECK(ObjectPool::GetSharedAllocatedCount() == countBefore + nodes.size());
+        SPINNER_CHECK(nodes[1234]->Values[0] == 1234);
+    }
+    SPINNER_CHECK(ObjectPool::GetSharedAllocatedCount() == countBefore);
+    SPINNER_CHECK(ObjectPool::TrimShared() > 0);
+    SPINNER_CHECK(ObjectPool::TrimShared() == 0);
+}
+
+// Blocks allocated on one thread may be freed on another, while the main thread reads the count
+static void ConcurrentAllocateAndFree()
+{
+    ObjectPool pool(32, 64);
+    constexpr int threadCount = 4;
+    constexpr int blocksPerThread = 20000;
+
+    std::vector<std::vector<void *>> blocks(threadCount);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadCount; thread++)
+    {
+        threads.emplace_back([&pool, &blocks, thread]()
+        {
+            for (int i = 0; i < blocksPerThread; i++)
+            {
+                blocks[thread].push_back(pool.Allocate());
+            }
+        });
+    }
+    // Only ever grows while the threads allocate
+    size_t lastCount = 0;
+    while (lastCount < threadCount * blocksPerThread)
+    {
+        const auto count = pool.GetAllocatedCount();
+        SPINNER_CHECK(count >= lastCount);
+        lastCount = count;
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+    SPINNER_CHECK(pool.GetAllocatedCount() == threadCount * blocksPerThread);
+
+    for (int thread = 0; thread < threadCount; thread++)
+    {
+        threads.emplace_back([&pool, &blocks, thread]()
+        {
+            for (const auto block : blocks[(thread + 1) % threadCount])
+            {
+                pool.Free(block);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    SPINNER_CHECK(pool.GetAllocatedCount() == 0);
+    pool.Trim();
+    SPINNER_CHECK(pool.GetSlabCount() == 0);
+}
+
+int main()
+{
+    Tests::Run("AllocateAndReuse", AllocateAndReuse);
+    Tests::Run("TrimReleasesEmptySlabs", TrimReleasesEmptySlabs);
+    Tests::Run("SharedPoolsBackAllocateShared", SharedPoolsBackAllocateShared);
+    Tests::Run("ConcurrentAllocateAndFree", ConcurrentAllocateAndFree);
+    return Tests::Result();
+}
@@ -0,0 +1,198 @@
+#include "Check.hpp"
+#include "Spinner/TransformStore.hpp"
+
+#include <cmath>
+#include <random>
+
+using namespace Spinner;
+
+static bool NearlyEqual(const glm::mat4 &a, const glm::mat4 &b)
+{
+    for (int column = 0; column < 4; column++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            if (std::abs(a[column][row] - b[column][row]) > 1e-3f)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Random hierarchy edits checked against world matrices rebuilt from scratch, both with and without a full pass in between
+static void WorldMatricesFollowHierarchy()
+{
+    TransformStore store;
+    std::mt19937 random(1);
+
+    std::vector<TransformStore::Id> ids;
+    std::vector<int> parents;
+    std::vector<bool> alive;
+    const auto addNode = [&](int parent)
+    {
+        ids.push_back(store.Add((parent >= 0) ? ids[parent] : TransformStore::InvalidId));
+        parents.push_back(parent);
+        alive.push_back(true);
+        store.SetPosition(ids.back(), {static_cast<float>(random() % 7), static_cast<float>(random() % 5), 1.0f});
+        store.SetRotation(ids.back(), glm::quat(0.8f, 0.6f, 0.0f, 0.0f));
+    };
+    const auto isAncestor = [&](int ancestor, int node)
+    {
+        for (; node >= 0; node = parents[node])
+        {
+            if (node == ancestor)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    // Children of a removed node become roots
+    const auto expectedWorld = [&](auto &&self, int node) -> glm::mat4
+    {
+        const auto local = store.GetLocalMatrix(ids[node]);
+        const auto parent = parents[node];
+        return (parent >= 0 && alive[parent]) ? local * self(self, parent) : local;
+    };
+
+    addNode(-1);
+    for (int i = 1; i < 2000; i++)
+    {
+        addNode(static_cast<int>(random() % i));
+    }
+
+    for (int round = 0; round < 50; round++)
+    {
+        for (int i = 0; i < 20; i++)
+        {
+            const auto node = 1 + random() % (ids.size() - 1);
+            if (alive[node])
+            {
+                store.SetPosition(ids[node], {static_cast<float>(random() % 9), 0.0f, static_cast<float>(random() % 3)});
+            }
+        }
+        for (int i = 0; i < 5; i++)
+        {
+            const auto node = static_cast<int>(1 + random() % (ids.size() - 1));
+            const auto parent = static_cast<int>(random() % ids.size());
+            if (alive[node] && alive[parent] && !isAncestor(node, parent))
+            {
+                parents[node] = parent;
+                store.SetParent(ids[node], ids[parent]);
+            }
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            const auto node = 1 + random() % (ids.size() - 1);
+            if (alive[node])
+            {
+                store.Remove(ids[node]);
+                alive[node] = false;
+            }
+        }
+        for (int i = 0; i < 5; i++)
+        {
+            const auto parent = static_cast<int>(random() % ids.size());
+            if (alive[parent])
+            {
+                addNode(parent);
+            }
+        }
+
+        if (round % 2 == 1)
+        {
+            store.UpdateWorldMatrices();
+        }
+
+        for (size_t node = 0; node < ids.size(); node++)
+        {
+            if (!alive[node])
+            {
+                continue;
+            }
+            SPINNER_CHECK(NearlyEqual(store.GetWorldMatrix(ids[node]), expectedWorld(expectedWorld, static_cast<int>(node))));
+            SPINNER_CHECK(NearlyEqual(store.GetInverseWorldMatrix(ids[node]) * store.GetWorldMatrix(ids[node]), glm::mat4(1.0f)));
+        }
+    }
+}
+
+// Ids stay valid across compaction, and removing everything empties the store without an update pass
+static void RemoveCompactsWithoutUpdate()
+{
+    TransformStore store;
+    std::vector<TransformStore::Id> ids;
+    for (int i = 0; i < 1000; i++)
+    {
+        ids.push_back(store.Add((i > 0) ? ids[i / 2] : TransformStore::InvalidId));
+        store.SetPosition(ids.back(), {static_cast<float>(i), 0.0f, 0.0f});
+    }
+
+    for (size_t i = 1; i < ids.size(); i += 2)
+    {
+        store.Remove(ids[i]);
+    }
+    SPINNER_CHECK(store.GetSize() == 500);
+    SPINNER_CHECK(store.GetSlotCount() * 3 <= store.GetSize() * 4);
+    for (size_t i = 0; i < ids.size(); i += 2)
+    {
+        SPINNER_CHECK(store.GetPosition(ids[i]).x == static_cast<float>(i));
+    }
+
+    for (size_t i = 0; i < ids.size(); i += 2)
+    {
+        store.Remove(ids[i]);
+    }
+    SPINNER_CHECK(store.GetSize() == 0);
+    SPINNER_CHECK(store.GetSlotCount() == 0);
+}
+
+// Mirrors SceneObject: objects start in the detached store, move into a scene's store when attached, and are removed when destroyed
+static void DetachedStoreReturnsToEmpty()
+{
+    const auto &detached = TransformStore::GetDetachedStore();
+    const auto detachedSize = detached->GetSize();
+
+    for (int cycle = 0; cycle < 100; cycle++)
+    {
+        TransformStore scene;
+        const auto root = scene.Add();
+
+        std::vector<TransformStore::Id> detachedIds;
+        for (int i = 0; i < 200; i++)
+        {
+            detachedIds.push_back(detached->Add());
+            detached->SetPosition(detachedIds.back(), {static_cast<float>(i), 0.0f, 0.0f});
+        }
+
+        // Attach every other object, the rest are destroyed without ever being attached
+        std::vector<TransformStore::Id> sceneIds;
+        for (size_t i = 0; i < detachedIds.size(); i++)
+        {
+            if (i % 2 == 0)
+            {
+                sceneIds.push_back(scene.Add(root));
+                scene.CopyLocal(sceneIds.back(), *detached, detachedIds[i]);
+                SPINNER_CHECK(scene.GetPosition(sceneIds.back()).x == static_cast<float>(i));
+            }
+            detached->Remove(detachedIds[i]);
+        }
+
+        for (const auto id : sceneIds)
+        {
+            scene.Remove(id);
+        }
+        SPINNER_CHECK(scene.GetSize() == 1);
+        SPINNER_CHECK(detached->GetSize() == detachedSize);
+        SPINNER_CHECK(detached->GetSlotCount() == detachedSize);
+    }
+}
+
+int main()
+{
+    Tests::Run("WorldMatricesFollowHierarchy", WorldMatricesFollowHierarchy);
+    Tests::Run("RemoveCompactsWithoutUpdate", RemoveCompactsWithoutUpdate);
+    Tests::Run("DetachedStoreReturnsToEmpty", DetachedStoreReturnsToEmpty);
+    return Tests::Result();
+}
@@ -0,0 +1,36 @@
+#include "Check.hpp"
+#include "Spinner/Utilities.hpp"
+
+using namespace Spinner;
+
+// Tells a reference whose object was destroyed apart from one which never had an object, as async model loads need for their parent
+static void ExpiredReferences()
+{
+    std::weak_ptr<int> neverSet;
+    SPINNER_CHECK(!IsExpiredReference(neverSet));
+
+    auto object = std::make_shared<int>(1);
+    std::weak_ptr<int> reference = object;
+    SPINNER_CHECK(!IsExpiredReference(reference));
+
+    object.reset();
+    SPINNER_CHECK(IsExpiredReference(reference));
+
+    // Made from a null shared_ptr, as LoadModelAsync does without a parent
+    std::weak_ptr<int> fromNull = std::shared_ptr<int>();
+    SPINNER_CHECK(!IsExpiredReference(fromNull));
+
+    // Still counts as destroyed when other weak references keep the control block alive
+    auto shared = std::make_shared<int>(2);
+    std::weak_ptr<int> first = shared;
+    std::weak_ptr<int> second = first;
+    shared.reset();
+    SPINNER_CHECK(IsExpiredReference(first));
+    SPINNER_CHECK(IsExpiredReference(second));
+}
+
+int main()
+{
+    Tests::Run("ExpiredReferences", ExpiredReferences);
+    return Tests::Result();
+}